@@ -16,27 +16,34 @@
 /********************************************/
 
 #include <math.h>
+#include "fnm_plugin.h"
 
-/** Functions names **/
-const char* function_names[] = {
-    "cbrt",     "exp",      "exp2",
-    "log",      "log10",    "log2",
-    "sqrt",     0   /* Ends with 0 */
-};
+/** Array forms of the functions **/
+// Each element is computed by the same function as a single value, so it
+// doesn't depend on its position on the vector (with -ffast-math, glibc
+// would replace these loops by the SIMD versions of libmvec, whose results
+// differ in the last digits)
+FNM_ARRAY_FORM(cbrt)    FNM_ARRAY_FORM(exp)     FNM_ARRAY_FORM(exp2)
+FNM_ARRAY_FORM(log)     FNM_ARRAY_FORM(log10)   FNM_ARRAY_FORM(log2)
+FNM_ARRAY_FORM(sqrt)
 
-/** Functions pointers **/
-double (*function_ptr[])(double) = {
-    cbrt,       exp,        exp2,
-    log,        log10,      log2,
-    sqrt,       0   /* Ends with 0 */
+/** Functions **/
+static const fnm_function functions[] = {
+    {"cbrt",  1, FNM_SIGNATURE_NATIVE, cbrt,  cbrt_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"exp",   1, FNM_SIGNATURE_NATIVE, exp,   exp_vec,   FNM_MATH, FNM_COST_MEDIUM},
+    {"exp2",  1, FNM_SIGNATURE_NATIVE, exp2,  exp2_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"log",   1, FNM_SIGNATURE_NATIVE, log,   log_vec,   FNM_MATH, FNM_COST_MEDIUM},
+    {"log10", 1, FNM_SIGNATURE_NATIVE, log10, log10_vec, FNM_MATH, FNM_COST_MEDIUM},
+    {"log2",  1, FNM_SIGNATURE_NATIVE, log2,  log2_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"sqrt",  1, FNM_SIGNATURE_NATIVE, sqrt,  sqrt_vec,  FNM_MATH, FNM_COST_CHEAP},
+    {0}     /* Ends with 0 */
 };
 
-/** Constant names **/
-const char* const_names[] = {
-    "E",       0   /* Ends with 0 */
+/** Constants **/
+static const fnm_constant constants[] = {
+    {"E",     M_E},
+    {0}     /* Ends with 0 */
 };
 
-/** Constant values **/
-double const_values[] = {
-    M_E,       0   /** Ends with 0 **/
-};
\ No newline at end of file
+/** Descriptor of the library **/
+const fnm_plugin fnm_plugin_info = FNM_PLUGIN(functions, constants);
@@ -0,0 +1,120 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: fnm_plugin.h
+ * Definitions of the descriptor that a library
+ * exports to declare its functions (version 2
+ * of the library interface)
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef FNM_PLUGIN_H
+#define FNM_PLUGIN_H
+
+#include <stddef.h>
+
+/* Version of the library interface defined on this header */
+#define FNM_PLUGIN_VERSION 2
+
+/* Maximum number of arguments of a function */
+#define FNM_MAX_ARGS 4
+
+/** Signatures of the functions **/
+// The optional array form of a function computes 'n' values at once:
+//  - FNM_SIGNATURE_NATIVE: void f(const double *x1, ..., const double *xk,
+//                                 double *out, size_t n)
+//  - FNM_SIGNATURE_ARRAY:  void f(const double *const *x, double *out, size_t n)
+// where each argument has 'n' elements. 'out' can be the same array as
+// the first argument
+#define FNM_SIGNATURE_NATIVE    0   // double f(double x1, ..., double xk)
+#define FNM_SIGNATURE_ARRAY     1   // double f(const double *x), x has k elements
+
+/** Properties of the functions **/
+// A function without flags is called once per value, even if its arguments
+// don't change, and never from several threads at the same time
+#define FNM_PURE        1   // Same arguments give the same result, without side effects
+#define FNM_THREAD_SAFE 2   // It can be called from several threads at the same time
+#define FNM_MATH        (FNM_PURE | FNM_THREAD_SAFE)
+
+/** Cost of the functions **/
+#define FNM_COST_UNKNOWN    0   // Treated as FNM_COST_MEDIUM
+#define FNM_COST_CHEAP      1   // A few arithmetic operations (fabs, floor...)
+#define FNM_COST_MEDIUM     2   // An elementary function (sin, exp...)
+#define FNM_COST_EXPENSIVE  3   // Much slower (special functions, integrals...)
+
+/** Function of a library **/
+typedef struct {
+    const char *name;       // Name of the function on the workspace
+    unsigned arity;         // Number of arguments (1 to FNM_MAX_ARGS)
+    unsigned signature;     // How the arguments are passed (FNM_SIGNATURE_*)
+    double (*fnct)();       // Pointer to the function
+    void (*fnct_vec)();     // Pointer to its array form (0 if there is none)
+    unsigned flags;         // Properties of the function (FNM_PURE...)
+    unsigned cost;          // Cost of each call (FNM_COST_*)
+} fnm_function;
+
+/** Constant of a library **/
+typedef struct {
+    const char *name;       // Name of the constant on the workspace
+    double value;           // Value of the constant
+} fnm_constant;
+
+/** Descriptor of a library **/
+// The library exports it with the name 'fnm_plugin_info'. Newer versions
+// only add fields at the end of the structures, and 'function_size' lets
+// the application read the functions of a library built with any version
+typedef struct {
+    unsigned version;               // FNM_PLUGIN_VERSION
+    size_t function_size;           // sizeof(fnm_function)
+    const fnm_function *functions;  // Ends with a function with name 0
+    const fnm_constant *constants;  // Ends with a constant with name 0
+} fnm_plugin;
+
+/** Seed of the random numbers **/
+// A library that draws random numbers can export a function with this name
+// and the type fnm_seed. The command seed() calls it with the new seed,
+// and it's also called when the library is included after a seed was set
+#define FNM_PLUGIN_SEED "fnm_plugin_seed"
+typedef void (*fnm_seed)(unsigned long long seed);
+
+/* Compiles a function for several instruction sets (AVX-512, AVX2 and the
+ * generic x86-64), and the best one for the processor is selected when the
+ * program or library is loaded. Defining FNM_NO_CLONES disables it. All the
+ * versions only give the same results if the file is compiled with
+ * -ffp-contract=off, since AVX2 would join multiplications and additions */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) \
+        && __GNUC__ >= 12 && !defined(FNM_NO_CLONES)
+#define FNM_TARGET_CLONES \
+    __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define FNM_TARGET_CLONES
+#endif
+
+/* Initializer of the descriptor of a library */
+#define FNM_PLUGIN(functions, constants) \
+    { FNM_PLUGIN_VERSION, sizeof(fnm_function), (functions), (constants) }
+
+/* Definitions of the array form 'f_vec' of a function 'f' with a loop */
+// Each element is computed by a call to 'f', so the loops are not compiled
+// for several instruction sets: they wouldn't be faster
+#define FNM_ARRAY_FORM(f)                                                   \
+    static void f##_vec(const double *x, double *out, size_t n){            \
+        size_t i;                                                           \
+        for(i = 0; i < n; i++)                                              \
+            out[i] = f(x[i]);                                               \
+    }
+#define FNM_ARRAY_FORM_2(f)                                                 \
+    static void f##_vec(const double *x, const double *y, double *out, size_t n){ \
+        size_t i;                                                           \
+        for(i = 0; i < n; i++)                                              \
+            out[i] = f(x[i], y[i]);                                         \
+    }
+
+#endif /* FNM_PLUGIN_H */
@@ -0,0 +1,333 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: random.c
+ * Implementation of random numbers with the
+ * generators xoshiro256++ and Philox4x32-10,
+ * with an independent stream for each thread
+ * and uniform, normal and exponential
+ * distributions
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * Each thread that draws numbers takes the next stream, numbered from 0:
+ *  - xoshiro256++: the stream t starts t long jumps (2^192 numbers) after
+ *    the state given by the seed, and is split in RNG_LANES lanes one jump
+ *    (2^128 numbers) apart that are advanced together.
+ *  - Philox4x32-10: the seed is the key and the stream t uses the counters
+ *    whose high half is t, so the streams are disjoint by construction.
+ * The numbers are generated in blocks of RNG_BUFFER. The main thread takes
+ * the stream 0 when the library is loaded, so an expression evaluated with
+ * threads(1) always gives the same numbers for the same seed. With more
+ * threads the terms are shared between them at run time, and the same seed
+ * can give the numbers in other order.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include "fnm_plugin.h"
+
+/* Numbers generated at once for each thread */
+#define RNG_BUFFER 256
+
+/* Lanes of xoshiro256++ advanced together (a vector of AVX-512) */
+#define RNG_LANES 8
+
+/* Seed until the command seed() sets another one */
+#define RNG_DEFAULT_SEED 0x853c49e6748fea9bULL
+
+/** Generators **/
+#define RNG_XOSHIRO 0
+#define RNG_PHILOX  1
+
+/** Constants of Philox4x32-10 **/
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+/* State of the generators of a thread */
+typedef struct {
+    uint64_t buffer[RNG_BUFFER];    // Numbers not used yet
+    unsigned next;                  // Position of the next one on 'buffer'
+    uint64_t s[4][RNG_LANES];       // xoshiro256++: state of each lane
+    uint64_t counter;               // Philox: next block of the stream
+    uint64_t stream;                // Number of the stream of the thread
+    unsigned generation;            // Value of rng.generation on the last reset
+    int ready;                      // 0 until the thread takes a stream
+} rng_state;
+
+/** Shared configuration **/
+// Only changed by seed() and generator() while nothing is evaluated. Each
+// change increases 'generation', and the threads restart their streams
+static struct {
+    uint64_t seed;
+    int generator;          // RNG_XOSHIRO or RNG_PHILOX
+    unsigned generation;
+    unsigned streams;       // Streams already taken
+} rng = {RNG_DEFAULT_SEED, RNG_XOSHIRO, 1, 0};
+
+/* Generators of the current thread */
+static __thread rng_state state;
+
+/** Declaration of the functions **/
+static uint64_t splitmix64(uint64_t *x);
+static void xoshiro_jump(uint64_t s[4], const uint64_t poly[4]);
+static void xoshiro_fill(rng_state *st);
+static void philox_fill(rng_state *st);
+static void rng_reset(rng_state *st);
+static inline uint64_t rng_next(rng_state *st);
+static inline double rng_uniform(rng_state *st);
+static double uniform(double a, double b);
+static double normal(double mu, double sigma);
+static double exponential(double lambda);
+static double generator(double g);
+
+/**
+ * Gives the stream 0 to the thread that loads the library
+ */
+__attribute__((constructor)) static void rng_init(){
+    state.stream = rng.streams++;
+    state.ready = 1;
+}
+
+/** Implementation of the generators **/
+
+static uint64_t splitmix64(uint64_t *x){
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k){
+    return (x << k) | (x >> (64 - k));
+}
+
+static void xoshiro_jump(uint64_t s[4], const uint64_t poly[4]){
+    // Advances the state as many numbers as the polynomial represents
+    uint64_t j[4] = {0, 0, 0, 0};
+    int i, b, k;
+
+    for(i = 0; i < 4; i++){
+        for(b = 0; b < 64; b++){
+            if(poly[i] & (1ULL << b)){
+                for(k = 0; k < 4; k++)
+                    j[k] ^= s[k];
+            }
+            uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+        }
+    }
+    for(k = 0; k < 4; k++)
+        s[k] = j[k];
+}
+
+FNM_TARGET_CLONES
+static void xoshiro_fill(rng_state *st){
+    uint64_t (*s)[RNG_LANES] = st->s;
+    int i, l;
+
+    // The lanes are independent, so each step is a vector operation
+    for(i = 0; i < RNG_BUFFER; i += RNG_LANES){
+        for(l = 0; l < RNG_LANES; l++){
+            st->buffer[i + l] = rotl(s[0][l] + s[3][l], 23) + s[0][l];
+            uint64_t t = s[1][l] << 17;
+            s[2][l] ^= s[0][l];
+            s[3][l] ^= s[1][l];
+            s[1][l] ^= s[2][l];
+            s[0][l] ^= s[3][l];
+            s[2][l] ^= t;
+            s[3][l] = rotl(s[3][l], 45);
+        }
+    }
+}
+
+FNM_TARGET_CLONES
+static void philox_fill(rng_state *st){
+    uint32_t k0 = (uint32_t)rng.seed, k1 = (uint32_t)(rng.seed >> 32);
+    int i, r;
+
+    // Each block of 128 bits gives two numbers
+    for(i = 0; i < RNG_BUFFER / 2; i++){
+        uint64_t block = st->counter + i;
+        uint32_t c0 = (uint32_t)block, c1 = (uint32_t)(block >> 32);
+        uint32_t c2 = (uint32_t)st->stream, c3 = (uint32_t)(st->stream >> 32);
+        uint32_t key0 = k0, key1 = k1;
+
+        for(r = 0; r < PHILOX_ROUNDS; r++){
+            uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+            uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+            c0 = (uint32_t)(p1 >> 32) ^ c1 ^ key0;
+            c1 = (uint32_t)p1;
+            c2 = (uint32_t)(p0 >> 32) ^ c3 ^ key1;
+            c3 = (uint32_t)p0;
+            key0 += PHILOX_W0;
+            key1 += PHILOX_W1;
+        }
+        st->buffer[2 * i] = ((uint64_t)c1 << 32) | c0;
+        st->buffer[2 * i + 1] = ((uint64_t)c3 << 32) | c2;
+    }
+    st->counter += RNG_BUFFER / 2;
+}
+
+static void rng_reset(rng_state *st){
+    static const uint64_t jump[4] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                     0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+    static const uint64_t long_jump[4] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3,
+                                          0x77710069854ee241, 0x39109bb02acbe635};
+    uint64_t s[4], x = rng.seed;
+    uint64_t t;
+    int k, l;
+
+    if(!st->ready){
+        st->stream = __atomic_fetch_add(&rng.streams, 1, __ATOMIC_RELAXED);
+        st->ready = 1;
+    }
+
+    if(rng.generator == RNG_XOSHIRO){
+        for(k = 0; k < 4; k++)
+            s[k] = splitmix64(&x);
+        for(t = 0; t < st->stream; t++)
+            xoshiro_jump(s, long_jump);
+        for(l = 0; l < RNG_LANES; l++){
+            for(k = 0; k < 4; k++)
+                st->s[k][l] = s[k];
+            xoshiro_jump(s, jump);
+        }
+    }
+    else
+        st->counter = 0;
+
+    st->next = RNG_BUFFER;  // The buffer is filled by the next call
+}
+
+static inline uint64_t rng_next(rng_state *st){
+    unsigned generation = __atomic_load_n(&rng.generation, __ATOMIC_ACQUIRE);
+
+    if(st->generation != generation){
+        rng_reset(st);
+        st->generation = generation;
+    }
+    if(st->next == RNG_BUFFER){
+        if(rng.generator == RNG_XOSHIRO)
+            xoshiro_fill(st);
+        else
+            philox_fill(st);
+        st->next = 0;
+    }
+    return st->buffer[st->next++];
+}
+
+static inline double rng_uniform(rng_state *st){
+    // The 53 high bits, in [0, 1)
+    return (rng_next(st) >> 11) * 0x1.0p-53;
+}
+
+/** Implementation of the functions **/
+
+static double uniform(double a, double b){
+    return a + (b - a) * rng_uniform(&state);
+}
+
+static double normal(double mu, double sigma){
+    // Box-Muller transform, 1 - u is in (0, 1]
+    double r = sqrt(-2 * log(1 - rng_uniform(&state)));
+    return mu + sigma * r * cos(2 * M_PI * rng_uniform(&state));
+}
+
+static double exponential(double lambda){
+    return -log1p(-rng_uniform(&state)) / lambda;
+}
+
+static double generator(double g){
+    if(g != RNG_XOSHIRO && g != RNG_PHILOX)
+        return NAN;
+
+    rng.generator = (int)g;
+    __atomic_add_fetch(&rng.generation, 1, __ATOMIC_RELEASE);
+    return g;
+}
+
+/** Array forms of the functions **/
+// The values of a block are drawn together. 'out' can be the same array as
+// 'a' or 'mu', so each element is read before it's written
+
+static void uniform_vec(const double *a, const double *b, double *out, size_t n){
+    rng_state *st = &state;
+    size_t i;
+
+    for(i = 0; i < n; i++)
+        out[i] = a[i] + (b[i] - a[i]) * rng_uniform(st);
+}
+
+static void normal_vec(const double *mu, const double *sigma, double *out, size_t n){
+    rng_state *st = &state;
+    size_t i;
+
+    // Each pair of numbers gives two values of the Box-Muller transform
+    for(i = 0; i + 1 < n; i += 2){
+        double r = sqrt(-2 * log(1 - rng_uniform(st)));
+        double theta = 2 * M_PI * rng_uniform(st);
+        double m0 = mu[i], s0 = sigma[i];
+        double m1 = mu[i + 1], s1 = sigma[i + 1];
+        out[i] = m0 + s0 * r * cos(theta);
+        out[i + 1] = m1 + s1 * r * sin(theta);
+    }
+    if(i < n)
+        out[i] = normal(mu[i], sigma[i]);
+}
+
+static void exponential_vec(const double *lambda, double *out, size_t n){
+    rng_state *st = &state;
+    size_t i;
+
+    for(i = 0; i < n; i++)
+        out[i] = -log1p(-rng_uniform(st)) / lambda[i];
+}
+
+/** Functions **/
+// They are not pure, so they are called for each term of a series or a
+// sweep, and each thread draws from its own stream
+static const fnm_function functions[] = {
+    {"uniform",     2, FNM_SIGNATURE_NATIVE, uniform,     uniform_vec,     FNM_THREAD_SAFE, FNM_COST_CHEAP},
+    {"normal",      2, FNM_SIGNATURE_NATIVE, normal,      normal_vec,      FNM_THREAD_SAFE, FNM_COST_MEDIUM},
+    {"exponential", 1, FNM_SIGNATURE_NATIVE, exponential, exponential_vec, FNM_THREAD_SAFE, FNM_COST_MEDIUM},
+    {"generator",   1, FNM_SIGNATURE_NATIVE, generator,   0,               0,               FNM_COST_CHEAP},
+    {0}     /* Ends with 0 */
+};
+
+/** Constants **/
+static const fnm_constant constants[] = {
+    {"XOSHIRO", RNG_XOSHIRO},   // Arguments of generator()
+    {"PHILOX",  RNG_PHILOX},
+    {0}     /* Ends with 0 */
+};
+
+/**
+ * Sets the seed of the generators (called by the command seed()). The
+ * streams of all the threads restart from it
+ *
+ * @param seed: New seed
+ */
+void fnm_plugin_seed(unsigned long long seed){
+    rng.seed = seed;
+    __atomic_add_fetch(&rng.generation, 1, __ATOMIC_RELEASE);
+}
+
+/** Descriptor of the library **/
+const fnm_plugin fnm_plugin_info = FNM_PLUGIN(functions, constants);
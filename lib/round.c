@@ -16,15 +16,21 @@
 /********************************************/
 
 #include <math.h>
+#include "fnm_plugin.h"
 
-/** Functions names **/
-const char* function_names[] = {
-    "ceil",     "abs",     "floor",
-    "round",    "trunc",    0   /* Ends with 0 */
+/** Array forms of the functions **/
+FNM_ARRAY_FORM(ceil)    FNM_ARRAY_FORM(fabs)    FNM_ARRAY_FORM(floor)
+FNM_ARRAY_FORM(round)   FNM_ARRAY_FORM(trunc)
+
+/** Functions **/
+static const fnm_function functions[] = {
+    {"ceil",  1, FNM_SIGNATURE_NATIVE, ceil,  ceil_vec,  FNM_MATH, FNM_COST_CHEAP},
+    {"abs",   1, FNM_SIGNATURE_NATIVE, fabs,  fabs_vec,  FNM_MATH, FNM_COST_CHEAP},
+    {"floor", 1, FNM_SIGNATURE_NATIVE, floor, floor_vec, FNM_MATH, FNM_COST_CHEAP},
+    {"round", 1, FNM_SIGNATURE_NATIVE, round, round_vec, FNM_MATH, FNM_COST_CHEAP},
+    {"trunc", 1, FNM_SIGNATURE_NATIVE, trunc, trunc_vec, FNM_MATH, FNM_COST_CHEAP},
+    {0}     /* Ends with 0 */
 };
 
-/** Functions pointers **/
-double (*function_ptr[])(double) = {
-    ceil,       fabs,       floor,
-    round,      trunc,      0   /* Ends with 0 */
-};
\ No newline at end of file
+/** Descriptor of the library **/
+const fnm_plugin fnm_plugin_info = FNM_PLUGIN(functions, 0);
@@ -0,0 +1,199 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: special_kernels.h
+ * Vector kernels of the library special.c.
+ * It's included once for each instruction
+ * set, after vecmath_kernels.h, with the
+ * same definitions (VD, VL, W, ISA, TARGET
+ * and VSQRT)
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/** Declaration of the kernels **/
+TARGET static inline VD ISA(_erf_near)(VD a, VL small);
+TARGET static inline VD ISA(_exp_sum)(VD hi, VD lo);
+TARGET static inline VD ISA(_erfc_far)(VD a);
+TARGET static inline VD ISA(_abs)(VD x);
+
+/** Implementation of the kernels **/
+
+TARGET static inline VD ISA(_erf_near)(VD a, VL small){
+    // R = P / Q of fdlibm for |x| < 1.25: erf(x) = x + x * R(x^2) on the
+    // small lanes (|x| < 0.84375), and erx + R(|x| - 1) on the rest. Both
+    // are evaluated (with Estrin's scheme, whose chains of operations are
+    // shorter than Horner's), and a single division is done with the P and
+    // Q of each lane
+    VD z = a * a, z2 = z * z, z4 = z2 * z2;
+    VD p1 = (SP_PP0 + z * SP_PP1) + z2 * (SP_PP2 + z * SP_PP3) + z4 * SP_PP4;
+    VD q1 = (1.0 + z * SP_QQ1) + z2 * (SP_QQ2 + z * SP_QQ3) + z4 * (SP_QQ4 + z * SP_QQ5);
+    VD s = a - 1.0, s2 = s * s, s4 = s2 * s2;
+    VD p2 = (SP_PA0 + s * SP_PA1) + s2 * (SP_PA2 + s * SP_PA3)
+        + s4 * ((SP_PA4 + s * SP_PA5) + s2 * SP_PA6);
+    VD q2 = (1.0 + s * SP_QA1) + s2 * (SP_QA2 + s * SP_QA3)
+        + s4 * ((SP_QA4 + s * SP_QA5) + s2 * SP_QA6);
+    return SEL(small, p1, p2) / SEL(small, q1, q2);
+}
+
+TARGET static inline VD ISA(_exp_sum)(VD hi, VD lo){
+    VL k;
+
+    // e^(hi + lo) with a single reduction: lo, small, is added to the
+    // reduced argument, so the bits of hi + lo that don't fit a double
+    // aren't lost. The results below e^-746 are 0 (hi + lo > -800)
+    VD x = hi + lo;
+    VD y = SEL((VL)(x < -746.0), SPLAT(-746.0), x);
+    VD n = ISA(_round)(y * VM_LOG2E, &k);
+    VD r = ((hi - n * VM_LN2_HI) + lo) - n * VM_LN2_LO;
+    VD e = ISA(_exp_kernel)(r, k);
+    return SEL((VL)(x < VM_EXP_MIN), SPLAT(0.0), e);
+}
+
+TARGET static inline VD ISA(_erfc_far)(VD a){
+    // erfc(x) = exp(-x^2 - 0.5625 + R(1/x^2)) / x for 1.25 <= x < 28,
+    // with a rational function R = P / Q of fdlibm for each side of 1/0.35,
+    // evaluated like the ones of _erf_near(). Beyond 28 it's 0
+    a = SEL((VL)(a > 28.0), SPLAT(28.0), a);
+    VD s = 1.0 / (a * a), s2 = s * s, s4 = s2 * s2;
+    VD p1 = (SP_RA0 + s * SP_RA1) + s2 * (SP_RA2 + s * SP_RA3)
+        + s4 * ((SP_RA4 + s * SP_RA5) + s2 * (SP_RA6 + s * SP_RA7));
+    VD q1 = (1.0 + s * SP_SA1) + s2 * (SP_SA2 + s * SP_SA3)
+        + s4 * ((SP_SA4 + s * SP_SA5) + s2 * (SP_SA6 + s * SP_SA7) + s4 * SP_SA8);
+    VD p2 = (SP_RB0 + s * SP_RB1) + s2 * (SP_RB2 + s * SP_RB3)
+        + s4 * ((SP_RB4 + s * SP_RB5) + s2 * SP_RB6);
+    VD q2 = (1.0 + s * SP_SB1) + s2 * (SP_SB2 + s * SP_SB3)
+        + s4 * ((SP_SB4 + s * SP_SB5) + s2 * (SP_SB6 + s * SP_SB7));
+    VL near = (VL)(a < SP_ERFC_SPLIT);
+    VD r = SEL(near, p1, p2) / SEL(near, q1, q2);
+
+    // x^2 is split on z^2, exact with the high half of the bits of x, and
+    // (z - x) * (z + x), so the exponential doesn't lose its precision
+    VD z = (VD)((VL)a & SP_HIGH_MASK);
+    return ISA(_exp_sum)(-z * z - 0.5625, (z - a) * (z + a) + r) / a;
+}
+
+TARGET static inline VD ISA(_abs)(VD x){
+    return (VD)((VL)x & ~SP_SIGN_MASK);
+}
+
+
+/** Functions **/
+// Each one computes a vector of W elements. Each region of erf and erfc
+// (below and above 1.25) is computed only if any element is on it
+
+TARGET static VD ISA(sp_erf)(VD x){
+    VD a = ISA(_abs)(x);
+    VL far = (VL)(a >= SP_ERF_FAR);
+    VD y = a;
+
+    if(ISA(_any)(~far)){
+        VL small = (VL)(a < SP_ERF_SMALL);
+        y = ISA(_erf_near)(a, small);
+        y = SEL(small, a + a * y, SP_ERX + y);
+    }
+    if(ISA(_any)(far))
+        y = SEL(far, 1.0 - ISA(_erfc_far)(a), y);
+
+    // erf(-x) = -erf(x)
+    y = (VD)((VL)y | ((VL)x & SP_SIGN_MASK));
+    return SEL((VL)(x != x), x, y);
+}
+
+TARGET static VD ISA(sp_erfc)(VD x){
+    VD a = ISA(_abs)(x);
+    VL far = (VL)(a >= SP_ERF_FAR);
+    VL neg = (VL)(x < 0);
+    VD y = a;
+
+    if(ISA(_any)(~far)){
+        // Below 1/4, erfc(x) = 1 - erf(x); above, the 0.5 that cancels is
+        // taken out first
+        VL small = (VL)(a < SP_ERF_SMALL);
+        y = ISA(_erf_near)(a, small);
+        VD e = x + x * y;
+        VD c = SEL((VL)(x < 0.25), 1.0 - e, 0.5 - (x * y + (x - 0.5)));
+        y = SEL(neg, 1.0 + (SP_ERX + y), (1.0 - SP_ERX) - y);
+        y = SEL(small, c, y);
+    }
+    if(ISA(_any)(far)){
+        VD f = ISA(_erfc_far)(a);
+        y = SEL(far, SEL(neg, 2.0 - f, f), y);
+    }
+    return SEL((VL)(x != x), x, y);
+}
+
+TARGET static VD ISA(sp_normcdf)(VD x){
+    return 0.5 * ISA(sp_erfc)(-x * SP_SQRT1_2);
+}
+
+TARGET static VD ISA(sp_norminv)(VD p){
+    // Rational approximations of P. J. Acklam (relative error 1.15e-9):
+    // the central region, and the tails from the nearest limit if any
+    // element is on them
+    VD q = p - 0.5;
+    VD r = q * q;
+    VD n = SPLAT(SP_A0);
+    n = SP_A1 + r * n;
+    n = SP_A2 + r * n;
+    n = SP_A3 + r * n;
+    n = SP_A4 + r * n;
+    n = (SP_A5 + r * n) * q;
+    VD d = SPLAT(SP_B0);
+    d = SP_B1 + r * d;
+    d = SP_B2 + r * d;
+    d = SP_B3 + r * d;
+    d = SP_B4 + r * d;
+    d = 1.0 + r * d;
+    VD x = n / d;
+
+    VL upper = (VL)(p > 0.5);
+    VL tail = (VL)(p < SP_NORMINV_LOW) | (VL)(p > 1.0 - SP_NORMINV_LOW);
+    if(ISA(_any)(tail)){
+        VD t = VSQRT(-2.0 * ISA(_log)(SEL(upper, 1.0 - p, p)));
+        n = SPLAT(SP_C0);
+        n = SP_C1 + t * n;
+        n = SP_C2 + t * n;
+        n = SP_C3 + t * n;
+        n = SP_C4 + t * n;
+        n = SP_C5 + t * n;
+        d = SPLAT(SP_D0);
+        d = SP_D1 + t * d;
+        d = SP_D2 + t * d;
+        d = SP_D3 + t * d;
+        d = 1.0 + t * d;
+        VD y = n / d;
+        x = SEL(tail, SEL(upper, -y, y), x);
+    }
+
+    // One step of Halley's method over the exact CDF gives full precision.
+    // The lower tail is refined from p and the upper one from 1 - p
+    VL lower = (VL)(x < 0);
+    VD c = ISA(sp_normcdf)(SEL(lower, x, -x));
+    VD e = SEL(lower, c - p, (1.0 - p) - c);
+    VD u = e * SP_SQRT_2PI * ISA(_exp)(0.5 * x * x);
+    VD h = x - u / (1.0 + 0.5 * x * u);
+    x = SEL((VL)(u - u == 0), h, x);    // u is not finite on the smallest subnormal numbers
+
+    // norminv(0) = -inf, norminv(1) = inf, and NaN out of [0, 1]
+    x = SEL((VL)(p == 0), SPLAT(-VM_INF), x);
+    x = SEL((VL)(p == 1), SPLAT(VM_INF), x);
+    return SEL((VL)(p < 0) | (VL)(p > 1) | (VL)(p != p), SPLAT(VM_NAN), x);
+}
+
+
+/** Array forms **/
+VM_ARRAY_FORM(sp_erf)       VM_ARRAY_FORM(sp_erfc)
+VM_ARRAY_FORM(sp_normcdf)   VM_ARRAY_FORM(sp_norminv)
+
+/* Functions of the instruction set, in the order of _functions */
+static const vm_array ISA(sp_table)[] = {
+    ISA(sp_erf_array),      ISA(sp_erfc_array),
+    ISA(sp_normcdf_array),  ISA(sp_norminv_array)
+};
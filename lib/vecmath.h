@@ -0,0 +1,129 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: vecmath.h
+ * Constants and macros of the vector kernels
+ * of vecmath_kernels.h, shared by the libraries
+ * that use them (vecmath.c and special.c)
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef VECMATH_H
+#define VECMATH_H
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Environment variable that forces an instruction set ("sse2", "avx2") */
+#define VM_ISA_ENV "FNM_VECMATH_ISA"
+
+/** Constants of the kernels **/
+#define VM_ROUND_MAGIC  6755399441055744.0          // 1.5 * 2^52
+#define VM_INF          INFINITY
+#define VM_NAN          NAN
+#define VM_TRIG_MAX     1e5                         // Limit of the reduction by pi/2
+#define VM_2_PI         6.36619772367581382433e-01  // 2 / pi
+#define VM_PIO2_1       1.57079632673412561417e+00  // First 33 bits of pi/2
+#define VM_PIO2_2       6.07710050630396597660e-11  // Next 33 bits of pi/2
+#define VM_PIO2_3       2.02226624879595063154e-21  // pi/2 - VM_PIO2_1 - VM_PIO2_2
+#define VM_S1           -1.66666666666666324348e-01
+#define VM_S2           8.33333333332248946124e-03
+#define VM_S3           -1.98412698298579493134e-04
+#define VM_S4           2.75573137070700676789e-06
+#define VM_S5           -2.50507602534068634195e-08
+#define VM_S6           1.58969099521155010221e-10
+#define VM_C1           4.16666666666666019037e-02
+#define VM_C2           -1.38888888888741095749e-03
+#define VM_C3           2.48015872894767294178e-05
+#define VM_C4           -2.75573143513906633035e-07
+#define VM_C5           2.08757232129817482790e-09
+#define VM_C6           -1.13596475577881948265e-11
+#define VM_EXP_MAX      709.782712893383973096      // Greatest x with e^x finite
+#define VM_EXP_MIN      -745.13321910194110842      // Least x with e^x > 0
+#define VM_LOG2E        1.44269504088896338700e+00  // 1 / ln(2)
+#define VM_LN2          6.93147180559945286227e-01
+#define VM_LN2_HI       6.93147180369123816490e-01  // First 32 bits of ln(2)
+#define VM_LN2_LO       1.90821492927058770002e-10  // ln(2) - VM_LN2_HI
+#define VM_LOG10E       4.34294481903251816668e-01  // 1 / ln(10)
+#define VM_LOG10_2_HI   3.01029995663611771306e-01  // First 32 bits of log10(2)
+#define VM_LOG10_2_LO   3.69423907715893078616e-13  // log10(2) - VM_LOG10_2_HI
+#define VM_SQRT2        1.41421356237309514547e+00
+#define VM_E3           (1.0 / 6)                   // Coefficients of Taylor of e^r
+#define VM_E4           (1.0 / 24)
+#define VM_E5           (1.0 / 120)
+#define VM_E6           (1.0 / 720)
+#define VM_E7           (1.0 / 5040)
+#define VM_E8           (1.0 / 40320)
+#define VM_E9           (1.0 / 362880)
+#define VM_E10          (1.0 / 3628800)
+#define VM_E11          (1.0 / 39916800)
+#define VM_E12          (1.0 / 479001600)
+#define VM_E13          (1.0 / 6227020800.0)
+#define VM_LG1          6.666666666666735130e-01    // Coefficients of log(1 + f)
+#define VM_LG2          3.999999999940941908e-01
+#define VM_LG3          2.857142874366239149e-01
+#define VM_LG4          2.222219843214978396e-01
+#define VM_LG5          1.818357216161805012e-01
+#define VM_LG6          1.531383769920937332e-01
+#define VM_LG7          1.479819860511658591e-01
+
+/* Array form of a function for an instruction set */
+typedef void (*vm_array)(const double *x, double *out, size_t n);
+
+
+/* Vector with all its elements equal to c (of the type VD of the
+ * instruction set where it's used) */
+#define SPLAT(c) ((VD){0} + (c))
+/* Selects a of the elements where the mask m is set and b of the rest */
+#define SEL(m, a, b) ((VD)(((VL)(a) & (m)) | ((VL)(b) & ~(m))))
+
+/* Array form of the vector function f of an instruction set. Full vectors
+ * are loaded straight from the arrays, and the last elements through a
+ * vector filled with ones */
+#define VM_ARRAY_FORM(f)                                                    \
+    TARGET static void ISA(f##_array)(const double *x, double *out, size_t n){ \
+        size_t i;                                                           \
+        VD v;                                                               \
+        for(i = 0; i + W <= n; i += W){                                     \
+            memcpy(&v, x + i, sizeof(VD));                                  \
+            v = ISA(f)(v);                                                  \
+            memcpy(out + i, &v, sizeof(VD));                                \
+        }                                                                   \
+        if(i < n){                                                          \
+            double tail[W];                                                 \
+            size_t j;                                                       \
+            for(j = 0; j < W; j++)                                          \
+                tail[j] = (i + j < n) ? x[i + j] : 1.0;                     \
+            memcpy(&v, tail, sizeof(VD));                                   \
+            v = ISA(f)(v);                                                  \
+            memcpy(tail, &v, sizeof(VD));                                   \
+            for(j = 0; i + j < n; j++)                                      \
+                out[i + j] = tail[j];                                       \
+        }                                                                   \
+    }
+
+#if defined(__x86_64__)
+/**
+ * Tells if the kernels of AVX2 can be used: the processor supports AVX2
+ * and FMA, and the environment variable VM_ISA_ENV doesn't choose SSE2
+ *
+ * @return 1 for AVX2 or 0 for SSE2
+ */
+static inline int vm_avx2(){
+    const char *isa = getenv(VM_ISA_ENV);
+
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+        && (isa == NULL || strcmp(isa, "sse2") != 0);
+}
+#endif
+
+#endif /* VECMATH_H */
@@ -0,0 +1,280 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: vecmath_kernels.h
+ * Vector kernels of the library vecmath.c.
+ * It's included once for each instruction
+ * set, after vecmath.h, defining before:
+ *  - VD: vector of W doubles
+ *  - VL: vector of W 64 bits integers
+ *  - W: number of elements of the vectors
+ *  - ISA(name): name of a function for the
+ *    instruction set (name##_sse2...)
+ *  - TARGET: attribute that selects the
+ *    instruction set of the functions
+ *  - VSQRT(x): square root of a vector
+ * and VM_KERNELS_ONLY to leave out the
+ * functions of vecmath.c (for the libraries
+ * that only use the kernels, like special.c)
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/** Declaration of the kernels **/
+TARGET static inline int ISA(_any)(VL m);
+TARGET static inline VD ISA(_round)(VD x, VL *n);
+TARGET static inline VD ISA(_sin_cos)(VD x, VD *c, VL *q);
+TARGET static inline VD ISA(_exp_kernel)(VD r, VL k);
+TARGET static inline VD ISA(_exp)(VD x);
+TARGET static inline VD ISA(_log_kernel)(VD x, VD *k);
+TARGET static inline VD ISA(_fix_log)(VD x, VD y);
+TARGET static inline VD ISA(_log)(VD x);
+TARGET static inline VD ISA(_log)(VD x){
+    VD k;
+    VD y = ISA(_log_kernel)(x, &k);
+    return ISA(_fix_log)(x, k * VM_LN2_HI + (y + k * VM_LN2_LO));
+}
+
+TARGET static inline VD ISA(_fix_trig)(VD x, VD y, VL out, double (*f)(double));
+
+/** Implementation of the kernels **/
+
+TARGET static inline int ISA(_any)(VL m){
+    int i;
+    long long any = 0;
+    for(i = 0; i < W; i++)
+        any |= m[i];
+    return any != 0;
+}
+
+TARGET static inline VD ISA(_round)(VD x, VL *n){
+    // Adding 1.5 * 2^52 rounds to the nearest integer, that stays on the
+    // low bits of the sum (valid for |x| < 2^51)
+    VD t = x + VM_ROUND_MAGIC;
+    *n = (VL)t - (VL)SPLAT(VM_ROUND_MAGIC);
+    return t - VM_ROUND_MAGIC;
+}
+
+TARGET static inline VD ISA(_sin_cos)(VD x, VD *c, VL *q){
+    // x = n * pi/2 + r, with pi/2 split in three parts of 33 bits, so
+    // each product by n is exact while |n| < 2^20
+    VD n = ISA(_round)(x * VM_2_PI, q);
+    VD r0 = x - n * VM_PIO2_1;
+    VD t = n * VM_PIO2_2;
+    VD r1 = r0 - t;
+
+    // The reduced argument is r + y, where y keeps the bits lost by r
+    VD tail = ((r0 - r1) - t) - n * VM_PIO2_3;
+    VD r = r1 + tail;
+    VD y = (r1 - r) + tail;
+
+    // Kernels of fdlibm on [-pi/4, pi/4]
+    VD z = r * r;
+    VD v = z * r;
+    VD ps = VM_S2 + z * (VM_S3 + z * (VM_S4 + z * (VM_S5 + z * VM_S6)));
+    VD pc = z * (VM_C1 + z * (VM_C2 + z * (VM_C3 + z * (VM_C4 + z * (VM_C5 + z * VM_C6)))));
+    VD hz = 0.5 * z;
+    VD w = 1.0 - hz;
+
+    *c = w + (((1.0 - w) - hz) + (z * pc - r * y));
+    return r - ((z * (0.5 * y - v * ps) - y) - v * VM_S1);
+}
+
+TARGET static inline VD ISA(_exp_kernel)(VD r, VL k){
+    // Taylor polynomial of e^r - 1 (|r| <= ln(2)/2)
+    VD p = SPLAT(VM_E13);
+    p = VM_E12 + r * p;
+    p = VM_E11 + r * p;
+    p = VM_E10 + r * p;
+    p = VM_E9 + r * p;
+    p = VM_E8 + r * p;
+    p = VM_E7 + r * p;
+    p = VM_E6 + r * p;
+    p = VM_E5 + r * p;
+    p = VM_E4 + r * p;
+    p = VM_E3 + r * p;
+    p = 0.5 + r * p;
+    p = r + (r * r) * p;
+
+    // 2^k is applied in two halves, so results near the limits of the
+    // exponent don't overflow nor underflow before time
+    VL k1 = k >> 1, k2 = k - k1;
+    VD s1 = (VD)((k1 + 1023) << 52);
+    VD s2 = (VD)((k2 + 1023) << 52);
+    return ((1.0 + p) * s1) * s2;
+}
+
+TARGET static inline VD ISA(_exp)(VD x){
+    VL k;
+
+    // Arguments out of range are limited before the reduction
+    VD y = SEL((VL)(x > 710.0), SPLAT(710.0), x);
+    y = SEL((VL)(y < -746.0), SPLAT(-746.0), y);
+
+    // x = k * ln(2) + r, with ln(2) split in two parts
+    VD n = ISA(_round)(y * VM_LOG2E, &k);
+    VD r = (y - n * VM_LN2_HI) - n * VM_LN2_LO;
+    VD e = ISA(_exp_kernel)(r, k);
+
+    e = SEL((VL)(x > VM_EXP_MAX), SPLAT(VM_INF), e);
+    e = SEL((VL)(x < VM_EXP_MIN), SPLAT(0.0), e);
+    return SEL((VL)(x != x), x, e);
+}
+
+TARGET static inline VD ISA(_log_kernel)(VD x, VD *k){
+    // Subnormal numbers are scaled by 2^54 first
+    VL small = (VL)(x < 0x1p-1022);
+    x = SEL(small, x * 0x1p54, x);
+
+    // x = 2^e * m, with m on [sqrt(2)/2, sqrt(2))
+    VL bits = (VL)x;
+    VL e = ((bits >> 52) & 0x7ff) - 1023 - (small & 54);
+    VD m = (VD)((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+    VL big = (VL)(m > VM_SQRT2);
+    m = SEL(big, m * 0.5, m);
+    e = e - big;    // The mask is -1 where it's set
+
+    // The exponent becomes a double through the bits of 1.5 * 2^52
+    *k = (VD)((VL)SPLAT(VM_ROUND_MAGIC) + e) - VM_ROUND_MAGIC;
+
+    // log(1 + f) = f - f^2/2 + s * (f^2/2 + R(s^2)), with s = f / (2 + f)
+    VD f = m - 1.0;
+    VD s = f / (2.0 + f);
+    VD z = s * s;
+    VD w = z * z;
+    VD t1 = w * (VM_LG2 + w * (VM_LG4 + w * VM_LG6));
+    VD t2 = z * (VM_LG1 + w * (VM_LG3 + w * (VM_LG5 + w * VM_LG7)));
+    VD hfsq = 0.5 * f * f;
+    return f - (hfsq - s * (hfsq + t1 + t2));
+}
+
+TARGET static inline VD ISA(_fix_log)(VD x, VD y){
+    // log(+inf) = +inf, log(NaN) = NaN, log(0) = -inf, log(x < 0) = NaN
+    y = SEL((VL)(x == VM_INF) | (VL)(x != x), x, y);
+    y = SEL((VL)(x == 0), SPLAT(-VM_INF), y);
+    return SEL((VL)(x < 0), SPLAT(VM_NAN), y);
+}
+
+TARGET static inline VD ISA(_fix_trig)(VD x, VD y, VL out, double (*f)(double)){
+    int i;
+
+    // The elements out of the range of the reduction are computed by the
+    // function of the libm
+    if(ISA(_any)(out)){
+        for(i = 0; i < W; i++){
+            if(out[i])
+                y[i] = f(x[i]);
+        }
+    }
+    return y;
+}
+
+
+#ifndef VM_KERNELS_ONLY
+
+/** Functions **/
+// Each one computes a vector of W elements
+
+TARGET static VD ISA(vm_sin)(VD x){
+    VD a = SEL((VL)(x < 0), -x, x);
+    VD c, s;
+    VL q;
+
+    // Big or not finite arguments are left to the libm, only on their
+    // elements, so the rest don't depend on them
+    VL out = (VL)(a > VM_TRIG_MAX) | (VL)(a != a);
+    s = ISA(_sin_cos)(SEL(out, SPLAT(0.0), x), &c, &q);
+    VL odd = -(q & 1), neg = -((q >> 1) & 1);
+    s = SEL(odd, c, s);
+    s = SEL(neg, -s, s);
+    s = SEL((VL)(x == 0), x, s);    // Keeps the sign of -0
+    return ISA(_fix_trig)(x, s, out, sin);
+}
+
+TARGET static VD ISA(vm_cos)(VD x){
+    VD a = SEL((VL)(x < 0), -x, x);
+    VD c, s;
+    VL q;
+
+    VL out = (VL)(a > VM_TRIG_MAX) | (VL)(a != a);
+    s = ISA(_sin_cos)(SEL(out, SPLAT(0.0), x), &c, &q);
+    VL odd = -(q & 1), neg = -(((q + 1) >> 1) & 1);
+    c = SEL(odd, s, c);
+    c = SEL(neg, -c, c);
+    return ISA(_fix_trig)(x, c, out, cos);
+}
+
+TARGET static VD ISA(vm_tan)(VD x){
+    VD a = SEL((VL)(x < 0), -x, x);
+    VD c, s;
+    VL q;
+
+    // tan(r) on the even quadrants and -1/tan(r) on the odd ones
+    VL out = (VL)(a > VM_TRIG_MAX) | (VL)(a != a);
+    s = ISA(_sin_cos)(SEL(out, SPLAT(0.0), x), &c, &q);
+    VL odd = -(q & 1);
+    s = SEL(odd, -c, s) / SEL(odd, s, c);
+    s = SEL((VL)(x == 0), x, s);
+    return ISA(_fix_trig)(x, s, out, tan);
+}
+
+TARGET static VD ISA(vm_exp)(VD x){
+    return ISA(_exp)(x);
+}
+
+TARGET static VD ISA(vm_exp2)(VD x){
+    VL k;
+
+    VD y = SEL((VL)(x > 1025.0), SPLAT(1025.0), x);
+    y = SEL((VL)(y < -1076.0), SPLAT(-1076.0), y);
+
+    // x = k + r, and 2^r = e^(r * ln(2))
+    VD n = ISA(_round)(y, &k);
+    VD e = ISA(_exp_kernel)((y - n) * VM_LN2, k);
+
+    e = SEL((VL)(x >= 1024.0), SPLAT(VM_INF), e);
+    e = SEL((VL)(x < -1075.0), SPLAT(0.0), e);
+    return SEL((VL)(x != x), x, e);
+}
+
+TARGET static VD ISA(vm_log)(VD x){
+    return ISA(_log)(x);
+}
+
+TARGET static VD ISA(vm_log2)(VD x){
+    VD k;
+    VD y = ISA(_log_kernel)(x, &k);
+    return ISA(_fix_log)(x, k + y * VM_LOG2E);
+}
+
+TARGET static VD ISA(vm_log10)(VD x){
+    VD k;
+    VD y = ISA(_log_kernel)(x, &k);
+    return ISA(_fix_log)(x, k * VM_LOG10_2_HI + (y * VM_LOG10E + k * VM_LOG10_2_LO));
+}
+
+TARGET static VD ISA(vm_sqrt)(VD x){
+    // Correctly rounded by the instruction of each instruction set
+    return VSQRT(x);
+}
+
+
+/** Array forms **/
+VM_ARRAY_FORM(vm_sin)   VM_ARRAY_FORM(vm_cos)   VM_ARRAY_FORM(vm_tan)
+VM_ARRAY_FORM(vm_exp)   VM_ARRAY_FORM(vm_exp2)  VM_ARRAY_FORM(vm_log)
+VM_ARRAY_FORM(vm_log2)  VM_ARRAY_FORM(vm_log10) VM_ARRAY_FORM(vm_sqrt)
+
+/* Functions of the instruction set, in the order of _functions */
+static const vm_array ISA(vm_table)[] = {
+    ISA(vm_sin_array),  ISA(vm_cos_array),  ISA(vm_tan_array),
+    ISA(vm_exp_array),  ISA(vm_exp2_array), ISA(vm_log_array),
+    ISA(vm_log2_array), ISA(vm_log10_array), ISA(vm_sqrt_array)
+};
+
+#endif /* VM_KERNELS_ONLY */
@@ -0,0 +1,1072 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: AST.c
+ * Implementation of the expression tree and
+ * its evaluator defined on the header file AST.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#include "AST.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include "sintactic.tab.h"
+#include "reduce.h"
+#include "pool.h"
+#include "format.h"
+
+/* Number of chunks written to a file at once by a sweep */
+#define SWEEP_WRITE_CHUNKS 64
+
+
+/** Operand of a block of the fused evaluator **/
+typedef struct {
+    const double *ptr;  // Elements of the block (NULL if it's a scalar)
+    double num;         // Value of the scalar operand
+} _operand;
+
+/** Shared state of an evaluation running on the thread pool **/
+typedef struct {
+    ast_node *node;     // The vector expression
+    size_t start;       // Position of the first element to be computed
+    size_t size;        // Number of elements to be computed
+    double *out;        // Place to store the elements
+    size_t height;      // Height of the expression tree
+    size_t chunk;       // Number of elements of each task
+    double **scratch;   // Blocks of each worker (allocated on first use)
+    int status;         // 0 or -1 if some worker ran out of memory
+} _evaluation;
+
+/* Buffer to build the symbol of some error messages */
+// One per thread, since the lines of a loaded file may run in parallel
+static __thread char _error_symbol[64];
+
+
+/** Declaration of private functions **/
+ast_node* _new_node(ast_type type);
+int _resolve(ast_node *node, ast_error *error);
+int _resolve_list(ast_node *node, ast_error *error);
+int _resolve_call(ast_node *node, ast_error *error);
+int _evaluate(ast_node *node, ast_value *result, ast_error *error);
+int _resolve_series(ast_node *node, ast_error *error);
+int _resolve_sweep(ast_node *node, ast_error *error);
+int _sweep_grids(ast_node *node, ast_grid *grids, size_t *size, ast_error *error);
+int _range_size(double first, double last, size_t *size);
+int _bind_index(ast_node *node, info_row *index, const ast_node *bound,
+                unsigned nested, ast_error *error);
+int _eval_parallel(ast_node *node, size_t start, size_t size, double *out);
+unsigned _max_cost(ast_node *node);
+void _eval_task(void *param, size_t chunk, unsigned worker);
+double _grid_point(const ast_grid *grid, size_t k);
+double _call(const info_row *fnct, const double *args);
+void _call_vec(const info_row *fnct, const double **args, double *out, size_t len);
+double _apply(ast_type type, double x, double y);
+_operand _fetch(ast_node *node, size_t start, size_t len, double *dest, double *scratch);
+void _eval_block(ast_node *node, size_t start, size_t len, double *out, double *scratch);
+void _eval_call(ast_node *node, size_t start, size_t len, double *out, double *scratch);
+
+/** PUBLIC FUNCTIONS: Defined on AST.h **/
+
+ast_node* ast_num(double num){
+    ast_node *node = _new_node(AST_NUM);
+    node->value.num = num;
+    return node;
+}
+
+ast_node* ast_var(info_row *id){
+    ast_node *node = _new_node(AST_VAR);
+    node->value.id = id;
+    return node;
+}
+
+ast_node* ast_op(ast_type type, ast_node *left, ast_node *right){
+    ast_node *node = _new_node(type);
+    node->left = left;
+    node->right = right;
+    return node;
+}
+
+ast_node* ast_call(info_row *fnct, ast_node *args){
+    // The arguments are kept as the items of the node
+    args->type = AST_CALL;
+    args->value.id = fnct;
+    return args;
+}
+
+ast_node* ast_reduce(info_row *fnct, ast_node *arg){
+    ast_node *node = _new_node(AST_REDUCE);
+    node->value.id = fnct;
+    node->left = arg;
+    return node;
+}
+
+ast_node* ast_series(info_row *fnct, info_row *index, ast_node *first, ast_node *last, ast_node *body){
+    ast_node *node = ast_reduce(fnct, body);
+    node->index = index;
+    ast_list_append(node, first);
+    ast_list_append(node, last);
+    return node;
+}
+
+ast_node* ast_sweep(ast_node *body, info_row *var, ast_node *first, ast_node *last, ast_node *n){
+    ast_node *node = _new_node(AST_SWEEP);
+    node->left = body;
+    return ast_sweep_append(node, var, first, last, n);
+}
+
+ast_node* ast_sweep_append(ast_node *sweep, info_row *var, ast_node *first, ast_node *last, ast_node *n){
+    // Each variable takes four items: the variable and its limits
+    ast_list_append(sweep, ast_var(var));
+    ast_list_append(sweep, first);
+    ast_list_append(sweep, last);
+    return ast_list_append(sweep, n);
+}
+
+int ast_sweep_write(ast_node *node, FILE *file, size_t *n_points, ast_error *error){
+    size_t i, d, n_vars = node->n_items / 4, size, start, len;
+    int status = -1;
+    char text[FORMAT_SIZE];
+    *n_points = 0;
+
+    // The values of the variables are needed to write each point
+    ast_grid *grids = malloc(n_vars * sizeof(ast_grid));
+    info_row **vars = malloc(n_vars * sizeof(info_row *));
+    double *values = aligned_alloc(VEC_ALIGNMENT, SWEEP_WRITE_CHUNKS * AST_CHUNK_SIZE * sizeof(double));
+    if(grids == NULL || vars == NULL || values == NULL){
+        free(grids);
+        free(vars);
+        free(values);
+        error->info = "Not enough memory to evaluate the sweep";
+        error->symbol = "";
+        error->row = NULL;
+        return -1;
+    }
+    for(d = 0; d < n_vars; d++)
+        vars[d] = node->items[4 * d]->value.id;
+
+    if(_sweep_grids(node, grids, &size, error) == 0 && _resolve(node, error) == 0){
+        fprintf(file, "# ");
+        for(d = 0; d < n_vars; d++)
+            fprintf(file, "%s\t", vars[d]->key);
+        fprintf(file, "value\n");
+
+        // The points are computed in parallel by groups and written in order
+        status = 0;
+        error->symbol = "";
+        error->row = NULL;
+        for(start = 0; start < size; start += len){
+            len = size - start;
+            if(len > SWEEP_WRITE_CHUNKS * AST_CHUNK_SIZE)
+                len = SWEEP_WRITE_CHUNKS * AST_CHUNK_SIZE;
+            if(_eval_parallel(node, start, len, values) == -1){
+                error->info = "Not enough memory to evaluate the sweep";
+                status = -1;
+                break;
+            }
+
+            // The files always keep all the digits, in the shortest form
+            for(i = 0; i < len; i++){
+                for(d = 0; d < n_vars; d++){
+                    size_t k = ((start + i) / grids[d].stride) % grids[d].count;
+                    fwrite(text, 1, format_shortest(_grid_point(&grids[d], k), text), file);
+                    putc('\t', file);
+                }
+                fwrite(text, 1, format_shortest(values[i], text), file);
+                putc('\n', file);
+            }
+            if(ferror(file)){
+                error->info = "Could not write the points of the sweep";
+                status = -1;
+                break;
+            }
+            *n_points += len;
+        }
+    }
+
+    free(grids);
+    free(vars);
+    free(values);
+    return status;
+}
+
+ast_node* ast_list(){
+    return _new_node(AST_LIST);
+}
+
+ast_node* ast_list_append(ast_node *list, ast_node *item){
+    list->items = realloc(list->items, (list->n_items + 1) * sizeof(ast_node *));
+    list->items[list->n_items++] = item;
+    return list;
+}
+
+int ast_eval(ast_node *node, ast_value *result, ast_error *error){
+    // Computes the scalar subexpressions and the size of the vectors
+    if(_resolve(node, error) == -1)
+        return -1;
+
+    return _evaluate(node, result, error);
+}
+
+const double* ast_eval_block(ast_node *node, size_t start, size_t len, double *dest, double *scratch){
+    return _fetch(node, start, len, dest, scratch).ptr;
+}
+
+int ast_is_thread_safe(ast_node *node){
+    size_t i;
+
+    if(node == NULL)
+        return 1;
+    if(node->type == AST_CALL && !(node->value.id->flags & FNM_THREAD_SAFE))
+        return 0;
+
+    for(i = 0; i < node->n_items; i++){
+        if(!ast_is_thread_safe(node->items[i]))
+            return 0;
+    }
+    return ast_is_thread_safe(node->left) && ast_is_thread_safe(node->right);
+}
+
+size_t ast_height(ast_node *node){
+    if(node == NULL)
+        return 0;
+
+    size_t left = ast_height(node->left);
+    size_t right = ast_height(node->right);
+    size_t height = (left > right ? left : right);
+
+    // The argument 'i' of a call is computed after keeping the previous ones
+    size_t i;
+    for(i = 0; i < node->n_items; i++){
+        size_t item = i + ast_height(node->items[i]);
+        if(item > height)
+            height = item;
+    }
+    return 1 + height;
+}
+
+void ast_free(ast_node *node){
+    if(node != NULL){
+        ast_free(node->left);
+        ast_free(node->right);
+
+        size_t i;
+        for(i = 0; i < node->n_items; i++)
+            ast_free(node->items[i]);
+        free(node->items);
+
+        if(node->type == AST_VEC)
+            vec_free(node->value.vec);
+        free(node);
+    }
+}
+
+
+/** Implementation of private functions **/
+
+ast_node* _new_node(ast_type type){
+    ast_node *node = calloc(1, sizeof(ast_node));
+    node->type = type;
+    return node;
+}
+
+int _resolve(ast_node *node, ast_error *error){
+    switch(node->type){
+        case AST_NUM:
+        case AST_VEC:
+        case AST_GRID:
+            return 0;
+
+        case AST_VAR:
+            if(node->value.id->lc == VAR && !node->value.id->init){
+                error->info = "Uninitialized variable";
+                error->symbol = node->value.id->key;
+                error->row = node->value.id;
+                return -1;
+            }
+            // Scalar variables are replaced by their value
+            if(node->value.id->vec == NULL){
+                node->type = AST_NUM;
+                node->value.num = node->value.id->value.var;
+            }
+            else
+                node->size = node->value.id->vec->size;
+            return 0;
+
+        case AST_LIST:
+            return _resolve_list(node, error);
+
+        case AST_CALL:
+            return _resolve_call(node, error);
+
+        case AST_RANGE:
+            // The limits of an index of a series are already computed
+            if(node->left == NULL)
+                return 0;
+            break;
+
+        case AST_REDUCE:
+            if(node->index != NULL)
+                return _resolve_series(node, error);
+            break;
+
+        case AST_SWEEP:
+            return _resolve_sweep(node, error);
+
+        default:
+            break;
+    }
+
+    if(_resolve(node->left, error) == -1)
+        return -1;
+    if(node->right != NULL && _resolve(node->right, error) == -1)
+        return -1;
+
+    error->symbol = "";
+    error->row = NULL;
+
+    if(node->type == AST_RANGE){
+        // The elements of the range are computed on the fly
+        if(node->left->type != AST_NUM || node->right->type != AST_NUM){
+            error->info = "The limits of a range must be scalars";
+            return -1;
+        }
+        double first = node->left->value.num;
+        double last = node->right->value.num;
+        if(!isfinite(first) || !isfinite(last)){
+            error->info = "The limits of a range must be finite";
+            return -1;
+        }
+
+        if(_range_size(first, last, &node->size) == -1){
+            error->info = "Too many elements on the range";
+            return -1;
+        }
+        node->value.num = first;
+        ast_free(node->left);
+        ast_free(node->right);
+        node->left = node->right = NULL;
+        return 0;
+    }
+
+    // The reduction of a vector is computed only once, without storing it
+    if(node->type == AST_REDUCE){
+        double result = node->left->value.num;
+        if(node->left->type != AST_NUM && reduce(node->value.id->value.op, node->left, &result) == -1){
+            error->info = "Not enough memory to compute the reduction";
+            return -1;
+        }
+        node->type = AST_NUM;
+        node->value.num = result;
+        ast_free(node->left);
+        node->left = NULL;
+        return 0;
+    }
+
+    // A scalar subexpression is computed only once
+    if(node->left->type == AST_NUM && (node->right == NULL || node->right->type == AST_NUM)){
+        node->value.num = _apply(node->type, node->left->value.num,
+                                 node->right != NULL ? node->right->value.num : 0);
+        node->type = AST_NUM;
+        ast_free(node->left);
+        ast_free(node->right);
+        node->left = node->right = NULL;
+        return 0;
+    }
+
+    // Vector operands must have the same number of elements
+    if(node->right != NULL && node->left->type != AST_NUM && node->right->type != AST_NUM
+            && node->left->size != node->right->size){
+        snprintf(_error_symbol, sizeof(_error_symbol), "(%zu and %zu elements)",
+                 node->left->size, node->right->size);
+        error->info = "Vector size mismatch";
+        error->symbol = _error_symbol;
+        return -1;
+    }
+
+    node->size = (node->left->type != AST_NUM) ? node->left->size : node->right->size;
+    return 0;
+}
+
+int _resolve_list(ast_node *node, ast_error *error){
+    size_t i, size = 0;
+
+    // Computes each element (they can be scalars or vectors)
+    for(i = 0; i < node->n_items; i++){
+        if(_resolve(node->items[i], error) == -1)
+            return -1;
+        size_t n = (node->items[i]->type == AST_NUM) ? 1 : node->items[i]->size;
+        // A size that doesn't fit on memory makes vec_new() fail
+        size = (n > SIZE_MAX - size) ? SIZE_MAX : size + n;
+    }
+
+    ast_value value;
+    vector *vec = vec_new(size);
+    if(vec == NULL){
+        error->info = "Not enough memory to build the vector";
+        error->symbol = "";
+        error->row = NULL;
+        return -1;
+    }
+
+    // Concatenates the elements on a new vector
+    size_t pos = 0;
+    for(i = 0; i < node->n_items; i++){
+        if(node->items[i]->type == AST_NUM)
+            vec->data[pos++] = node->items[i]->value.num;
+        else{
+            if(_evaluate(node->items[i], &value, error) == -1){
+                vec_free(vec);
+                return -1;
+            }
+            memcpy(vec->data + pos, value.vec->data, value.vec->size * sizeof(double));
+            pos += value.vec->size;
+            vec_free(value.vec);
+        }
+        ast_free(node->items[i]);
+        node->items[i] = NULL;
+    }
+    free(node->items);
+    node->items = NULL;
+    node->n_items = 0;
+
+    node->type = AST_VEC;
+    node->value.vec = vec;
+    node->size = size;
+    return 0;
+}
+
+int _resolve_call(ast_node *node, ast_error *error){
+    info_row *fnct = node->value.id;
+    double args[FNM_MAX_ARGS];
+    size_t i, size = 0;
+    int scalar = 1;
+
+    if(node->n_items != fnct->arity){
+        snprintf(_error_symbol, sizeof(_error_symbol), "%s (expected %u)", fnct->key, fnct->arity);
+        error->info = "Wrong number of arguments on the call to";
+        error->symbol = _error_symbol;
+        error->row = NULL;
+        return -1;
+    }
+
+    // The vector arguments must have the same number of elements
+    for(i = 0; i < node->n_items; i++){
+        if(_resolve(node->items[i], error) == -1)
+            return -1;
+        if(node->items[i]->type == AST_NUM){
+            args[i] = node->items[i]->value.num;
+            continue;
+        }
+        if(!scalar && node->items[i]->size != size){
+            snprintf(_error_symbol, sizeof(_error_symbol), "(%zu and %zu elements)",
+                     size, node->items[i]->size);
+            error->info = "Vector size mismatch";
+            error->symbol = _error_symbol;
+            error->row = NULL;
+            return -1;
+        }
+        size = node->items[i]->size;
+        scalar = 0;
+    }
+
+    if(!scalar){
+        node->size = size;
+        return 0;
+    }
+
+    // An impure function inside a series or sweep is called for each
+    // value of the variables (see _bind_index())
+    if(!(fnct->flags & FNM_PURE) && node->size > 0)
+        return 0;
+
+    // A call with scalar arguments is computed only once
+    node->type = AST_NUM;
+    node->value.num = _call(fnct, args);
+    for(i = 0; i < node->n_items; i++)
+        ast_free(node->items[i]);
+    free(node->items);
+    node->items = NULL;
+    node->n_items = 0;
+    return 0;
+}
+
+int _evaluate(ast_node *node, ast_value *result, ast_error *error){
+    result->num = 0;
+    result->vec = NULL;
+
+    // If the whole expression is a scalar, it's already evaluated
+    if(node->type == AST_NUM){
+        result->num = node->value.num;
+        return 0;
+    }
+
+    // A vector literal is already built, so it's simply returned
+    if(node->type == AST_VEC){
+        result->vec = node->value.vec;
+        node->value.vec = NULL;
+        return 0;
+    }
+
+    // Evaluates the whole tree block by block
+    result->vec = vec_new(node->size);
+    if(result->vec == NULL || _eval_parallel(node, 0, node->size, result->vec->data) == -1){
+        vec_free(result->vec);
+        result->vec = NULL;
+        error->info = "Not enough memory to evaluate the expression";
+        error->symbol = "";
+        error->row = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+int _resolve_series(ast_node *node, ast_error *error){
+    size_t i;
+
+    // Computes the limits of the index
+    for(i = 0; i < 2; i++){
+        if(_resolve(node->items[i], error) == -1)
+            return -1;
+        if(node->items[i]->type != AST_NUM || !isfinite(node->items[i]->value.num)){
+            error->info = "The limits of a series must be finite scalars";
+            error->symbol = node->index->key;
+            error->row = NULL;
+            return -1;
+        }
+    }
+    double first = node->items[0]->value.num;
+    double last = node->items[1]->value.num;
+    size_t size;
+    if(_range_size(first, last, &size) == -1){
+        error->info = "Too many terms on the series of";
+        error->symbol = node->index->key;
+        error->row = NULL;
+        return -1;
+    }
+
+    // Replaces the index by the range of values it takes, so the terms
+    // are computed as a vector expression that is never stored
+    ast_node bound = {0};
+    bound.type = AST_RANGE;
+    bound.value.num = first;
+    bound.size = size;
+    if(_bind_index(node->left, node->index, &bound, 0, error) == -1)
+        return -1;
+    if(_resolve(node->left, error) == -1)
+        return -1;
+
+    double result;
+    if(node->left->type == AST_NUM)
+        result = reduce_constant(node->value.id->value.op, node->left->value.num, size);
+    else if(reduce(node->value.id->value.op, node->left, &result) == -1){
+        error->info = "Not enough memory to compute the reduction";
+        error->symbol = "";
+        error->row = NULL;
+        return -1;
+    }
+
+    node->type = AST_NUM;
+    node->value.num = result;
+    node->index = NULL;
+    ast_free(node->left);
+    node->left = NULL;
+    for(i = 0; i < node->n_items; i++)
+        ast_free(node->items[i]);
+    free(node->items);
+    node->items = NULL;
+    node->n_items = 0;
+    return 0;
+}
+
+int _resolve_sweep(ast_node *node, ast_error *error){
+    size_t i, n_vars = node->n_items / 4, size;
+
+    ast_grid *grids = malloc(n_vars * sizeof(ast_grid));
+    if(grids == NULL){
+        error->info = "Not enough memory to evaluate the sweep";
+        error->symbol = "";
+        error->row = NULL;
+        return -1;
+    }
+    if(_sweep_grids(node, grids, &size, error) == -1){
+        free(grids);
+        return -1;
+    }
+
+    // Replaces each variable by its coordinate on the points of the grid,
+    // so the expression is computed as a vector over the whole grid
+    ast_node bound = {0};
+    bound.type = AST_GRID;
+    bound.size = size;
+    for(i = 0; i < n_vars; i++){
+        bound.value.grid = grids[i];
+        if(_bind_index(node->left, node->items[4 * i]->value.id, &bound, 0, error) == -1){
+            free(grids);
+            return -1;
+        }
+    }
+    free(grids);
+    if(_resolve(node->left, error) == -1)
+        return -1;
+
+    for(i = 0; i < node->n_items; i++)
+        ast_free(node->items[i]);
+    free(node->items);
+
+    // The sweep is replaced by its expression
+    ast_node *body = node->left;
+    if(body->type == AST_NUM){
+        // A constant is a grid where the variable takes a single value
+        ast_grid constant = {body->value.num, body->value.num, 0, 1, 1};
+        node->type = AST_GRID;
+        node->value.grid = constant;
+        node->size = size;
+        node->left = NULL;
+        node->items = NULL;
+        node->n_items = 0;
+        ast_free(body);
+    }
+    else{
+        *node = *body;
+        free(body);
+    }
+    return 0;
+}
+
+int _sweep_grids(ast_node *node, ast_grid *grids, size_t *size, ast_error *error){
+    size_t i, j, n_vars = node->n_items / 4;
+
+    *size = 1;
+    for(i = 0; i < n_vars; i++){
+        info_row *var = node->items[4 * i]->value.id;
+
+        // Computes the limits and the number of values of the variable
+        for(j = 1; j < 4; j++){
+            if(_resolve(node->items[4 * i + j], error) == -1)
+                return -1;
+        }
+        error->symbol = var->key;
+        error->row = NULL;
+        for(j = 1; j < 4; j++){
+            if(node->items[4 * i + j]->type != AST_NUM || !isfinite(node->items[4 * i + j]->value.num)){
+                error->info = "The limits of a sweep must be finite scalars";
+                return -1;
+            }
+        }
+        for(j = 0; j < i; j++){
+            if(node->items[4 * j]->value.id == var){
+                error->info = "A sweep can't use the same variable twice";
+                return -1;
+            }
+        }
+
+        double n = node->items[4 * i + 3]->value.num;
+        if(n < 1 || n != floor(n)){
+            error->info = "The number of values of a sweep must be a positive integer";
+            return -1;
+        }
+        if(n * (double)*size > (double)(SIZE_MAX / sizeof(double))){
+            error->info = "Too many points on the sweep of";
+            return -1;
+        }
+
+        grids[i].first = node->items[4 * i + 1]->value.num;
+        grids[i].last = node->items[4 * i + 2]->value.num;
+        grids[i].count = (size_t)n;
+        grids[i].step = (grids[i].count > 1) ? (grids[i].last - grids[i].first) / (n - 1) : 0;
+        *size *= grids[i].count;
+    }
+
+    // The values of the last variable change faster
+    size_t stride = 1;
+    for(i = n_vars; i-- > 0;){
+        grids[i].stride = stride;
+        stride *= grids[i].count;
+    }
+
+    return 0;
+}
+
+int _range_size(double first, double last, size_t *size){
+    if(last < first){
+        *size = 0;
+        return 0;
+    }
+
+    // The elements must fit on a vector, even if it's never stored
+    double count = floor(last - first) + 1;
+    if(!isfinite(count) || count >= (double)(SIZE_MAX / sizeof(double)))
+        return -1;
+    *size = (size_t)count;
+    return 0;
+}
+
+int _bind_index(ast_node *node, info_row *index, const ast_node *bound,
+                unsigned nested, ast_error *error){
+    size_t i;
+
+    if(node == NULL)
+        return 0;
+
+    error->symbol = index->key;
+    error->row = NULL;
+
+    if(node->type == AST_VAR && node->value.id == index){
+        if(nested){
+            error->info = "The variable of a series or sweep can't be used inside another reduction";
+            return -1;
+        }
+        node->type = bound->type;
+        node->value = bound->value;
+        node->size = bound->size;
+        return 0;
+    }
+
+    // Each term must be a scalar, but inner reductions can use vectors
+    if(!nested && ((node->type == AST_VAR && node->value.id->vec != NULL)
+            || node->type == AST_VEC || node->type == AST_LIST || node->type == AST_RANGE
+            || node->type == AST_SWEEP)){
+        error->info = "The expression of a series or sweep must be a scalar for each value of";
+        return -1;
+    }
+
+    // An impure function takes the size of the series or sweep, so it's
+    // called once per term even if its arguments don't change
+    if(!nested && node->type == AST_CALL && !(node->value.id->flags & FNM_PURE))
+        node->size = bound->size;
+
+    if(node->type == AST_REDUCE)
+        nested = 1;
+    for(i = 0; i < node->n_items; i++){
+        // The variables of an inner sweep are not expressions
+        if(node->type == AST_SWEEP && i % 4 == 0)
+            continue;
+        if(_bind_index(node->items[i], index, bound, nested, error) == -1)
+            return -1;
+    }
+    if(_bind_index(node->left, index, bound, nested, error) == -1)
+        return -1;
+    return _bind_index(node->right, index, bound, nested, error);
+}
+
+int _eval_parallel(ast_node *node, size_t start, size_t size, double *out){
+    _evaluation e;
+    e.node = node;
+    e.start = start;
+    e.size = size;
+    e.out = out;
+    e.height = ast_height(node);
+    e.status = 0;
+
+    unsigned i, n_workers = pool_get_threads();
+    e.scratch = calloc(n_workers, sizeof(double *));
+    if(e.scratch == NULL)
+        return -1;
+
+    // Each chunk of elements is a task of the thread pool. Expensive
+    // functions are split in smaller chunks to balance the work better
+    e.chunk = (_max_cost(node) >= FNM_COST_EXPENSIVE) ? AST_BLOCK_SIZE : AST_CHUNK_SIZE;
+    size_t n_chunks = (size + e.chunk - 1) / e.chunk;
+    if(ast_is_thread_safe(node))
+        pool_run(n_chunks, _eval_task, &e);
+    else{
+        size_t chunk;
+        for(chunk = 0; chunk < n_chunks; chunk++)
+            _eval_task(&e, chunk, 0);
+    }
+
+    for(i = 0; i < n_workers; i++)
+        free(e.scratch[i]);
+    free(e.scratch);
+    return e.status;
+}
+
+void _eval_task(void *param, size_t chunk, unsigned worker){
+    _evaluation *e = (_evaluation *)param;
+
+    // Each level of the tree needs one block to store its operands
+    if(e->scratch[worker] == NULL){
+        e->scratch[worker] = aligned_alloc(VEC_ALIGNMENT, (e->height + 1) * AST_BLOCK_SIZE * sizeof(double));
+        if(e->scratch[worker] == NULL){
+            __atomic_store_n(&e->status, -1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+
+    size_t pos = chunk * e->chunk;
+    size_t end = pos + e->chunk;
+    if(end > e->size)
+        end = e->size;
+
+    for(; pos < end; pos += AST_BLOCK_SIZE){
+        size_t len = (end - pos < AST_BLOCK_SIZE) ? end - pos : AST_BLOCK_SIZE;
+        _eval_block(e->node, e->start + pos, len, e->out + pos, e->scratch[worker]);
+    }
+}
+
+unsigned _max_cost(ast_node *node){
+    size_t i;
+    unsigned cost = 0, child;
+
+    if(node == NULL)
+        return 0;
+    if(node->type == AST_CALL)
+        cost = node->value.id->cost;
+
+    for(i = 0; i < node->n_items; i++){
+        if((child = _max_cost(node->items[i])) > cost)
+            cost = child;
+    }
+    if((child = _max_cost(node->left)) > cost)
+        cost = child;
+    if((child = _max_cost(node->right)) > cost)
+        cost = child;
+    return cost;
+}
+
+double _grid_point(const ast_grid *grid, size_t k){
+    // Each half is computed from its nearest limit, so both are exact
+    if(2 * k < grid->count)
+        return grid->first + grid->step * (double)k;
+    return grid->last - grid->step * (double)(grid->count - 1 - k);
+}
+
+double _call(const info_row *fnct, const double *args){
+    if(fnct->signature == FNM_SIGNATURE_ARRAY)
+        return ((double (*)(const double *))fnct->value.fnct_d)(args);
+
+    switch(fnct->arity){
+        case 1:  return ((double (*)(double))fnct->value.fnct_d)(args[0]);
+        case 2:  return ((double (*)(double, double))fnct->value.fnct_d)(args[0], args[1]);
+        case 3:  return ((double (*)(double, double, double))fnct->value.fnct_d)(args[0], args[1], args[2]);
+        default: return ((double (*)(double, double, double, double))fnct->value.fnct_d)(args[0], args[1], args[2], args[3]);
+    }
+}
+
+void _call_vec(const info_row *fnct, const double **args, double *out, size_t len){
+    if(fnct->signature == FNM_SIGNATURE_ARRAY){
+        ((void (*)(const double *const *, double *, size_t))fnct->fnct_vec)(args, out, len);
+        return;
+    }
+
+    switch(fnct->arity){
+        case 1:
+            ((void (*)(const double *, double *, size_t))fnct->fnct_vec)(args[0], out, len);
+            break;
+        case 2:
+            ((void (*)(const double *, const double *, double *, size_t))fnct->fnct_vec)
+                (args[0], args[1], out, len);
+            break;
+        case 3:
+            ((void (*)(const double *, const double *, const double *, double *, size_t))fnct->fnct_vec)
+                (args[0], args[1], args[2], out, len);
+            break;
+        default:
+            ((void (*)(const double *, const double *, const double *, const double *, double *, size_t))fnct->fnct_vec)
+                (args[0], args[1], args[2], args[3], out, len);
+    }
+}
+
+double _apply(ast_type type, double x, double y){
+    switch(type){
+        case AST_NEG: return -x;
+        case AST_ADD: return x + y;
+        case AST_SUB: return x - y;
+        case AST_MUL: return x * y;
+        case AST_DIV: return x / y;
+        case AST_MOD: return fmod(x, y);
+        case AST_POW: return pow(x, y);
+        default:      return 0;
+    }
+}
+
+_operand _fetch(ast_node *node, size_t start, size_t len, double *dest, double *scratch){
+    _operand op = {NULL, 0};
+
+    switch(node->type){
+        case AST_NUM:
+            op.num = node->value.num;
+            break;
+        case AST_VAR:
+            // Stored vectors are read in place, without any copy
+            op.ptr = node->value.id->vec->data + start;
+            break;
+        case AST_VEC:
+            op.ptr = node->value.vec->data + start;
+            break;
+        default:
+            _eval_block(node, start, len, dest, scratch);
+            op.ptr = dest;
+    }
+
+    return op;
+}
+
+/* Applies an elementwise expression to the operands 'x' and 'y' of a block */
+#define _KERNEL(EXPR)                                                       \
+    if(x.ptr != NULL && y.ptr != NULL){                                     \
+        for(i = 0; i < len; i++){                                           \
+            double a = x.ptr[i], b = y.ptr[i];                              \
+            out[i] = (EXPR);                                                \
+        }                                                                   \
+    }                                                                       \
+    else if(x.ptr != NULL){                                                 \
+        double b = y.num;                                                   \
+        for(i = 0; i < len; i++){                                           \
+            double a = x.ptr[i];                                            \
+            out[i] = (EXPR);                                                \
+        }                                                                   \
+    }                                                                       \
+    else{                                                                   \
+        double a = x.num;                                                   \
+        for(i = 0; i < len; i++){                                           \
+            double b = y.ptr[i];                                            \
+            out[i] = (EXPR);                                                \
+        }                                                                   \
+    }
+
+// Its loops are compiled for several instruction sets. With
+// -ffp-contract=off (see the Makefile) no version joins a multiplication
+// and an addition, so all of them give the same results
+FNM_TARGET_CLONES
+void _eval_block(ast_node *node, size_t start, size_t len, double *out, double *scratch){
+    _operand x, y;
+    size_t i;
+
+    switch(node->type){
+        case AST_NUM:
+            for(i = 0; i < len; i++)
+                out[i] = node->value.num;
+            return;
+
+        case AST_VAR:
+            memcpy(out, node->value.id->vec->data + start, len * sizeof(double));
+            return;
+
+        case AST_VEC:
+            memcpy(out, node->value.vec->data + start, len * sizeof(double));
+            return;
+
+        case AST_RANGE: {
+            // The position is computed exactly, so it only rounds once
+            double pos = (double)start;
+            for(i = 0; i < len; i++)
+                out[i] = node->value.num + (pos + (double)(int)i);
+            return;
+        }
+
+        case AST_GRID: {
+            // Fills the runs of consecutive points with the same coordinate
+            const ast_grid *grid = &node->value.grid;
+            size_t j, k = (start / grid->stride) % grid->count;
+            size_t run = grid->stride - start % grid->stride;
+            for(i = 0; i < len; i += run, run = grid->stride){
+                double x = _grid_point(grid, k);
+                if(run > len - i)
+                    run = len - i;
+                for(j = 0; j < run; j++)
+                    out[i + j] = x;
+                k = (k + 1 < grid->count) ? k + 1 : 0;
+            }
+            return;
+        }
+
+        case AST_NEG:
+            x = _fetch(node->left, start, len, out, scratch);
+            for(i = 0; i < len; i++)
+                out[i] = -x.ptr[i];
+            return;
+
+        case AST_CALL:
+            _eval_call(node, start, len, out, scratch);
+            return;
+
+        default:
+            break;
+    }
+
+    // The first operand is computed on the output block, and the
+    // second one on the scratch block of the current level
+    x = _fetch(node->left, start, len, out, scratch);
+    y = _fetch(node->right, start, len, scratch, scratch + AST_BLOCK_SIZE);
+
+    switch(node->type){
+        case AST_ADD: _KERNEL(a + b); break;
+        case AST_SUB: _KERNEL(a - b); break;
+        case AST_MUL: _KERNEL(a * b); break;
+        case AST_DIV: _KERNEL(a / b); break;
+        case AST_MOD: _KERNEL(fmod(a, b)); break;
+        case AST_POW: _KERNEL(pow(a, b)); break;
+        default: break;
+    }
+}
+
+void _eval_call(ast_node *node, size_t start, size_t len, double *out, double *scratch){
+    const info_row *fnct = node->value.id;
+    _operand x[FNM_MAX_ARGS];
+    double args[FNM_MAX_ARGS];
+    size_t i, j, n = node->n_items;
+
+    // The first argument is computed on the output block, and the
+    // argument 'j' on the scratch block 'j - 1' of the current level
+    x[0] = _fetch(node->items[0], start, len, out, scratch);
+    for(j = 1; j < n; j++)
+        x[j] = _fetch(node->items[j], start, len, scratch + (j - 1) * AST_BLOCK_SIZE,
+                      scratch + j * AST_BLOCK_SIZE);
+
+    // The array form of the function computes the whole block at once
+    if(fnct->fnct_vec != NULL){
+        const double *ptrs[FNM_MAX_ARGS];
+        for(j = 0; j < n; j++){
+            if(x[j].ptr == NULL){
+                // Scalar arguments are copied on their unused block
+                double *block = (j == 0) ? out : scratch + (j - 1) * AST_BLOCK_SIZE;
+                for(i = 0; i < len; i++)
+                    block[i] = x[j].num;
+                x[j].ptr = block;
+            }
+            ptrs[j] = x[j].ptr;
+        }
+        _call_vec(fnct, ptrs, out, len);
+        return;
+    }
+
+    // A pure function is not called again while its arguments repeat,
+    // like the coordinates of the first variables of a sweep
+    int memo = (fnct->flags & FNM_PURE) && fnct->cost >= FNM_COST_MEDIUM;
+
+    if(!memo && n == 1 && x[0].ptr != NULL && fnct->signature == FNM_SIGNATURE_NATIVE){
+        double (*f)(double) = (double (*)(double))fnct->value.fnct_d;
+        for(i = 0; i < len; i++)
+            out[i] = f(x[0].ptr[i]);
+        return;
+    }
+
+    double last[FNM_MAX_ARGS], value = 0;
+    for(j = 0; j < n; j++)
+        args[j] = x[j].num;
+    for(i = 0; i < len; i++){
+        for(j = 0; j < n; j++){
+            if(x[j].ptr != NULL)
+                args[j] = x[j].ptr[i];
+        }
+        if(!memo || i == 0 || memcmp(args, last, n * sizeof(double)) != 0){
+            value = _call(fnct, args);
+            if(memo)
+                memcpy(last, args, n * sizeof(double));
+        }
+        out[i] = value;
+    }
+}
@@ -0,0 +1,273 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: AST.h
+ * Definitions of the expression tree built by
+ * the sintactic analyzer and its evaluator.
+ * Vector expressions are not evaluated operator
+ * by operator: the whole tree is executed in a
+ * single fused pass over blocks of elements
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef AST_H
+#define AST_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "ST.h"
+#include "vector.h"
+
+/* Number of elements of each block of the fused evaluator */
+// Every intermediate result of a block stays on the L1 cache
+#define AST_BLOCK_SIZE 512
+
+/* Number of elements of each task of the parallel evaluator */
+#define AST_CHUNK_SIZE (8 * AST_BLOCK_SIZE)
+
+/** Types of node of the expression tree **/
+typedef enum {
+    AST_NUM,        // Number (literal or already evaluated subexpression)
+    AST_VAR,        // Variable or constant of the symbol table
+    AST_VEC,        // Vector owned by the node
+    AST_LIST,       // Vector literal '[a, b, ...]'
+    AST_RANGE,      // Range 'a:b', its elements are never stored
+    AST_NEG,        // Negation
+    AST_ADD,        // Addition
+    AST_SUB,        // Substraction
+    AST_MUL,        // Multiplication
+    AST_DIV,        // Division
+    AST_MOD,        // Module
+    AST_POW,        // Exponentiation
+    AST_CALL,       // Call to a library function
+    AST_REDUCE,     // Reduction of a vector (sum, prod, min, max, mean)
+    AST_SWEEP,      // Expression evaluated over a grid of variable values
+    AST_GRID        // Coordinate of the points of a grid, never stored
+} ast_type;
+
+/** Values taken by a variable of a sweep **/
+// The point 'p' of the grid has the coordinate number (p / stride) % count,
+// so the last variable changes faster than the first one
+typedef struct {
+    double first, last;     // First and last values of the variable
+    double step;            // Distance between two consecutive values
+    size_t count;           // Number of values
+    size_t stride;          // Number of consecutive points with each value
+} ast_grid;
+
+/** Node of the expression tree **/
+typedef struct ast_node {
+    ast_type type;
+    union {
+        double num;             // Value of AST_NUM and first element of AST_RANGE
+        info_row *id;           // Symbol of AST_VAR, AST_CALL and AST_REDUCE
+        vector *vec;            // Vector of AST_VEC
+        ast_grid grid;          // Coordinate of AST_GRID
+    } value;
+    size_t size;                // Number of elements of a vector expression
+    struct ast_node *left, *right;  // Operands
+    struct ast_node **items;    // Elements of AST_LIST, arguments of AST_CALL
+                                // or limits of a series or sweep
+    size_t n_items;             // Number of elements of 'items'
+    info_row *index;            // Index variable of a series (AST_REDUCE)
+} ast_node;
+
+/** Result of the evaluation of an expression **/
+typedef struct {
+    double num;     // Value if the expression is a scalar
+    vector *vec;    // Value if the expression is a vector (NULL if scalar)
+} ast_value;
+
+/** Information about an evaluation error **/
+typedef struct {
+    char *info;     // Description of the error
+    char *symbol;   // Symbol that caused the error
+    info_row *row;  // Uninitialized variable found (NULL if there is none)
+} ast_error;
+
+/**
+ * Creates a leaf node with a number
+ *
+ * @param num: The number
+ * @return The new node
+ */
+ast_node* ast_num(double num);
+
+/**
+ * Creates a leaf node with a variable or constant
+ *
+ * @param id: The information of the symbol on the symbol table
+ * @return The new node
+ */
+ast_node* ast_var(info_row *id);
+
+/**
+ * Creates a node with an operator and its operands
+ *
+ * @param type: The operator (AST_NEG, AST_ADD... or AST_RANGE)
+ * @param left: The first operand
+ * @param right: The second operand (NULL for AST_NEG)
+ * @return The new node
+ */
+ast_node* ast_op(ast_type type, ast_node *left, ast_node *right);
+
+/**
+ * Creates a node with a call to a library function. The number of
+ * arguments is checked against the arity of the function when the
+ * expression is evaluated
+ *
+ * @param fnct: The information of the function on the symbol table
+ * @param args: Vector literal with the arguments (see ast_list()). It
+ * becomes the new node
+ * @return The new node
+ */
+ast_node* ast_call(info_row *fnct, ast_node *args);
+
+/**
+ * Creates a node with a reduction of an expression
+ *
+ * @param fnct: The information of the reduction on the symbol table
+ * @param arg: The expression to be reduced
+ * @return The new node
+ */
+ast_node* ast_reduce(info_row *fnct, ast_node *arg);
+
+/**
+ * Creates a node with a reduction of a series 'sum(k, a, b, expr)'. The
+ * expression is compiled once, with the index variable replaced by the
+ * range of values it takes, and it's reduced like any other vector
+ * expression. The value of the index variable in the workspace doesn't
+ * change
+ *
+ * @param fnct: The information of the reduction on the symbol table
+ * @param index: The information of the index variable
+ * @param first: The expression of the first value of the index
+ * @param last: The expression of the last value of the index
+ * @param body: The expression of each term of the series
+ * @return The new node
+ */
+ast_node* ast_series(info_row *fnct, info_row *index, ast_node *first, ast_node *last, ast_node *body);
+
+/**
+ * Creates a node with a sweep 'sweep(expr, x, a, b, n)', that evaluates
+ * an expression with the variable taking 'n' equally spaced values from
+ * 'a' to 'b'. Like a series, the expression is compiled once with the
+ * variable replaced by the values it takes, and the value of the variable
+ * in the workspace doesn't change
+ *
+ * @param body: The expression evaluated on each point
+ * @param var: The information of the variable
+ * @param first: The expression of the first value of the variable
+ * @param last: The expression of the last value of the variable
+ * @param n: The expression of the number of values
+ * @return The new node
+ */
+ast_node* ast_sweep(ast_node *body, info_row *var, ast_node *first, ast_node *last, ast_node *n);
+
+/**
+ * Adds a variable to a sweep. The expression is evaluated over the
+ * Cartesian product of the values of all the variables, and the values
+ * of the last variable added change faster
+ *
+ * @param sweep: The sweep
+ * @param var: The information of the variable
+ * @param first: The expression of the first value of the variable
+ * @param last: The expression of the last value of the variable
+ * @param n: The expression of the number of values
+ * @return The sweep
+ */
+ast_node* ast_sweep_append(ast_node *sweep, info_row *var, ast_node *first, ast_node *last, ast_node *n);
+
+/**
+ * Evaluates a sweep and writes each point to a file, one per line, with
+ * the values of the variables followed by the value of the expression.
+ * The points are computed in parallel by groups, so they are never all
+ * stored. The tree is modified, so it can only be evaluated once
+ *
+ * @param node: The sweep
+ * @param file: The file where the points are written
+ * @param n_points: Place to store the number of points written
+ * @param error: Place to store the information of the error, if any
+ * @return 0 if everything went well or -1 if there was an error
+ */
+int ast_sweep_write(ast_node *node, FILE *file, size_t *n_points, ast_error *error);
+
+/**
+ * Creates an empty vector literal
+ *
+ * @return The new node
+ */
+ast_node* ast_list();
+
+/**
+ * Adds an element at the end of a vector literal
+ *
+ * @param list: The vector literal
+ * @param item: The expression of the new element
+ * @return The vector literal
+ */
+ast_node* ast_list_append(ast_node *list, ast_node *item);
+
+/**
+ * Evaluates an expression tree. Scalar subexpressions are computed
+ * once, and vector subexpressions are fused into a single pass that
+ * reads each element of the operands once and writes each element of
+ * the result once. The elements are split in chunks computed by the
+ * thread pool. The tree is modified during the evaluation, so it
+ * can only be evaluated once
+ *
+ * @param node: The root of the expression tree
+ * @param result: Place to store the value of the expression. If it's a
+ * vector, the caller must free it
+ * @param error: Place to store the information of the error, if any
+ * @return 0 if everything went well or -1 if there was an error
+ */
+int ast_eval(ast_node *node, ast_value *result, ast_error *error);
+
+/**
+ * Evaluates a block of elements of a vector expression already resolved
+ * by ast_eval(). Stored vectors are not copied, their elements are
+ * returned in place
+ *
+ * @param node: The root of the vector expression
+ * @param start: Position of the first element of the block
+ * @param len: Number of elements of the block (at most AST_BLOCK_SIZE)
+ * @param dest: Block where the elements are computed, if needed
+ * @param scratch: Free blocks for the intermediate results, one per
+ * level of the tree (see ast_height())
+ * @return The pointer to the elements of the block
+ */
+const double* ast_eval_block(ast_node *node, size_t start, size_t len, double *dest, double *scratch);
+
+/**
+ * Checks if the elements of a resolved vector expression can be computed
+ * by several threads at the same time
+ *
+ * @param node: The root of the vector expression
+ * @return 1 if all its functions are thread safe or 0 if not
+ */
+int ast_is_thread_safe(ast_node *node);
+
+/**
+ * Computes the height of an expression tree
+ *
+ * @param node: The root of the expression tree
+ * @return The number of levels of the tree
+ */
+size_t ast_height(ast_node *node);
+
+/**
+ * Frees the memory associated to an expression tree
+ *
+ * @param node: The root of the expression tree (NULL is allowed)
+ */
+void ast_free(ast_node *node);
+
+#endif /* AST_H */
\ No newline at end of file
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "sintactic.tab.h"
+#include "format.h"
 
 
 
@@ -33,12 +34,14 @@ struct node{
 /** Declaration of private functions **/
 unsigned _is_empty(symbol_table st);
 struct node* _node_search(symbol_table *st, char *key);
-info_row _delete_reestructure(symbol_table *st);
+struct node* _detach_min(symbol_table *st);
+void _delete_node(symbol_table *st);
 
 /** PUBLIC FUNCTIONS: Defined on ST.h **/
 
 symbol_table* st_init(init_commands commands_list[]){
     symbol_table *st = malloc (sizeof(symbol_table));
+    *st = NULL; // The table starts empty
 
     int i;
     for(i = 0; commands_list[i].fnct_name != 0; i++){
@@ -77,9 +80,17 @@ int st_insert(symbol_table *st, char *key, int lc){
 
         info_row new_info;
         // Copy the alphanumeric string inside the info struct
-        new_info.key = malloc(sizeof(key));
+        new_info.key = malloc(strlen(key) + 1);
         strcpy(new_info.key, key);
+        new_info.value.var = 0;
+        new_info.vec = NULL;
         new_info.init = 0; // Marks the variable as not initialized
+        new_info.arity = 0;
+        new_info.signature = 0;
+        new_info.fnct_vec = NULL;
+        new_info.flags = 0;
+        new_info.cost = 0;
+        new_info.used = 0;
         new_info.lc =lc;
         (*st)->info = new_info;
 
@@ -105,7 +116,9 @@ int st_insert(symbol_table *st, char *key, int lc){
 }
 
 int st_delete(symbol_table *st, char *key){
-    symbol_table aux; // Auxiliar symbol tree necessary during deletion
+    // If the current node is empty, the string isn't on the table
+    if(_is_empty(*st))
+        return -1;
 
     //Search for the corresponding node (similar to st_search)
     int comp = strcmp(key, (*st)->info.key);
@@ -118,43 +131,9 @@ int st_delete(symbol_table *st, char *key){
     else if(comp > 0)
         return st_delete(&(*st)->right, key);
 
-    else if(_is_empty((*st)->left) && _is_empty((*st)->right)){
-        // If both sons are empty, simply delete the node
-        free(*st);
-        *st = NULL;
-
-        return 0;
-    }
-
-    else if(_is_empty((*st)->left)){
-        // If only right node exists, delete the node and
-        // replace by the son
-        aux = *st;
-        *st = (*st)->right;
-        free(aux);
-
-        return 0;
-    }
-
-    else if(_is_empty((*st)->left)){
-        // If only right node exists, delete the node and
-        // replace by the son
-        aux = *st;
-        *st = (*st)->left;
-        free(aux);
-
-        return 0;
-    }
-
-    else{
-        // If both sons exist, delete the node and replace
-        // by one of them and reestructure the sucessive sons
-        (*st)->info = _delete_reestructure(&(*st)->right);
-
-        return 0;
-    }
-
-    return -1;
+    // In other case, it's the node to be deleted
+    _delete_node(st);
+    return 0;
 }
 
 info_row* st_get_info_row(symbol_table *st, char *key){
@@ -173,47 +152,26 @@ void st_show_lc_items(symbol_table st, int lc){
         // In-order search (LNR) to show the strings in alphabetical order
         st_show_lc_items(st->left, lc);
 
-        if(st->info.lc == lc)
-            printf("\t%s:\t%.10g\n", st->info.key, st->info.value.var);
+        if(st->info.lc == lc && st->info.vec != NULL)
+            printf("\t%s:\t[vector of %zu elements]\n", st->info.key, st->info.vec->size);
+        else if(st->info.lc == lc){
+            char text[FORMAT_SIZE];
+            format_number(st->info.value.var, text);
+            printf("\t%s:\t%s\n", st->info.key, text);
+        }
 
         st_show_lc_items(st->right, lc);
     }
 }
 
 void st_delete_lc_items(symbol_table *st, int lc){
-    symbol_table aux; // Auxiliar symbol_table necessary during deletion
-
     if(!_is_empty(*st)){
         st_delete_lc_items(&(*st)->left, lc);
         st_delete_lc_items(&(*st)->right, lc);
 
         // Only deletes the string with the lexical component 'lc'
-        if((*st)->info.lc == lc){
-            if(_is_empty((*st)->left) && _is_empty((*st)->right)){
-                // If both sons are empty, simply delete the node
-                free(*st);
-                *st = NULL;
-            }
-            else if(_is_empty((*st)->left)){
-                // If only right node exists, delete the node and
-                // replace by the son
-                aux = *st; // Copy the node to be deleted
-                *st = (*st)->right;
-                free(aux);
-            }
-            else if(_is_empty((*st)->right)){
-                // If only left node exists, delete the node and
-                // replace by the son
-                aux = *st; // Copy the node to be deleted
-                *st = (*st)->left;
-                free(aux);
-            }
-            else{
-                // If both sons exist, delete the node and replace
-                // by one of them and reestructure the sucessive sons
-                (*st)->info = _delete_reestructure(&(*st)->right);
-            }
-        }
+        if((*st)->info.lc == lc)
+            _delete_node(st);
     }    
 }
 
@@ -247,7 +205,7 @@ int st_addCommand(symbol_table *st, char *key, void (*command)()){
     return 0; 
 }
 
-int st_addFunction(symbol_table *st, char *key, double (*fnc_ptr)()){
+int st_addFunction(symbol_table *st, char *key, const fnm_function *fnct){
     // Searches the corresponding node
     struct node* st_node = _node_search(st, key);
 
@@ -255,7 +213,12 @@ int st_addFunction(symbol_table *st, char *key, double (*fnc_ptr)()){
     if(st_node == NULL)
         return -1;
 
-    st_node->info.value.fnct_d = fnc_ptr; 
+    st_node->info.value.fnct_d = fnct->fnct; 
+    st_node->info.arity = fnct->arity;
+    st_node->info.signature = fnct->signature;
+    st_node->info.fnct_vec = fnct->fnct_vec;
+    st_node->info.flags = fnct->flags;
+    st_node->info.cost = (fnct->cost != FNM_COST_UNKNOWN) ? fnct->cost : FNM_COST_MEDIUM;
     return 0; 
 }
 
@@ -265,6 +228,7 @@ void st_free(symbol_table *st){
         st_free(&((*st)->right)); // Frees the right son
 
         free((*st)->info.key);
+        vec_free((*st)->info.vec);
         free(*st);
         *st = NULL;
     }
@@ -303,18 +267,46 @@ struct node* _node_search(symbol_table *st, char *key){
         return NULL;
 }
 
-info_row _delete_reestructure(symbol_table *st){
-    symbol_table aux; // Auxiliar symbol_table necessary during deletion
-    info_row info_node; // info_row to be returned
+struct node* _detach_min(symbol_table *st){
+    struct node *min; // Node to be returned
 
     if(_is_empty((*st)->left)){
-        info_node = (*st)->info;
-        aux = *st; // Copy the node to be deleted
+        // The minimum is replaced by its right son
+        min = *st;
         *st = (*st)->right;
-        free(aux);
-        return info_node;
+        return min;
     }
     else{
-        return _delete_reestructure(&(*st)->left);
+        return _detach_min(&(*st)->left);
     }
 }
+
+void _delete_node(symbol_table *st){
+    symbol_table aux = *st; // Copy the node to be deleted
+
+    if(_is_empty(aux->left) && _is_empty(aux->right)){
+        // If both sons are empty, simply delete the node
+        *st = NULL;
+    }
+    else if(_is_empty(aux->left)){
+        // If only right node exists, replace the node by the son
+        *st = aux->right;
+    }
+    else if(_is_empty(aux->right)){
+        // If only left node exists, replace the node by the son
+        *st = aux->left;
+    }
+    else{
+        // If both sons exist, replace the node by the minimum of
+        // the right son. Nodes are relinked instead of copying their
+        // information, so pointers to the info_row remain valid
+        struct node *min = _detach_min(&aux->right);
+        min->left = aux->left;
+        min->right = aux->right;
+        *st = min;
+    }
+
+    free(aux->info.key);
+    vec_free(aux->info.vec);
+    free(aux);
+}
@@ -18,6 +18,9 @@
 #ifndef ST_H
 #define ST_H
 
+#include "vector.h"
+#include "../lib/fnm_plugin.h"
+
 /** Information that the symbol table contains in each node **/
 typedef struct {
     char *key;      // The alphanumeric string
@@ -26,8 +29,16 @@ typedef struct {
         double var;
         double (*fnct_d)();
         void (*command)();
+        int op;     // The identifier of a reduction (see reduce.h)
     }value;
+    vector *vec;    // The value of the variable if it's a vector (NULL if not)
     unsigned init;  // Checks if the variable has been initialized
+    unsigned arity;     // Number of arguments of a function
+    unsigned signature; // How the arguments of a function are passed (see fnm_plugin.h)
+    void (*fnct_vec)(); // Array form of a function (NULL if there is none)
+    unsigned flags;     // Properties of a function (see fnm_plugin.h)
+    unsigned cost;      // Cost of each call to a function (see fnm_plugin.h)
+    unsigned long used; // Last line that used the symbol (see newline())
 } info_row;
 
 /** Type definition as a pointer to node **/
@@ -71,6 +82,7 @@ int st_insert(symbol_table *st, char *key, int lc);
 
 /**
  * Deletes an element from the symbol table
+ * The information of the rest of elements doesn't change its address
  * 
  * @param st: Pointer to the symbol table that contains the alphanumeric strings
  * @param key: The alphanumeric string
@@ -134,10 +146,10 @@ int st_addCommand(symbol_table *st, char *key, void (*command)());
  * 
  * @param st: Pointer to the symbol table that contains the aplhanumeric strings
  * @param key: The alphanumeric string (the function name)
- * @param fnc_ptr: Pointer to the function associated
+ * @param fnct: Declaration of the function (pointers, arguments...)
  * @return 0 if everything went well or -1 if there was an error
  */ 
-int st_addFunction(symbol_table *st, char *key, double (*fnc_ptr)());
+int st_addFunction(symbol_table *st, char *key, const fnm_function *fnct);
 
 /**
  * Frees the memory associated to the symbol table
@@ -16,11 +16,21 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <stdarg.h>
 #include <dlfcn.h>
 #include "commands.h"
 #include "ST.h"
 #include "sintactic.tab.h"
 #include "lex.yy.h"
+#include "pool.h"
+#include "library.h"
+#include "output.h"
+#include "format.h"
+#include "pipeline.h"
+#include "schedule.h"
+#include "../lib/fnm_plugin.h"
 
 
 /* List of predefined functions/commands */
@@ -31,12 +41,28 @@ init_commands list_commands[] = {
     {"echo", change_echo, COMMAND},
     {"load", load, COMMAND_P},
     {"include", include, COMMAND_2P},
+    {"binding", binding, COMMAND_P},
+    {"parallel", change_parallel, COMMAND_P},
+    {"pipeline", change_pipeline, COMMAND_P},
+    {"reload", reload, COMMAND_2P},
     {"print", print, COMMAND_P},
     {"quit", quit, COMMAND},
+    {"threads", threads, COMMAND_N},
+    {"workers", workers, COMMAND},
+    {"seed", seed, COMMAND_N},
+    {"flush", flush, COMMAND},
+    {"format", format, COMMAND_N},
+    {"sweep", NULL, SWEEP}, // Evaluated by the sintactic analyzer
     {0, 0} // Must end with two 0, following st_init() preconditions
 };
 
 
+/** Declaration of private functions **/
+int _include_plugin(const fnm_plugin *info, symbol_table *st);
+void _include_symbols(void *library, symbol_table *st);
+void _remove_functions(void *old, symbol_table *st);
+void _command_error(const char *format, ...);
+
 /** PUBLIC FUNCTIONS: Defined on commands.h **/
 void help(void* param){
     printf("\n************************************************************\n");
@@ -46,36 +72,47 @@ void help(void* param){
     printf("computational functions (like trigonometrics)\n");
 
     printf("\nList of commands:\n");
+    printf("\t- binding(\"mode\"):\tSets when the functions of a library are bound (\"now\" or \"lazy\")\n");
     printf("\t- clear:\t\tDeletes all the defined variables\n");
     printf("\t- echo:\t\t\tEnables/Disables printing in a variable assignment\n");
+    printf("\t- flush:\t\tWrites the pending output (when it's not a terminal)\n");
+    printf("\t- format(n):\t\tPrints the results with n significant digits (0 for the shortest exact form)\n");
     printf("\t- help:\t\t\tShows the current help menu\n");
     printf("\t- include(\"file\"):\tLoads functions and constants from a library\n");
+    printf("\t\t\t\t(\"builtin:trig\", \"builtin:exp\" or \"builtin:round\" for the built-in ones)\n");
     printf("\t- load(\"file\"):\t\tLoads expresions from an extern file\n");
+    printf("\t- parallel(\"mode\"):\tRuns the independent lines of the loaded files at the same time (\"on\") or not (\"off\")\n");
+    printf("\t- pipeline(\"mode\"):\tReads the large loaded files on other threads (\"on\") or not (\"off\")\n");
     printf("\t- print(\"message\"):\tPrints a message to the output\n");
     printf("\t- quit:\t\t\tFinishes the execution of the program\n");
+    printf("\t- reload(\"file\"):\tLoads again a library that has changed\n");
+    printf("\t- seed(n):\t\tSets the seed of the random numbers of the libraries\n");
+    printf("\t- sweep(exp, x, a, b, n, \"file\"):\n\t\t\t\tWrites an expression over a grid to a file\n");
+    printf("\t- threads(n):\t\tSets the number of threads of parallel operations\n");
+    printf("\t- workers:\t\tShows the utilization of the threads\n");
     printf("\t- workspace:\t\tShows all the defined variables\n");
     printf("\n");
 }
 
 void workspace(void* param){
     symbol_table *st = (symbol_table *)param;
-    printf(ANSI_COLOR_BLUE);
+    output_color(OUTPUT_BLUE);
     printf("---------------------------\n");
     printf("Workspace defined variables\n");
     printf("---------------------------\n");
     printf("Variables:\n");
-    printf(ANSI_COLOR_RESET);
+    output_color(OUTPUT_RESET);
     st_show_lc_items(*st, VAR); // Displays all variables
-    printf(ANSI_COLOR_BLUE);
+    output_color(OUTPUT_BLUE);
     printf("Constants:\n");
-    printf(ANSI_COLOR_RESET);
+    output_color(OUTPUT_RESET);
     st_show_lc_items(*st, CONST); // Displays all variables
     printf("***************************\n");
 }
 
 void clear(void *param){
     symbol_table *st = (symbol_table *)param;
-    printf(ANSI_COLOR_BLUE "** Clearing all variables... **" ANSI_COLOR_RESET "\n");
+    output_message(OUTPUT_BLUE, "** Clearing all variables... **");
     st_delete_lc_items(st, VAR); // Deletes all variables
 }
 
@@ -83,11 +120,11 @@ void change_echo(void* param){
     // Changes de value o global variable 'echo'
     // defined on "sintactic.tab.h"
     if(echo == ECHO_OFF){
-        printf(ANSI_COLOR_BLUE "** Enabling echo option for assigments... **" ANSI_COLOR_RESET "\n");
+        output_message(OUTPUT_BLUE, "** Enabling echo option for assigments... **");
         echo = ECHO_ON;
     }
     else{
-        printf(ANSI_COLOR_BLUE "** Disabling echo option for assigments... **" ANSI_COLOR_RESET "\n");
+        output_message(OUTPUT_BLUE, "** Disabling echo option for assigments... **");
         echo = ECHO_OFF;
     }       
 }
@@ -98,21 +135,279 @@ void load(void* param){
     int status = change_input_file(path);
 
     if(status == -1)
-        printf(ANSI_COLOR_RED "LOAD ERROR: Maximum nested files exceeded" ANSI_COLOR_RESET "\n");
+        _command_error("LOAD ERROR: The file is already being loaded");
     else if(status == -2)
-        printf(ANSI_COLOR_RED "LOAD ERROR: File not found" ANSI_COLOR_RESET "\n");
+        _command_error("LOAD ERROR: File not found");
 }
 
 void include(void* param1, void* param2){
     char *path = (char *)param1;
     symbol_table *st = (symbol_table *)param2;
 
-    void *library = dlopen(path, RTLD_LAZY);
-    if(library == NULL){
-        printf(ANSI_COLOR_RED "INCLUDE ERROR: Library not found" ANSI_COLOR_RESET "\n");
+    int loaded;
+
+    // The built-in libraries are already on memory
+    if(strncmp(path, LIBRARY_BUILTIN, strlen(LIBRARY_BUILTIN)) == 0){
+        const fnm_plugin *info = library_builtin(path + strlen(LIBRARY_BUILTIN), &loaded);
+        if(info == NULL)
+            _command_error("INCLUDE ERROR: Unknown built-in library");
+        else if(loaded)
+            output_message(OUTPUT_BLUE, "** Library already included **");
+        else if(_include_plugin(info, st) == 0)
+            output_message(OUTPUT_BLUE, "** Library included succesfully! **");
+        return;
+    }
+
+    const library *lib = library_open(path, &loaded);
+    if(lib == NULL){
+        _command_error("INCLUDE ERROR: Library not found");
+        return;
+    }
+
+    // Its functions and constants are already on the symbol table
+    if(loaded){
+        output_message(OUTPUT_BLUE, "** Library already included **");
+        return;
+    }
+
+    // Libraries with a descriptor declare the arguments of each function,
+    // the rest export arrays of names and functions of one argument
+    // The file of a built-in library already included (like lib/round.so
+    // after "builtin:round") would include the same functions again
+    const fnm_plugin *info = (const fnm_plugin *)dlsym(lib->handle, "fnm_plugin_info");
+    if(info != NULL){
+        if(library_builtin_plugin(info, 0)){
+            output_message(OUTPUT_BLUE, "** Library already included **");
+            return;
+        }
+        if(_include_plugin(info, st) == -1)
+            return;
+        library_builtin_plugin(info, 1);
+    }
+    else
+        _include_symbols(lib->handle, st);
+
+    output_message(OUTPUT_BLUE, "** Library included succesfully! **");
+}
+
+void reload(void* param1, void* param2){
+    char *path = (char *)param1;
+    symbol_table *st = (symbol_table *)param2;
+
+    library *lib = library_find(path);
+    if(lib == NULL){
+        _command_error("RELOAD ERROR: The library is not included");
+        return;
+    }
+
+    // The new version is opened next to the old one, which keeps working
+    // if the new one can't be included
+    void *handle = library_open_copy(lib);
+    if(handle == NULL){
+        _command_error("RELOAD ERROR: Library not found");
+        return;
+    }
+
+    const fnm_plugin *info = (const fnm_plugin *)dlsym(handle, "fnm_plugin_info");
+    if(info != NULL){
+        if(_include_plugin(info, st) == -1){
+            dlclose(handle);
+            return;
+        }
+    }
+    else
+        _include_symbols(handle, st);
+
+    // The symbol table points now to the new functions, and the ones that
+    // don't exist anymore are deleted. No expression is being evaluated
+    // while a command runs, so the old version can be closed
+    void *old = library_replace(lib, handle);
+    _remove_functions(old, st);
+    dlclose(old);
+
+    output_message(OUTPUT_BLUE, "** Library reloaded succesfully! **");
+}
+
+void binding(void* param){
+    char *mode = (char *)param;
+
+    if(strcmp(mode, "now") == 0){
+        library_set_binding(LIBRARY_BIND_NOW);
+        output_message(OUTPUT_BLUE, "** The functions of the next libraries are bound when they are included **");
+    }
+    else if(strcmp(mode, "lazy") == 0){
+        library_set_binding(LIBRARY_BIND_LAZY);
+        output_message(OUTPUT_BLUE, "** The functions of the next libraries are bound on their first call **");
+    }
+    else
+        _command_error("BINDING ERROR: The mode must be \"now\" or \"lazy\"");
+}
+
+void print(void* param){
+    char *string = (char *)param;
+
+    output_message(OUTPUT_CYAN, "%s", string);
+}
+
+void change_pipeline(void* param){
+    char *mode = (char *)param;
+
+    if(strcmp(mode, "on") == 0){
+        pipeline_set_enabled(1);
+        output_message(OUTPUT_BLUE, "** The next loaded files are read and scanned on other threads **");
+    }
+    else if(strcmp(mode, "off") == 0){
+        pipeline_set_enabled(0);
+        output_message(OUTPUT_BLUE, "** The next loaded files are read on the main thread **");
+    }
+    else
+        _command_error("PIPELINE ERROR: The mode must be \"on\" or \"off\"");
+}
+
+void change_parallel(void* param){
+    char *mode = (char *)param;
+
+    if(strcmp(mode, "on") == 0){
+        schedule_set_enabled(1);
+        output_message(OUTPUT_BLUE, "** The independent lines of the loaded files run at the same time **");
+    }
+    else if(strcmp(mode, "off") == 0){
+        schedule_set_enabled(0);
+        output_message(OUTPUT_BLUE, "** The lines of the loaded files run one by one **");
+    }
+    else
+        _command_error("PARALLEL ERROR: The mode must be \"on\" or \"off\"");
+}
+
+void threads(void* param){
+    double n = *(double *)param;
+
+    if(n < 0 || n != floor(n)){
+        _command_error("THREADS ERROR: The number of threads must be a positive integer");
+        return;
+    }
+
+    // 0 selects one thread per available processor
+    pool_set_threads(n > POOL_MAX_THREADS ? POOL_MAX_THREADS : (unsigned)n);
+    output_message(OUTPUT_BLUE, "** Using %u threads for parallel operations **", pool_get_threads());
+}
+
+void workers(void* param){
+    pool_stats stats;
+    unsigned i;
+    double uptime = pool_get_uptime();
+
+    if(uptime == 0){
+        output_message(OUTPUT_BLUE, "** The threads have not been used yet **");
+        return;
+    }
+
+    output_color(OUTPUT_BLUE);
+    printf("--------------------------------------------------\n");
+    printf("Utilization of the threads (%.3f s)\n", uptime);
+    printf("--------------------------------------------------\n");
+    printf("Thread\tJobs\tTasks\tSteals\tBusy (s)\tUse\n");
+    output_color(OUTPUT_RESET);
+    for(i = 0; pool_get_stats(i, &stats) == 0; i++)
+        printf("%u\t%lu\t%lu\t%lu\t%.6f\t%.2f%%\n", i, stats.jobs, stats.tasks,
+                stats.steals, stats.busy, 100 * stats.busy / uptime);
+    printf("**************************************************\n");
+}
+
+void seed(void* param){
+    double n = *(double *)param;
+
+    // 2^64 is the first integer out of range
+    if(n < 0 || n != floor(n) || n >= 18446744073709551616.0){
+        _command_error("SEED ERROR: The seed must be an integer between 0 and 2^64 - 1");
+        return;
+    }
+
+    int count = library_seed((unsigned long long)n);
+    if(count == 0)
+        output_message(OUTPUT_BLUE, "** Seed set for the libraries included from now on **");
+    else
+        output_message(OUTPUT_BLUE, "** Seed set for %d libraries **", count);
+}
+
+void format(void* param){
+    double n = *(double *)param;
+
+    if(n < 0 || n > FORMAT_MAX_DIGITS || n != floor(n)){
+        _command_error("FORMAT ERROR: The number of digits must be an integer between 0 and %d", FORMAT_MAX_DIGITS);
         return;
     }
 
+    format_set_digits((unsigned)n);
+    if(n == FORMAT_SHORTEST)
+        output_message(OUTPUT_BLUE, "** Printing the shortest form of the results that is read back exactly **");
+    else
+        output_message(OUTPUT_BLUE, "** Printing the results with %u significant digits **", format_get_digits());
+}
+
+void flush(void* param){
+    output_flush();
+}
+
+void quit(void* param){
+    symbol_table *st = (symbol_table *)param;
+
+    st_free(st); //Frees memory reserved by the symbol table
+    pool_free(); //Stops the threads of parallel operations
+    library_free(); //Closes the included libraries
+
+    exit(exit_status()); //Fails in batch mode if any line had errors
+}
+
+
+/** Implementation of private functions **/
+
+int _include_plugin(const fnm_plugin *info, symbol_table *st){
+    int i;
+
+    if(info->version < 2){
+        _command_error("INCLUDE ERROR: Unknown version of the library");
+        return -1;
+    }
+
+    if(info->functions != NULL){
+        output_message(OUTPUT_BLUE, "Including functions...");
+        for(i = 0; ; i++){
+            // The functions are read with the size declared by the library,
+            // and the fields it doesn't know are left to 0
+            fnm_function fnct;
+            memset(&fnct, 0, sizeof(fnm_function));
+            memcpy(&fnct, (const char *)info->functions + i * info->function_size,
+                   info->function_size < sizeof(fnm_function) ? info->function_size : sizeof(fnm_function));
+            if(fnct.name == 0)
+                break;
+
+            if(fnct.fnct == NULL || fnct.arity < 1 || fnct.arity > FNM_MAX_ARGS
+                    || fnct.signature > FNM_SIGNATURE_ARRAY){
+                _command_error("INCLUDE ERROR: Unsupported function %s", fnct.name);
+                continue;
+            }
+            // Insert the function into the symbol table
+            st_insert(st, (char *)fnct.name, FNCT);
+            st_addFunction(st, (char *)fnct.name, &fnct);
+            printf("\t%s\n", fnct.name);
+        }
+    }
+
+    if(info->constants != NULL){
+        output_message(OUTPUT_BLUE, "Including constants...");
+        // Insert the constants into the symbol table
+        for(i = 0; info->constants[i].name != 0; i++){
+            st_insert(st, (char *)info->constants[i].name, CONST);
+            st_addValue(st, (char *)info->constants[i].name, info->constants[i].value);
+            printf("\t%s\n", info->constants[i].name);
+        }
+    }
+
+    return 0;
+}
+
+void _include_symbols(void *library, symbol_table *st){
     int i;
 
     // Load the array with the function names
@@ -121,11 +416,14 @@ void include(void* param1, void* param2){
     double (**fnc_ptr)(double) = dlsym(library, "function_ptr");
 
     if(fnc_names != NULL){
-        printf(ANSI_COLOR_BLUE "Including functions...\n" ANSI_COLOR_RESET);
+        output_message(OUTPUT_BLUE, "Including functions...");
         // Insert the functions into the symbol table 
         for(i = 0; fnc_names[i] != 0; i++){
+            // Nothing is known about the functions, so they are never memoized
+            // or called from several threads
+            fnm_function fnct = {fnc_names[i], 1, FNM_SIGNATURE_NATIVE, fnc_ptr[i], NULL, 0, FNM_COST_UNKNOWN};
             st_insert(st, fnc_names[i], FNCT);
-            st_addFunction(st, fnc_names[i], fnc_ptr[i]);
+            st_addFunction(st, fnc_names[i], &fnct);
             printf("\t%s\n", fnc_names[i]);
         }
     }
@@ -136,7 +434,7 @@ void include(void* param1, void* param2){
     double *const_values = (double *)dlsym(library, "const_values");
 
     if(const_names != NULL){
-        printf(ANSI_COLOR_BLUE "Including constants...\n" ANSI_COLOR_RESET);
+        output_message(OUTPUT_BLUE, "Including constants...");
         // Insert the constants into the symbol table
         for(i = 0; const_names[i] != 0; i++){
             st_insert(st, const_names[i], CONST);
@@ -144,20 +442,56 @@ void include(void* param1, void* param2){
             printf("\t%s\n", const_names[i]);
         }
     }
-
-    printf(ANSI_COLOR_BLUE "** Library included succesfully! **\n" ANSI_COLOR_RESET);
 }
 
-void print(void* param){
-    char *string = (char *)param;
+void _remove_functions(void *old, symbol_table *st){
+    int i;
+    const char *name;
+    double (*fnct)();
 
-    printf(ANSI_COLOR_CYAN "%s\n" ANSI_COLOR_RESET, string);
-}
+    const fnm_plugin *info = (const fnm_plugin *)dlsym(old, "fnm_plugin_info");
+    char **fnc_names = (char **)dlsym(old, "function_names");
+    double (**fnc_ptr)(double) = dlsym(old, "function_ptr");
 
-void quit(void* param){
-    symbol_table *st = (symbol_table *)param;
+    for(i = 0; ; i++){
+        // The name and the pointer are the first fields on any version
+        if(info != NULL && info->functions != NULL){
+            const fnm_function *f = (const fnm_function *)((const char *)info->functions + i * info->function_size);
+            name = f->name;
+            fnct = f->fnct;
+        }
+        else if(info == NULL && fnc_names != NULL && fnc_ptr != NULL){
+            name = fnc_names[i];
+            fnct = (double (*)())fnc_ptr[i];
+        }
+        else
+            break;
+        if(name == 0)
+            break;
 
-    st_free(st); //Frees memory reserved by the symbol table
+        // The functions that still point to the old version were not
+        // replaced by the new one
+        info_row *row = st_get_info_row(st, (char *)name);
+        if(row != NULL && row->lc == FNCT && row->value.fnct_d == fnct){
+            st_delete(st, (char *)name);
+            output_message(OUTPUT_BLUE, "Removing function %s", name);
+        }
+    }
+}
+
+void _command_error(const char *format, ...){
+    va_list args;
+    unsigned long line;
 
-    exit(EXIT_SUCCESS);
-}
\ No newline at end of file
+    // The line is marked as failed, like the errors of the analyzers
+    flag_error = 1;
+    output_color(OUTPUT_RED);
+    const char *file = input_location(&line);
+    if(file != NULL)
+        printf("%s:%lu: ", file, line);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    output_color(OUTPUT_RESET);
+    putchar('\n');
+}
@@ -77,6 +77,25 @@ void load(void* param);
  */
 void include(void* param1, void* param2); 
 
+/**
+ * Loads again a library already included, after its file has changed.
+ * The functions on the symbol table are replaced by the new ones, and
+ * the variables are not modified
+ *
+ * @param param1: String indicating the path of the library
+ * @param param2: Symbol table
+ */
+void reload(void* param1, void* param2);
+
+/**
+ * Sets when the functions of the libraries included from now on are
+ * bound: "now" (when the library is included) or "lazy" (on their first
+ * call)
+ *
+ * @param param: String with the mode (the datatype must be char *)
+ */
+void binding(void* param);
+
 
 /**
  * Prints a message to the output
@@ -85,6 +104,65 @@ void include(void* param1, void* param2);
  */
 void print(void* param); 
 
+/**
+ * Sets if the independent lines of the loaded files run at the same time
+ * on the thread pool: "on" or "off" (default)
+ *
+ * @param param: String with the mode (the datatype must be char *)
+ */
+void change_parallel(void* param);
+
+/**
+ * Sets if the next loaded files are read and scanned on other threads
+ * while their lines run: "on" (default) or "off"
+ *
+ * @param param: String with the mode (the datatype must be char *)
+ */
+void change_pipeline(void* param);
+
+/**
+ * Sets the number of threads used by parallel operations
+ * 
+ * @param param: Pointer to the number of threads (the datatype must be
+ * 'double*'). 0 selects one thread per available processor
+ */
+void threads(void* param);
+
+/**
+ * Displays the utilization counters of each thread of parallel operations
+ * 
+ * @param param: NULL or any ohter value can be passed.
+ * The function doesn't use the parameter
+ */
+void workers(void* param);
+
+/**
+ * Sets the seed of the random numbers of the included libraries, and of
+ * the ones included later
+ *
+ * @param param: Pointer to the seed (the datatype must be 'double*'), an
+ * integer between 0 and 2^64 - 1
+ */
+void seed(void* param);
+
+/**
+ * Sets how the results are printed: the shortest form that is read back
+ * as the same number, or a fixed number of significant digits
+ * 
+ * @param param: Pointer to the number of digits (the datatype must be
+ * 'double*'). 0 selects the shortest form (default)
+ */
+void format(void* param);
+
+/**
+ * Writes the output that remains on the buffer. Out of a terminal the
+ * output is only written when the buffer is almost full, or on exit
+ * 
+ * @param param: NULL or any ohter value can be passed.
+ * The function doesn't use the parameter
+ */
+void flush(void* param);
+
 /**
  * Finalizes program execution
  * Frees memory of used data structures
@@ -0,0 +1,422 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: decompress.c
+ * Implementation of the reading of compressed
+ * files defined on the header file
+ * decompress.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * The decompressed contents go through a ring of blocks: the thread of the
+ * file fills the free blocks and the reads of the stream (from the lexical
+ * analyzer) empty them, so the file is decompressed while the previous
+ * blocks are analyzed. The thread takes a worker of the thread pool
+ * (pool_spawn()); if there is none free, the reads decompress each block
+ * when they need it. The gzip files are decompressed with zlib, and the
+ * zstd ones with libzstd, which is opened the first time it's needed.
+ */
+
+#define _GNU_SOURCE     // fopencookie()
+#include "decompress.h"
+#include "pool.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+
+/* Blocks of decompressed contents between the thread and the reads */
+#define DECOMPRESS_BLOCKS 4
+#define DECOMPRESS_BLOCK_SIZE ((size_t)256 << 10)
+
+/* Bytes of the file read at a time */
+#define DECOMPRESS_INPUT_SIZE ((size_t)128 << 10)
+
+/** Buffers of the streaming interface of libzstd (see zstd.h) **/
+typedef struct {
+    const void *src;
+    size_t size;
+    size_t pos;
+} _zstd_in;
+
+typedef struct {
+    void *dst;
+    size_t size;
+    size_t pos;
+} _zstd_out;
+
+/** Functions of libzstd, found when it's opened **/
+static struct {
+    void *handle;               // NULL if it couldn't be opened
+    void* (*create)(void);
+    size_t (*init)(void *stream);
+    size_t (*decompress)(void *stream, _zstd_out *output, _zstd_in *input);
+    unsigned (*is_error)(size_t code);
+    size_t (*free)(void *stream);
+} zstd = {NULL};
+static pthread_once_t zstd_once = PTHREAD_ONCE_INIT;
+
+/** Compressed file being read **/
+typedef struct {
+    int fd;
+    int format;
+    decompress_failed failed;
+
+    // Decompressor, only used by the thread (or by the reads without it)
+    z_stream gzip;
+    void *zstd;
+    unsigned char *input;       // Contents of the file not decompressed yet
+    size_t input_size;
+    size_t input_pos;
+    int pending;                // 1 in the middle of a gzip member or zstd frame
+    int finished;               // 1 after the end of the file or an error
+
+    // Ring of blocks: the filled ones are [head, tail)
+    pthread_t thread;
+    int threaded;               // 0 if the reads decompress the blocks
+    int created;                // 1 if the reads created the decompressor
+    pthread_mutex_t lock;       // Protects the fields below
+    pthread_cond_t filled;      // Signals a new block or the end of the file
+    pthread_cond_t emptied;     // Signals a free block or the end of the reads
+    char *blocks[DECOMPRESS_BLOCKS];
+    size_t lengths[DECOMPRESS_BLOCKS];
+    unsigned long head, tail;
+    size_t offset;              // Characters of the block head already read
+    int ended;                  // 1 when the thread has filled its last block
+    int closing;                // 1 when the stream is closed
+    const char *error;          // Why the file couldn't be read to the end
+} _stream;
+
+
+/** Declaration of private functions **/
+void _zstd_open();
+const char* _decompress_init(_stream *s);
+void _decompress_end(_stream *s);
+void _decompress_block(_stream *s);
+void* _decompress_thread(void *param);
+size_t _fill(_stream *s, char *block, size_t size);
+size_t _fill_gzip(_stream *s, char *block, size_t size);
+size_t _fill_zstd(_stream *s, char *block, size_t size);
+int _read_input(_stream *s);
+ssize_t _stream_read(void *cookie, char *buffer, size_t size);
+int _stream_close(void *cookie);
+void _stream_free(_stream *s);
+
+/** PUBLIC FUNCTIONS: Defined on decompress.h **/
+
+int decompress_format(int fd){
+    unsigned char magic[4];
+
+    if(pread(fd, magic, sizeof(magic), 0) < 2)
+        return DECOMPRESS_NONE;
+    if(magic[0] == 0x1F && magic[1] == 0x8B)
+        return DECOMPRESS_GZIP;
+    if(magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD)
+        return DECOMPRESS_ZSTD;
+    return DECOMPRESS_NONE;
+}
+
+FILE* decompress_open(int fd, int format, decompress_failed failed){
+    cookie_io_functions_t functions = {_stream_read, NULL, NULL, _stream_close};
+    int i;
+
+    _stream *s = calloc(1, sizeof(_stream));
+    if(s == NULL)
+        return NULL;
+    s->fd = fd;
+    s->format = format;
+    s->failed = failed;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->filled, NULL);
+    pthread_cond_init(&s->emptied, NULL);
+    s->input = malloc(DECOMPRESS_INPUT_SIZE);
+    int valid = (s->input != NULL);
+    for(i = 0; i < DECOMPRESS_BLOCKS; i++){
+        s->blocks[i] = malloc(DECOMPRESS_BLOCK_SIZE);
+        valid = valid && s->blocks[i] != NULL;
+    }
+
+    // The decompressor is created by the thread, which reports its errors
+    // on the first read. Without a free worker, it's created here
+    FILE *stream = NULL;
+    if(valid && (stream = fopencookie(s, "r", functions)) != NULL){
+        s->threaded = (pool_spawn(&s->thread, _decompress_thread, s) == 0);
+        if(!s->threaded){
+            s->error = _decompress_init(s);
+            s->created = (s->error == NULL);
+            s->finished = s->ended = !s->created;
+        }
+    }
+    if(stream == NULL){
+        _stream_free(s);
+        return NULL;
+    }
+
+    return stream;
+}
+
+/** Implementation of private functions **/
+
+// Opens libzstd and finds its functions, only once
+void _zstd_open(){
+    void *handle = dlopen(DECOMPRESS_ZSTD_LIBRARY, RTLD_NOW | RTLD_LOCAL);
+    if(handle == NULL)
+        return;
+
+    *(void **)&zstd.create = dlsym(handle, "ZSTD_createDStream");
+    *(void **)&zstd.init = dlsym(handle, "ZSTD_initDStream");
+    *(void **)&zstd.decompress = dlsym(handle, "ZSTD_decompressStream");
+    *(void **)&zstd.is_error = dlsym(handle, "ZSTD_isError");
+    *(void **)&zstd.free = dlsym(handle, "ZSTD_freeDStream");
+    if(zstd.create == NULL || zstd.init == NULL || zstd.decompress == NULL
+       || zstd.is_error == NULL || zstd.free == NULL){
+        dlclose(handle);
+        return;
+    }
+    zstd.handle = handle;
+}
+
+// Creates the decompressor of the file. It returns NULL, or the error if
+// it couldn't be created (then the decompressor must not be ended)
+const char* _decompress_init(_stream *s){
+    if(s->format == DECOMPRESS_GZIP){
+        // 16 + 15: gzip header and the largest window
+        if(inflateInit2(&s->gzip, 16 + MAX_WBITS) != Z_OK)
+            return "Could not decompress the file";
+        return NULL;
+    }
+
+    pthread_once(&zstd_once, _zstd_open);
+    if(zstd.handle == NULL)
+        return "Could not open " DECOMPRESS_ZSTD_LIBRARY " to decompress the file";
+    if((s->zstd = zstd.create()) == NULL || zstd.is_error(zstd.init(s->zstd)))
+        return "Could not decompress the file";
+    return NULL;
+}
+
+// Frees the decompressor of the file
+void _decompress_end(_stream *s){
+    if(s->format == DECOMPRESS_GZIP)
+        inflateEnd(&s->gzip);
+    else if(s->zstd != NULL)
+        zstd.free(s->zstd);
+}
+
+// Decompresses the next free block, with the lock held (it's released
+// while the block is filled)
+void _decompress_block(_stream *s){
+    char *block = s->blocks[s->tail % DECOMPRESS_BLOCKS];
+    pthread_mutex_unlock(&s->lock);
+
+    size_t length = _fill(s, block, DECOMPRESS_BLOCK_SIZE);
+
+    pthread_mutex_lock(&s->lock);
+    if(length > 0){
+        s->lengths[s->tail % DECOMPRESS_BLOCKS] = length;
+        s->tail++;
+    }
+    pthread_cond_signal(&s->filled);
+}
+
+void* _decompress_thread(void *param){
+    _stream *s = (_stream *)param;
+
+    const char *error = _decompress_init(s);
+    s->finished = (error != NULL);
+
+    pthread_mutex_lock(&s->lock);
+    s->error = error;
+    while(!s->finished && !s->closing){
+        // Waits for a free block
+        if(s->tail - s->head == DECOMPRESS_BLOCKS){
+            pthread_cond_wait(&s->emptied, &s->lock);
+            continue;
+        }
+        _decompress_block(s);
+    }
+    s->ended = 1;
+    pthread_cond_signal(&s->filled);
+    pthread_mutex_unlock(&s->lock);
+
+    if(error == NULL)
+        _decompress_end(s);
+    return NULL;
+}
+
+// Fills a block with the next decompressed characters. It returns fewer
+// than size only at the end of the file or after an error
+size_t _fill(_stream *s, char *block, size_t size){
+    return (s->format == DECOMPRESS_GZIP) ? _fill_gzip(s, block, size) : _fill_zstd(s, block, size);
+}
+
+size_t _fill_gzip(_stream *s, char *block, size_t size){
+    s->gzip.next_out = (Bytef *)block;
+    s->gzip.avail_out = (uInt)size;
+
+    while(s->gzip.avail_out > 0 && !s->finished){
+        if(s->input_pos == s->input_size && _read_input(s) <= 0)
+            break;
+
+        // Several members are decompressed one after another. The zeros
+        // and other characters after the last one are ignored, like gzip
+        if(!s->pending){
+            if(s->input[s->input_pos] != 0x1F){
+                s->finished = 1;
+                break;
+            }
+            inflateReset(&s->gzip);
+        }
+
+        s->gzip.next_in = s->input + s->input_pos;
+        s->gzip.avail_in = (uInt)(s->input_size - s->input_pos);
+        int status = inflate(&s->gzip, Z_NO_FLUSH);
+        s->input_pos = s->input_size - s->gzip.avail_in;
+        if(status == Z_STREAM_END)
+            s->pending = 0;
+        else if(status == Z_OK || status == Z_BUF_ERROR)
+            s->pending = 1;
+        else{
+            pthread_mutex_lock(&s->lock);
+            s->error = "The compressed file is corrupted";
+            pthread_mutex_unlock(&s->lock);
+            s->finished = 1;
+        }
+    }
+
+    return size - s->gzip.avail_out;
+}
+
+size_t _fill_zstd(_stream *s, char *block, size_t size){
+    _zstd_out output = {block, size, 0};
+
+    while(output.pos < size && !s->finished){
+        if(s->input_pos == s->input_size && _read_input(s) <= 0)
+            break;
+
+        _zstd_in input = {s->input, s->input_size, s->input_pos};
+        size_t status = zstd.decompress(s->zstd, &output, &input);
+        s->input_pos = input.pos;
+        if(zstd.is_error(status)){
+            pthread_mutex_lock(&s->lock);
+            s->error = "The compressed file is corrupted";
+            pthread_mutex_unlock(&s->lock);
+            s->finished = 1;
+        }
+        else
+            s->pending = (status != 0);     // 0 at the end of a frame
+    }
+
+    return output.pos;
+}
+
+// Reads the next part of the file. It returns the bytes read, or 0 at the
+// end of the file and -1 if there was an error (then the file is finished)
+int _read_input(_stream *s){
+    ssize_t n;
+
+    do{
+        n = read(s->fd, s->input, DECOMPRESS_INPUT_SIZE);
+    } while(n == -1 && errno == EINTR);
+
+    s->input_pos = 0;
+    s->input_size = (n > 0) ? (size_t)n : 0;
+    if(n <= 0){
+        s->finished = 1;
+        if(n == -1 || s->pending){
+            pthread_mutex_lock(&s->lock);
+            s->error = (n == -1) ? "Could not read the file" : "The compressed file is cut";
+            pthread_mutex_unlock(&s->lock);
+            n = -1;
+        }
+    }
+    return (int)n;
+}
+
+// Reads of the stream: they take the characters of the filled blocks
+ssize_t _stream_read(void *cookie, char *buffer, size_t size){
+    _stream *s = (_stream *)cookie;
+
+    pthread_mutex_lock(&s->lock);
+    while(s->head == s->tail && !s->ended){
+        if(s->threaded)
+            pthread_cond_wait(&s->filled, &s->lock);
+        else{
+            // Without a thread, the read fills the block it needs
+            _decompress_block(s);
+            s->ended = s->finished;
+        }
+    }
+    if(s->head == s->tail){
+        // The end of the file: its error is reported only once
+        const char *error = s->error;
+        s->error = NULL;
+        pthread_mutex_unlock(&s->lock);
+        if(error != NULL && s->failed != NULL)
+            s->failed(error);
+        return 0;
+    }
+    unsigned slot = (unsigned)(s->head % DECOMPRESS_BLOCKS);
+    size_t offset = s->offset;
+    pthread_mutex_unlock(&s->lock);
+
+    // The thread doesn't write on the filled blocks
+    size_t length = s->lengths[slot] - offset;
+    if(length > size)
+        length = size;
+    memcpy(buffer, s->blocks[slot] + offset, length);
+
+    pthread_mutex_lock(&s->lock);
+    s->offset += length;
+    if(s->offset == s->lengths[slot]){
+        s->offset = 0;
+        s->head++;
+        pthread_cond_signal(&s->emptied);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    return (ssize_t)length;
+}
+
+// Closing of the stream: the thread is stopped, even before the end
+int _stream_close(void *cookie){
+    _stream *s = (_stream *)cookie;
+
+    if(s->threaded){
+        pthread_mutex_lock(&s->lock);
+        s->closing = 1;
+        pthread_cond_signal(&s->emptied);
+        pthread_mutex_unlock(&s->lock);
+        pool_join(s->thread);
+    }
+    else if(s->created)
+        _decompress_end(s);
+
+    int status = close(s->fd);
+    _stream_free(s);
+    return status;
+}
+
+void _stream_free(_stream *s){
+    int i;
+
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->filled);
+    pthread_cond_destroy(&s->emptied);
+    for(i = 0; i < DECOMPRESS_BLOCKS; i++)
+        free(s->blocks[i]);
+    free(s->input);
+    free(s);
+}
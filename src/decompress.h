@@ -0,0 +1,63 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: decompress.h
+ * Definitions of the reading of compressed
+ * files (gzip and zstd), decompressed on a
+ * background thread while they are read
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <stdio.h>
+
+/** Formats of the files **/
+#define DECOMPRESS_NONE     0   // Not compressed
+#define DECOMPRESS_GZIP     1
+#define DECOMPRESS_ZSTD     2
+
+/* Library opened to decompress the zstd files, when they are found */
+#define DECOMPRESS_ZSTD_LIBRARY "libzstd.so.1"
+
+/**
+ * Function called when a compressed file can't be read to the end
+ *
+ * @param reason: Description of the error
+ */
+typedef void (*decompress_failed)(const char *reason);
+
+/**
+ * Recognizes a compressed file by its first bytes, without moving its
+ * position
+ *
+ * @param fd: Descriptor of a regular file
+ * @return The format of the file (DECOMPRESS_*)
+ */
+int decompress_format(int fd);
+
+/**
+ * Opens a stream with the decompressed contents of a file. A worker of the
+ * thread pool decompresses the file a few blocks ahead of the reads, so
+ * both overlap; if no worker is free, each read decompresses the block it
+ * needs on its own thread. If the file is cut or corrupted, the stream ends at that point and
+ * failed is called from the read that finds it
+ *
+ * @param fd: Descriptor of the file, at its beginning. It's closed with
+ * the stream
+ * @param format: Format of the file (DECOMPRESS_GZIP or DECOMPRESS_ZSTD)
+ * @param failed: Function called if the file can't be read to the end
+ * @return The stream, that must be closed with fclose(), or NULL if there
+ * was an error (the descriptor isn't closed then)
+ */
+FILE* decompress_open(int fd, int format, decompress_failed failed);
+
+#endif /* DECOMPRESS_H */
@@ -0,0 +1,303 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: format.c
+ * Implementation of the conversion of numbers
+ * to text defined on the header file format.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * The shortest text is computed with Ryu (U. Adams, "Ryū: fast float-to-
+ * string conversion", PLDI 2018). The limits of the interval of numbers
+ * that are read back as x are multiplied by a power of 10 from the tables
+ * of format_tables.h, and the digits are removed while both limits still
+ * differ. Only integer operations are used, so the result is exact.
+ */
+
+#include "format.h"
+#include "format_tables.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/** Binary format of a double **/
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_EXPONENT_BITS 11
+#define DOUBLE_BIAS 1023
+
+/* Greatest decimal exponent written without scientific notation */
+#define SHORTEST_MAX_EXPONENT (FORMAT_MAX_DIGITS - 1)
+
+/* Significant digits of the results */
+static unsigned digits = FORMAT_SHORTEST;
+
+
+/** Declaration of private functions **/
+uint32_t _pow5_bits(int32_t e);
+uint32_t _log10_pow2(int32_t e);
+uint32_t _log10_pow5(int32_t e);
+int _multiple_of_pow5(uint64_t value, uint32_t p);
+int _multiple_of_pow2(uint64_t value, uint32_t p);
+uint64_t _mul_shift(uint64_t m, const uint64_t *mul, int32_t j);
+void _ryu(uint64_t mantissa, uint32_t exponent, uint64_t *output, int32_t *e10);
+int _write_decimal(uint64_t output, int32_t e10, int negative, char *buffer);
+
+/** PUBLIC FUNCTIONS: Defined on format.h **/
+
+void format_set_digits(unsigned n){
+    digits = (n > FORMAT_MAX_DIGITS) ? FORMAT_MAX_DIGITS : n;
+}
+
+unsigned format_get_digits(){
+    return digits;
+}
+
+int format_number(double x, char *buffer){
+    if(digits == FORMAT_SHORTEST)
+        return format_shortest(x, buffer);
+    return snprintf(buffer, FORMAT_SIZE, "%.*g", digits, x);
+}
+
+int format_shortest(double x, char *buffer){
+    uint64_t bits, output;
+    int32_t e10;
+
+    memcpy(&bits, &x, sizeof(double));
+    int negative = (int)(bits >> (DOUBLE_MANTISSA_BITS + DOUBLE_EXPONENT_BITS));
+    uint64_t mantissa = bits & ((1ULL << DOUBLE_MANTISSA_BITS) - 1);
+    uint32_t exponent = (uint32_t)((bits >> DOUBLE_MANTISSA_BITS) & ((1u << DOUBLE_EXPONENT_BITS) - 1));
+
+    // Special values, written like printf()
+    if(exponent == (1u << DOUBLE_EXPONENT_BITS) - 1){
+        if(mantissa != 0)
+            strcpy(buffer, negative ? "-nan" : "nan");
+        else
+            strcpy(buffer, negative ? "-inf" : "inf");
+        return (int)strlen(buffer);
+    }
+    if(exponent == 0 && mantissa == 0){
+        strcpy(buffer, negative ? "-0" : "0");
+        return negative + 1;
+    }
+
+    _ryu(mantissa, exponent, &output, &e10);
+    return _write_decimal(output, e10, negative, buffer);
+}
+
+
+/** Implementation of private functions **/
+
+uint32_t _pow5_bits(int32_t e){
+    // Bits of 5^e, for 0 <= e <= 3528
+    return (uint32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+uint32_t _log10_pow2(int32_t e){
+    // floor(log10(2^e)), for 0 <= e <= 1650
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+uint32_t _log10_pow5(int32_t e){
+    // floor(log10(5^e)), for 0 <= e <= 2620
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+int _multiple_of_pow5(uint64_t value, uint32_t p){
+    uint32_t count = 0;
+
+    while(value % 5 == 0 && count < p){
+        value /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+int _multiple_of_pow2(uint64_t value, uint32_t p){
+    return (value & ((1ULL << p) - 1)) == 0;
+}
+
+uint64_t _mul_shift(uint64_t m, const uint64_t *mul, int32_t j){
+    // (m * mul) >> j, where mul has 128 bits and j >= 64
+    unsigned __int128 low = (unsigned __int128)m * mul[0];
+    unsigned __int128 high = (unsigned __int128)m * mul[1];
+    return (uint64_t)(((low >> 64) + high) >> (j - 64));
+}
+
+void _ryu(uint64_t mantissa, uint32_t exponent, uint64_t *output, int32_t *e10){
+    int32_t e2, q;
+    uint64_t m2, vr, vp, vm;
+    int vm_zeros = 0, vr_zeros = 0;
+    int removed = 0, last_digit = 0;
+
+    // x = m2 * 2^e2. Two more bits hold the limits of the interval
+    if(exponent == 0){
+        e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = mantissa;
+    }
+    else{
+        e2 = (int32_t)exponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+        m2 = (1ULL << DOUBLE_MANTISSA_BITS) | mantissa;
+    }
+    // The limits are read back as x if the mantissa is even (ties to even)
+    int accept_bounds = (m2 & 1) == 0;
+
+    // The interval is [mv - mm_shift - 1, mv + 2] / 4 * 2^e2. It's narrower
+    // below the powers of 2, where the exponent changes
+    uint64_t mv = 4 * m2;
+    uint32_t mm_shift = (mantissa != 0 || exponent <= 1);
+
+    // vr, vp and vm are x and the limits multiplied by 10^-e10
+    if(e2 >= 0){
+        q = (int32_t)_log10_pow2(e2) - (e2 > 3);
+        *e10 = q;
+        int32_t k = FORMAT_POW5_INV_BITS + (int32_t)_pow5_bits(q) - 1;
+        int32_t i = -e2 + q + k;
+        vr = _mul_shift(mv, format_pow5_inv[q], i);
+        vp = _mul_shift(mv + 2, format_pow5_inv[q], i);
+        vm = _mul_shift(mv - 1 - mm_shift, format_pow5_inv[q], i);
+        if(q <= 21){
+            // Only one of them can be a multiple of 5
+            if(mv % 5 == 0)
+                vr_zeros = _multiple_of_pow5(mv, q);
+            else if(accept_bounds)
+                vm_zeros = _multiple_of_pow5(mv - 1 - mm_shift, q);
+            else
+                vp -= _multiple_of_pow5(mv + 2, q);
+        }
+    }
+    else{
+        q = (int32_t)_log10_pow5(-e2) - (-e2 > 1);
+        *e10 = q + e2;
+        int32_t i = -e2 - q;
+        int32_t k = (int32_t)_pow5_bits(i) - FORMAT_POW5_BITS;
+        int32_t j = q - k;
+        vr = _mul_shift(mv, format_pow5[i], j);
+        vp = _mul_shift(mv + 2, format_pow5[i], j);
+        vm = _mul_shift(mv - 1 - mm_shift, format_pow5[i], j);
+        if(q <= 1){
+            // mv has at least q trailing zeros in binary
+            vr_zeros = 1;
+            if(accept_bounds)
+                vm_zeros = (mm_shift == 1);
+            else
+                vp--;
+        }
+        else if(q < 63)
+            vr_zeros = _multiple_of_pow2(mv, q);
+    }
+
+    // Removes digits while the limits differ
+    if(vm_zeros || vr_zeros){
+        // Exact case: the removed digits decide the rounding
+        while(vp / 10 > vm / 10){
+            vm_zeros &= (vm % 10 == 0);
+            vr_zeros &= (last_digit == 0);
+            last_digit = (int)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if(vm_zeros){
+            while(vm % 10 == 0){
+                vr_zeros &= (last_digit == 0);
+                last_digit = (int)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if(vr_zeros && last_digit == 5 && vr % 2 == 0)
+            last_digit = 4;     // Exactly in the middle: rounds to even
+        *output = vr + ((vr == vm && (!accept_bounds || !vm_zeros)) || last_digit >= 5);
+    }
+    else{
+        // Common case, first two digits at a time
+        int round_up = 0;
+        if(vp / 100 > vm / 100){
+            round_up = (vr % 100 >= 50);
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while(vp / 10 > vm / 10){
+            round_up = (vr % 10 >= 5);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        *output = vr + (vr == vm || round_up);
+    }
+
+    *e10 += removed;
+}
+
+int _write_decimal(uint64_t output, int32_t e10, int negative, char *buffer){
+    char digits_text[FORMAT_MAX_DIGITS + 1];
+    int length = 0, i, pos = 0;
+
+    // The digits are written from the last one
+    do{
+        digits_text[FORMAT_MAX_DIGITS - length++] = (char)('0' + output % 10);
+        output /= 10;
+    } while(output > 0);
+    const char *d = &digits_text[FORMAT_MAX_DIGITS + 1 - length];
+
+    // Exponent of the first digit
+    int32_t exponent = e10 + length - 1;
+
+    if(negative)
+        buffer[pos++] = '-';
+
+    if(exponent < -4 || exponent > SHORTEST_MAX_EXPONENT){
+        // Scientific notation: d.ddde+XX
+        buffer[pos++] = d[0];
+        if(length > 1){
+            buffer[pos++] = '.';
+            memcpy(&buffer[pos], &d[1], length - 1);
+            pos += length - 1;
+        }
+        pos += sprintf(&buffer[pos], "e%c%02d", exponent < 0 ? '-' : '+',
+                       exponent < 0 ? -exponent : exponent);
+        return pos;
+    }
+
+    if(exponent < 0){
+        // 0.000ddd
+        buffer[pos++] = '0';
+        buffer[pos++] = '.';
+        for(i = -1; i > exponent; i--)
+            buffer[pos++] = '0';
+        memcpy(&buffer[pos], d, length);
+        pos += length;
+    }
+    else if(exponent + 1 >= length){
+        // ddd000
+        memcpy(&buffer[pos], d, length);
+        pos += length;
+        for(i = length; i <= exponent; i++)
+            buffer[pos++] = '0';
+    }
+    else{
+        // ddd.ddd
+        memcpy(&buffer[pos], d, exponent + 1);
+        pos += exponent + 1;
+        buffer[pos++] = '.';
+        memcpy(&buffer[pos], &d[exponent + 1], length - exponent - 1);
+        pos += length - exponent - 1;
+    }
+
+    buffer[pos] = '\0';
+    return pos;
+}
@@ -0,0 +1,68 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: format.h
+ * Definitions of the functions that convert
+ * the numbers to text: the shortest text that
+ * is read back as the same number, or a fixed
+ * number of significant digits
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+/* Size of the buffers of the numbers (with the final '\0') */
+#define FORMAT_SIZE 32
+
+/* Significant digits that select the shortest text */
+#define FORMAT_SHORTEST 0
+
+/* Maximum number of significant digits (all the digits of a double) */
+#define FORMAT_MAX_DIGITS 17
+
+/**
+ * Sets how the results are printed
+ *
+ * @param digits: FORMAT_SHORTEST (default) or the number of significant
+ * digits, from 1 to FORMAT_MAX_DIGITS
+ */
+void format_set_digits(unsigned digits);
+
+/**
+ * Returns how the results are printed
+ *
+ * @return FORMAT_SHORTEST or the number of significant digits
+ */
+unsigned format_get_digits();
+
+/**
+ * Writes a number with the format selected by format_set_digits(). The
+ * notation is the one of printf("%g"): scientific if the exponent is less
+ * than -4 or greater than the digits, and without trailing zeros
+ *
+ * @param x: Number
+ * @param buffer: Place to write the text, of FORMAT_SIZE characters
+ * @return The length of the text
+ */
+int format_number(double x, char *buffer);
+
+/**
+ * Writes the shortest text that is read back as the same number (and the
+ * nearest to it among the shortest ones), with the algorithm Ryu. The
+ * notation is the one of printf("%.17g")
+ *
+ * @param x: Number
+ * @param buffer: Place to write the text, of FORMAT_SIZE characters
+ * @return The length of the text
+ */
+int format_shortest(double x, char *buffer);
+
+#endif /* FORMAT_H */
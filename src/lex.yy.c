@@ -387,12 +387,12 @@ static yyconst YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    2,    1,    4,    1,    1,    5,    1,    1,    6,
-        7,    8,    9,    1,   10,   11,   12,   13,   14,   15,
-       15,   15,   15,   15,   15,   15,   15,    1,    1,    1,
+        7,    8,    9,    6,   10,   11,   12,   13,   14,   15,
+       15,   15,   15,   15,   15,   15,   15,    6,    1,    1,
        16,    1,    1,    1,   17,   18,   17,   17,   19,   17,
        20,   20,   20,   20,   20,   20,   20,   20,   20,   20,
        20,   20,   20,   20,   20,   20,   20,   21,   20,   20,
-        1,   22,    1,   23,   20,    1,   17,   18,   17,   17,
+        6,   22,    6,   23,   20,    1,   17,   18,   17,   17,
 
        19,   17,   20,   20,   20,   20,   20,   20,   20,   20,
        20,   20,   20,   20,   20,   20,   20,   20,   20,   21,
@@ -511,10 +511,26 @@ char *yytext;
 #include "lex.yy.h"
 #include "sintactic.tab.h"
 #include "ST.h"
+#include "number.h"
+#include "script.h"
+#include "decompress.h"
+#include "pipeline.h"
+#include "pool.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 
+// The tokens are scanned by 'scan_token()', that receives the symbol table
+// as parameter. 'yylex()' also passes the compiled lines at once
+#define YY_DECL int scan_token(st) symbol_table* st;
+int scan_token(symbol_table *st);
 
-// Redefine 'yylex()' to receive symbol table as parameter
-#define YY_DECL int yylex(st) symbol_table* st;
+// Token returned at the end of an input file: the next one is read from the
+// input below it, whose line may have been compiled
+#define INPUT_NEXT (-1)
 
 // Definition of function called by yylex to manage lexical errors
 void lexical_error(symbol_table *st, char *info, char *symbol);
@@ -524,11 +540,136 @@ int change_input_file(char *file);
 // Variable to control whether the current input depends on one or more files
 unsigned int input_file = 0;
 
-// Stack to control the input files
-#define MAX_INPUT_DEPTH 6
-YY_BUFFER_STATE input_file_stack[MAX_INPUT_DEPTH];
+// File mapped on memory, that is kept after reading it to read it again
+typedef struct input_map {
+    dev_t dev;              // Device and inode of the file
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;  // The map is discarded if the file changes
+    char *map;              // Mapped region: a page, the file and zeros
+    size_t map_size;
+    char *text;             // Beginning of the file (after a '\n')
+    unsigned users;         // Number of inputs reading it
+    struct input_map *next; // Next map, less recently used
+} input_map;
+
+// Input file, mapped on memory or read from a stream (decompressed while
+// it's read if the file is compressed)
+typedef struct {
+    YY_BUFFER_STATE buffer;
+    FILE *stream;       // NULL if the input isn't read from a stream
+    input_map *mapped;  // NULL if the input isn't mapped
+    dev_t dev;          // Device and inode of the file
+    ino_t ino;
+    const char *error;  // Why a compressed input ended before its end, or NULL
+} input_source;
+
+// Location of an input, shown on the error messages
+typedef struct {
+    char *path;             // NULL if the input isn't a file
+    unsigned long line;     // Line of the last token (0 before the first one)
+    int line_ended;         // 1 after a '\n', until the next token
+} input_position;
+
+// Greatest file mapped on memory: the size of the buffers of the analyzer
+// is an int, and it has 3 more characters (a '\n' before and 2 '\0' after)
+#define MAX_MAPPED_SIZE ((size_t)INT_MAX - 3)
+
+// Bytes of the maps kept on memory when no input reads them
+#define INPUT_CACHE_SIZE ((size_t)256 << 20)
+
+// Declaration of functions to open an input file and to close an input
+int open_input(char *file, int newline, input_source *source);
+void close_input(input_source *source);
+
+// Declaration of functions called when a compressed input can't be read to
+// the end, and at the end of the input to report it
+void input_failed(const char *reason);
+void report_input_error();
+
+// Declaration of functions to map a file and to free the maps not used
+input_map* map_input(int fd, struct stat *info);
+void trim_input_cache();
+
+// Declaration of function that returns the location of the current input
+input_position* current_position();
+
+// The lines are counted before each token: a line ends after its '\n'
+#define YY_USER_ACTION { \
+        input_position *position = current_position(); \
+        if(position->line_ended){ \
+            position->line++; \
+            position->line_ended = 0; \
+        } \
+    }
+
+// Level of the stack of input files
+typedef struct {
+    YY_BUFFER_STATE previous;   // Input to return at the end of the file
+    input_source source;
+    input_position position;
+    script_key key;             // Identification of the file (see script.h)
+    script *code;               // Compiled lines of the file, or NULL
+    size_t next_line;           // Next compiled line
+    script_writer *writer;      // Lines being compiled, or NULL
+    pipeline *pipeline;         // Threads that read and scan the file, or NULL
+} input_level;
+
+// Stack to control the input files, that doubles its size when it's full
+#define INPUT_STACK_INITIAL_SIZE 8
+static input_level *input_file_stack = NULL;
+static unsigned int input_stack_size = 0;
+
+// Maps kept on memory, from the most recently used
+static input_map *input_cache = NULL;
+static size_t input_cache_size = 0;     // Bytes of all the maps
+
+// Declaration of function to finish the input file on the top of the stack
+void end_input_file(symbol_table *st);
+
+// Declaration of function that passes a compiled line at once
+int compiled_line(symbol_table *st, input_level *level);
+
+// Declaration of function that returns the next token of a file read by a pipeline
+int next_pipeline_token(symbol_table *st, input_level *level);
+
+// Declaration of function that returns the position of the analyzer on a mapped file
+long input_offset(input_level *level);
+
+// Declaration of function that finds an identifier, or inserts it as a variable
+int identifier(symbol_table *st, char *name);
+
+// Declaration of function that follows the tokens of the lines to compile
+void record_token(int token);
+
+// Line being analyzed: it's compiled if all its tokens come from one file
+static int line_start = 1;              // 1 before the first token of a line
+static unsigned int line_level = 0;     // Input of its first token (see input_file)
+static long line_offset = -1;           // Its position on its file (-1 if unknown)
+static int line_error = 0;              // 1 after a lexical error before its first token
+
+// Compiled line passed to the sintactic analyzer, with its identifiers
+static script_run compiled_run = {NULL, NULL, NULL};
+static size_t compiled_rows_size = 0;
+
+// Declaration of function to change the input to the next one of the batch mode
+int next_batch_input();
+// Variable to control whether the input comes from the command line (batch mode)
+unsigned int batch_mode = 0;
+
+// Inputs of the batch mode
+static batch_input *batch_inputs = NULL;
+static int batch_size = 0;
+static int batch_next = 0;          // Next input to run
+static input_source batch_source = {NULL, NULL, NULL, 0, 0, NULL};  // Current input
+static input_position batch_position = {NULL, 0, 0};   // Also of the standard input
+static int batch_line_ended = 0;    // 1 if the last line of the current input was ended
+
+// The tokens of the large loaded files are scanned by '_scan()' of
+// pipeline.c, that must take the same tokens as the rules below: any
+// change of the rules must be made there too (see tests/test_pipeline.sh)
 #define YY_NO_INPUT 1
-#line 532 "lex.yy.c"
+#line 673 "lex.yy.c"
 
 #define INITIAL 0
 
@@ -746,10 +887,10 @@ YY_DECL
 		}
 
 	{
-#line 63 "lexical.l"
+#line 204 "lexical.l"
 
 
-#line 753 "lex.yy.c"
+#line 894 "lex.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -807,19 +948,32 @@ do_action:	/* This label is used only to access EOF actions. */
 			goto yy_find_action;
 
 case YY_STATE_EOF(INITIAL):
-#line 65 "lexical.l"
+#line 206 "lexical.l"
 { /* END OF FILE */
+                        // The input may have ended before its end
+                        report_input_error();
+
                         // If is the end of an input file
                         if(input_file){
-                            input_file--;
-
-                            fclose(yyin);
-                            yy_delete_buffer(YY_CURRENT_BUFFER);
-                            yy_switch_to_buffer(input_file_stack[input_file]);
+                            // The next line of the input below it may
+                            // have been compiled
+                            end_input_file(st);
+                            return INPUT_NEXT;
+                        }
+                        else if(batch_mode){
+                            // The last line of each input is ended even
+                            // without '\n', so it doesn't join the next one
+                            if(!batch_line_ended){
+                                batch_line_ended = 1;
+                                return '\n';
+                            }
+                            if(next_batch_input() == -1)
+                                yyterminate();
                         }
                         else{
                             // If is the end of the program execution
-                            printf("\n");
+                            if(output_is_terminal())
+                                printf("\n"); // Ends the line of the prompt
                             st_free(st); //Frees memory reserved by the symbol table
                             exit(EXIT_SUCCESS);
                         }
@@ -828,26 +982,19 @@ case YY_STATE_EOF(INITIAL):
 	YY_BREAK
 case 1:
 YY_RULE_SETUP
-#line 83 "lexical.l"
+#line 237 "lexical.l"
 { /* NOTHING */ }
 	YY_BREAK
 case 2:
 YY_RULE_SETUP
-#line 85 "lexical.l"
+#line 239 "lexical.l"
 { /* ALPHANUMERIC STRING */
-                        int lc = st_search(*st, yytext);
-                        if(lc == -1){
-                            st_insert(st, yytext, VAR);
-                            lc = VAR;
-                        }
-                        
-                        yylval.id = st_get_info_row(st, yytext);
-                        return lc;
+                        return identifier(st, yytext);
                     }
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 96 "lexical.l"
+#line 243 "lexical.l"
 { /* STRING LITERAL */
                         char *string = malloc((yyleng-1) * sizeof(char));
                         strncpy(string, (yytext+1), yyleng-2); // Obvious the quotes
@@ -859,73 +1006,75 @@ YY_RULE_SETUP
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 105 "lexical.l"
+#line 252 "lexical.l"
 { /* NUMBER LITERAL */
-                        yylval.val = atof(yytext);
+                        yylval.val = number_decimal(yytext, yyleng);
                         return NUM;
                     }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 110 "lexical.l"
+#line 257 "lexical.l"
 { /* NUMBER LITERAL: BINARY */
                         // Starts in the 3rd character (ignore prefix '0b')
-                        yylval.val = strtoul(&yytext[2], NULL, 2);
+                        yylval.val = number_binary(&yytext[2], yyleng - 2);
                         return NUM;
                     }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 116 "lexical.l"
+#line 263 "lexical.l"
 { /* NUMBER LITERAL: HEXADECIMAL */
-                        yylval.val = strtoul(yytext, NULL, 16);
+                        // Starts in the 3rd character (ignore prefix '0x')
+                        yylval.val = number_hexadecimal(&yytext[2], yyleng - 2);
                         return NUM;
                     }
 	YY_BREAK
 case 7:
 /* rule 7 can match eol */
 YY_RULE_SETUP
-#line 121 "lexical.l"
+#line 269 "lexical.l"
 { /* END OF LINE */
+                        current_position()->line_ended = 1;
                         return '\n';
                     }
 	YY_BREAK
 case 8:
-#line 126 "lexical.l"
+#line 274 "lexical.l"
 case 9:
-#line 127 "lexical.l"
+#line 275 "lexical.l"
 case 10:
-#line 128 "lexical.l"
+#line 276 "lexical.l"
 case 11:
-#line 129 "lexical.l"
+#line 277 "lexical.l"
 case 12:
-#line 130 "lexical.l"
+#line 278 "lexical.l"
 case 13:
-#line 131 "lexical.l"
+#line 279 "lexical.l"
 case 14:
-#line 132 "lexical.l"
+#line 280 "lexical.l"
 case 15:
-#line 133 "lexical.l"
+#line 281 "lexical.l"
 case 16:
 YY_RULE_SETUP
-#line 133 "lexical.l"
-{ /* MATHEMATICAL OPERATOR CHARACTER */
+#line 286 "lexical.l"
+{ /* MATHEMATICAL OPERATOR OR SEPARATOR CHARACTER */
                         return *yytext;
                     }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 137 "lexical.l"
+#line 290 "lexical.l"
 { /* ANY OTHER CHARACTER */
                         lexical_error(st, "Unexpected symbol", yytext);
                     }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 141 "lexical.l"
+#line 294 "lexical.l"
 ECHO;
 	YY_BREAK
-#line 929 "lex.yy.c"
+#line 1078 "lex.yy.c"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -1924,35 +2073,526 @@ void yyfree (void * ptr )
 
 #define YYTABLES_NAME "yytables"
 
-#line 141 "lexical.l"
+#line 294 "lexical.l"
 
 
 
 // Function to change the input to a file
 int change_input_file(char *file){
-    if(input_file == MAX_INPUT_DEPTH){
+    struct stat info;
+    unsigned int i;
+
+    // A file that is being read can't be loaded (it would load itself
+    // forever). Different paths to the same file have the same inode
+    if(stat(file, &info) == -1)
+        return -2;
+    for(i = 0; i < input_file; i++){
+        if(input_file_stack[i].source.dev == info.st_dev && input_file_stack[i].source.ino == info.st_ino)
+            return -1;
+    }
+    if(batch_position.path != NULL && batch_source.dev == info.st_dev && batch_source.ino == info.st_ino)
         return -1;
+
+    if(input_file == input_stack_size){
+        unsigned int size = input_stack_size ? 2 * input_stack_size : INPUT_STACK_INITIAL_SIZE;
+        input_level *stack = realloc(input_file_stack, size * sizeof(input_level));
+        if(stack == NULL)
+            return -2;
+        input_file_stack = stack;
+        input_stack_size = size;
     }
-    FILE *new_file_input = fopen(file, "r");
 
-    if(new_file_input == NULL)
+    // Adds the current input into the stack
+    input_level *level = &input_file_stack[input_file];
+    level->previous = YY_CURRENT_BUFFER;
+
+    // Changes to the new input, that begins with a '\n' to finalize 'load'
+    // action properly. Its first line begins after it
+    if(open_input(file, 1, &level->source) == -1)
         return -2;
+    level->position.path = strdup(file);
+    level->position.line = 0;
+    level->position.line_ended = 0;
+    input_file++;
+
+    // The lines of a mapped file are compiled, or run from its compiled
+    // file if it was loaded before. The positions of a compiled file have
+    // 32 bits, so the files from 4 GiB on aren't compiled
+    input_map *mapped = level->source.mapped;
+    level->key.path = NULL;
+    level->code = NULL;
+    level->next_line = 0;
+    level->writer = NULL;
+    if(mapped != NULL && (uint64_t)mapped->size <= UINT32_MAX
+       && script_key_init(&level->key, file, (uint64_t)mapped->size, &mapped->mtime, mapped->text) == 0){
+        if((level->code = script_open(&level->key)) == NULL)
+            level->writer = script_writer_new();
+    }
 
-    // Adds the current input into the stack
-    input_file_stack[input_file++] = YY_CURRENT_BUFFER;
-    yyin = new_file_input;
-    // Changes to the new input
-    yy_switch_to_buffer(yy_create_buffer(yyin,YY_BUF_SIZE));
+    // The large files are read and scanned by a pipeline while their lines
+    // run, unless they run from their compiled file
+    level->pipeline = NULL;
+    if(mapped != NULL && level->code == NULL && (size_t)mapped->size >= PIPELINE_MIN_SIZE
+       && pipeline_get_enabled() && pool_get_threads() > 1)
+        level->pipeline = pipeline_new(mapped->text - 1, (size_t)mapped->size + 1, -1);
+
+    return 0;
+}
+
+// Function that returns the location of the line being analyzed
+const char* input_location(unsigned long *line){
+    unsigned int i;
+
+    // Before its first line, a loaded file is still on the line of 'load'
+    for(i = input_file; i > 0; i--){
+        if(input_file_stack[i - 1].position.line > 0){
+            *line = input_file_stack[i - 1].position.line;
+            return input_file_stack[i - 1].position.path;
+        }
+    }
+    if(batch_position.path != NULL && batch_position.line > 0){
+        *line = batch_position.line;
+        return batch_position.path;
+    }
+    return NULL;
+}
+
+// Function that returns the location of the current input
+input_position* current_position(){
+    return input_file ? &input_file_stack[input_file - 1].position : &batch_position;
+}
+
+// Function to finish the input file on the top of the stack and return to
+// the input below it
+void end_input_file(symbol_table *st){
+    input_level *level = &input_file_stack[input_file - 1];
+
+    // The lines that wait to run are run before leaving the file
+    end_file_lines(st, level->position.line_ended);
+
+    // A line that isn't ended at the end of the file isn't compiled
+    if(line_level == input_file)
+        script_line_fail();
+
+    // The compiled file is saved once the whole file has been read
+    if(level->writer != NULL){
+        script_writer_save(level->writer, &level->key);
+        script_writer_free(level->writer);
+    }
+    if(level->code != NULL)
+        script_close(level->code);
+    script_key_free(&level->key);
+
+    // The threads of the pipeline read the map
+    if(level->pipeline != NULL)
+        pipeline_free(level->pipeline);
+
+    close_input(&level->source);
+    free(level->position.path);
+    yy_switch_to_buffer(level->previous);
+    input_file--;
+}
+
+// Main function of the lexical analyzer: returns the next token of the
+// current input, or the next line at once if it was compiled
+int yylex(symbol_table *st){
+    int token;
+
+    do{
+        input_level *level = input_file ? &input_file_stack[input_file - 1] : NULL;
+
+        // The lines are found by their position on the mapped files
+        if(line_start){
+            line_offset = -1;
+            if(level != NULL && level->source.mapped != NULL && input_offset(level) >= 0)
+                line_offset = input_offset(level);
+            if(line_offset >= 0 && level->code != NULL && compiled_line(st, level))
+                return COMPILED;
+        }
+
+        if(level != NULL && level->pipeline != NULL)
+            token = next_pipeline_token(st, level);
+        else
+            token = scan_token(st);
+        if(token > 0)
+            record_token(token);
+    } while(token == INPUT_NEXT);
+
+    return token;
+}
+
+// Function that passes the next line of a file at once, if it was compiled
+// and its identifiers still have the same lexical components (a library
+// may have been included since). Its text isn't scanned
+int compiled_line(symbol_table *st, input_level *level){
+    const script *code = level->code;
+    size_t i;
+
+    // The lines are sorted by their position
+    while(level->next_line < code->n_lines && code->lines[level->next_line].start < (size_t)line_offset)
+        level->next_line++;
+    if(level->next_line == code->n_lines || code->lines[level->next_line].start != (size_t)line_offset)
+        return 0;
+    const script_line *line = &code->lines[level->next_line];
+
+    if(line->n_symbols > compiled_rows_size){
+        info_row **rows = realloc(compiled_run.rows, line->n_symbols * sizeof(info_row *));
+        if(rows == NULL)
+            return 0;
+        compiled_run.rows = rows;
+        compiled_rows_size = line->n_symbols;
+    }
+
+    // The unknown identifiers would be inserted as variables
+    for(i = 0; i < line->n_symbols; i++){
+        const script_symbol *symbol = &code->symbols[line->first_symbol + i];
+        info_row *row = st_get_info_row(st, (char *)script_text(code, symbol->name));
+        if((row != NULL ? row->lc : VAR) != (int)symbol->lc)
+            return 0;
+        compiled_run.rows[i] = row;
+    }
+    for(i = 0; i < line->n_symbols; i++){
+        if(compiled_run.rows[i] == NULL){
+            char *name = (char *)script_text(code, code->symbols[line->first_symbol + i].name);
+            st_insert(st, name, VAR);
+            compiled_run.rows[i] = st_get_info_row(st, name);
+        }
+        compiled_run.rows[i]->used = lines_analyzed;
+    }
+
+    // The analyzer continues after its '\n', like after scanning it
+    *yy_c_buf_p = yy_hold_char;
+    yy_c_buf_p = level->source.mapped->text + line->end;
+    yy_hold_char = *yy_c_buf_p;
+    if(level->position.line_ended)
+        level->position.line++;
+    level->position.line_ended = 1;
+
+    level->next_line++;
+    compiled_run.code = code;
+    compiled_run.line = line;
+    yylval.compiled = &compiled_run;
+    return 1;
+}
 
-    unput('\n'); // Unputs a '\n' to finalize 'load' action properly
+// Function that returns the next token of a file read by a pipeline, with
+// the same actions as the rules of the lexical analyzer
+int next_pipeline_token(symbol_table *st, input_level *level){
+    while(1){
+        const pipeline_token *token = pipeline_next(level->pipeline);
+
+        if(token->token == PIPELINE_END){
+            report_input_error();
+            end_input_file(st);
+            return INPUT_NEXT;
+        }
+
+        // The same as YY_USER_ACTION
+        if(level->position.line_ended){
+            level->position.line++;
+            level->position.line_ended = 0;
+        }
+
+        switch(token->token){
+            case PIPELINE_SPACE:
+                break;
+            case PIPELINE_ERROR:
+                lexical_error(st, "Unexpected symbol", (char *)token->text);
+                break;
+            case PIPELINE_ID:
+                return identifier(st, (char *)token->text);
+            case STRING:
+                yylval.str = strdup(token->text);
+                return STRING;
+            case NUM:
+                yylval.val = token->val;
+                return NUM;
+            case '\n':
+                level->position.line_ended = 1;
+                return '\n';
+            default:
+                return token->token;
+        }
+    }
+}
+
+// Function that returns the position of the analyzer on a mapped file,
+// after the last token scanned (-1 before the '\n' added before the file)
+long input_offset(input_level *level){
+    if(level->pipeline != NULL)
+        return pipeline_offset(level->pipeline);
+    return yy_c_buf_p - level->source.mapped->text;
+}
+
+// Function that finds an identifier on the symbol table, or inserts it as
+// a variable if it's unknown, and returns its lexical component
+int identifier(symbol_table *st, char *name){
+    int lc = st_search(*st, name);
+    if(lc == -1){
+        st_insert(st, name, VAR);
+        lc = VAR;
+    }
+
+    yylval.id = st_get_info_row(st, name);
+    yylval.id->used = lines_analyzed;
+    return lc;
+}
+
+// Function that follows the tokens of the line being analyzed, and adds
+// its identifiers to its compiled file
+void record_token(int token){
+    input_level *level = input_file ? &input_file_stack[input_file - 1] : NULL;
+
+    if(line_start){
+        line_start = 0;
+        line_level = input_file;
+        script_line_begin((level != NULL && line_offset >= 0) ? level->writer : NULL, (size_t)line_offset);
+        if(line_error){
+            script_line_fail();
+            line_error = 0;
+        }
+    }
+    else if(line_level != input_file)
+        script_line_fail();    // The line continues on another input
+
+    if(token == '\n')
+        line_start = 1;
+    else if(token > NUM && token <= SWEEP && token != STRING)
+        script_line_symbol(token, yylval.id->key);
+}
+
+// Function called by the sintactic analyzer at the end of each line
+void input_line_end(){
+    input_level *level = input_file ? &input_file_stack[input_file - 1] : NULL;
+
+    // The line ends after its '\n', the last token scanned
+    if(level != NULL && line_level == input_file && level->source.mapped != NULL)
+        script_line_end(input_offset(level));
+    else
+        script_line_fail();
+}
+
+// Function to open an input file and change the input to it. The regular
+// files are mapped on memory and scanned in place, without copying them;
+// the compressed ones and the rest (pipes, devices...) are read as a stream
+int open_input(char *file, int newline, input_source *source){
+    struct stat info;
+
+    int fd = open(file, O_RDONLY);
+    if(fd == -1)
+        return -1;
+    if(fstat(fd, &info) == -1 || S_ISDIR(info.st_mode)){
+        close(fd);
+        return -1;
+    }
+
+    source->buffer = NULL;
+    source->stream = NULL;
+    source->mapped = NULL;
+    source->dev = info.st_dev;
+    source->ino = info.st_ino;
+    source->error = NULL;
+    int format = S_ISREG(info.st_mode) ? decompress_format(fd) : DECOMPRESS_NONE;
+    if(S_ISREG(info.st_mode) && format == DECOMPRESS_NONE && (size_t)info.st_size <= MAX_MAPPED_SIZE)
+        source->mapped = map_input(fd, &info);
+
+    if(source->mapped != NULL){
+        close(fd);  // The mapping remains
+        // yy_scan_buffer() also changes the input to the buffer
+        source->buffer = yy_scan_buffer(source->mapped->text - newline, (size_t)info.st_size + newline + 2);
+        return 0;
+    }
+
+    // The file can't be mapped: it's read through a buffer. The compressed
+    // files are decompressed on another thread while they are analyzed
+    if(format != DECOMPRESS_NONE)
+        source->stream = decompress_open(fd, format, input_failed);
+    else
+        source->stream = fdopen(fd, "r");
+    if(source->stream == NULL){
+        close(fd);
+        return -1;
+    }
+    source->buffer = yy_create_buffer(source->stream, YY_BUF_SIZE);
+    yy_switch_to_buffer(source->buffer);
+    if(newline)
+        unput('\n');
 
     return 0;
 }
 
+// Function called when a compressed input can't be read to the end. The
+// analyzer may still have lines of it to read: the error is reported when
+// it reaches the end of the input
+void input_failed(const char *reason){
+    input_source *source = input_file ? &input_file_stack[input_file - 1].source : &batch_source;
+    source->error = reason;
+}
+
+// Function to report that the current input ended before its end. It's an
+// error of its last line, which is incomplete
+void report_input_error(){
+    input_source *source = input_file ? &input_file_stack[input_file - 1].source : &batch_source;
+    if(source->error == NULL)
+        return;
+
+    char *message = malloc(strlen("LOAD ERROR: ") + strlen(source->error) + 1);
+    strcpy(message, "LOAD ERROR: ");
+    strcat(message, source->error);
+    yyerror(NULL, message);
+    free(message);
+    source->error = NULL;
+}
+
+// Function to close an input, opened by open_input() or from a string
+void close_input(input_source *source){
+    if(source->buffer != NULL)
+        yy_delete_buffer(source->buffer);
+    if(source->stream != NULL)
+        fclose(source->stream);
+    if(source->mapped != NULL){
+        source->mapped->users--;
+        trim_input_cache();
+    }
+
+    source->buffer = NULL;
+    source->stream = NULL;
+    source->mapped = NULL;
+    source->error = NULL;
+}
+
+// Function to map a regular file on memory. If it was already read and
+// hasn't changed, the previous map is used again
+input_map* map_input(int fd, struct stat *info){
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (size_t)info->st_size;
+    input_map **link = &input_cache, *entry;
+
+    while((entry = *link) != NULL){
+        if(entry->users == 0 && entry->dev == info->st_dev && entry->ino == info->st_ino){
+            *link = entry->next;
+            if(entry->size == info->st_size && entry->mtime.tv_sec == info->st_mtim.tv_sec
+               && entry->mtime.tv_nsec == info->st_mtim.tv_nsec){
+                // Moves to the beginning, as the most recently used
+                entry->next = input_cache;
+                input_cache = entry;
+                entry->users = 1;
+                return entry;
+            }
+            // The file has changed
+            input_cache_size -= entry->map_size;
+            munmap(entry->map, entry->map_size);
+            free(entry);
+            break;
+        }
+        link = &entry->next;
+    }
+
+    if((entry = malloc(sizeof(input_map))) == NULL)
+        return NULL;
+
+    // The file is mapped after a page that holds the '\n', over zeros
+    // that end the buffer (YY_END_OF_BUFFER_CHAR). The mapping is private
+    // because the analyzer writes on the buffer (and restores it)
+    entry->map_size = (page + size + 2 + page - 1) / page * page;
+    entry->map = mmap(NULL, entry->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(entry->map == MAP_FAILED){
+        free(entry);
+        return NULL;
+    }
+    entry->text = entry->map + page;
+    if(size > 0){
+        if(mmap(entry->text, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED){
+            munmap(entry->map, entry->map_size);
+            free(entry);
+            return NULL;
+        }
+        madvise(entry->text, size, MADV_SEQUENTIAL);
+    }
+    entry->text[-1] = '\n';
+
+    entry->dev = info->st_dev;
+    entry->ino = info->st_ino;
+    entry->size = info->st_size;
+    entry->mtime = info->st_mtim;
+    entry->users = 1;
+    entry->next = input_cache;
+    input_cache = entry;
+    input_cache_size += entry->map_size;
+
+    return entry;
+}
+
+// Function to free the least recently used maps that no input reads,
+// while the maps take more than INPUT_CACHE_SIZE bytes
+void trim_input_cache(){
+    while(input_cache_size > INPUT_CACHE_SIZE){
+        input_map **link, **last = NULL;
+        for(link = &input_cache; *link != NULL; link = &(*link)->next){
+            if((*link)->users == 0)
+                last = link;
+        }
+        if(last == NULL)
+            return;
+
+        input_map *entry = *last;
+        *last = entry->next;
+        input_cache_size -= entry->map_size;
+        munmap(entry->map, entry->map_size);
+        free(entry);
+    }
+}
+
+// Function to run a list of inputs in batch mode
+int set_batch_input(batch_input *inputs, int n){
+    batch_mode = 1;
+    batch_inputs = inputs;
+    batch_size = n;
+    batch_next = 0;
+
+    return next_batch_input();
+}
+
+// Function to change the input to the next one of the batch mode
+int next_batch_input(){
+    // The previous input is finished
+    close_input(&batch_source);
+    batch_position.path = NULL;
+    batch_line_ended = 0;
+
+    // The inputs that can't be opened are skipped. The new input is the
+    // current one after opening it
+    while(batch_source.buffer == NULL && batch_next < batch_size){
+        batch_input *input = &batch_inputs[batch_next++];
+        if(input->type == BATCH_EXPRESSION)
+            batch_source.buffer = yy_scan_string(input->text);
+        else if(open_input(input->text, 0, &batch_source) == 0){
+            // The first line begins with the first token
+            batch_position.path = input->text;
+            batch_position.line = 0;
+            batch_position.line_ended = 1;
+        }
+        else{
+            output_message(OUTPUT_RED, "BATCH ERROR: Could not open the file %s", input->text);
+            error_lines++;
+        }
+    }
+
+    if(batch_source.buffer == NULL)
+        return -1;
+    return 0;
+}
+
 // Function called by yylex to manage lexical errors
 void lexical_error(symbol_table *st, char *info, char *symbol){
+    // The line isn't compiled
+    if(line_start)
+        line_error = 1;
+    else
+        script_line_fail();
+
     flag_error = 1;
-    char *message = malloc(strlen("LEXICAL ERROR: ") + strlen(info) + 1);
+    char *message = malloc(strlen("LEXICAL ERROR: ") + strlen(info) + 1 + strlen(symbol) + 1);
     strcpy(message, "LEXICAL ERROR: ");
     strcat(message, info);
     strcat(message, " ");
@@ -14,10 +14,25 @@
  */
 /********************************************/
 
+#ifndef LEX_YY_H
+#define LEX_YY_H
+
 #include "ST.h"
 
 // Variable to control whether the current input depends on one or more files
 extern unsigned int input_file;
+// Variable to control whether the input comes from the command line (batch mode)
+extern unsigned int batch_mode;
+
+/** Types of inputs of the batch mode **/
+#define BATCH_FILE          0   // Path of a file with expressions
+#define BATCH_EXPRESSION    1   // Expressions given as a string
+
+/** Input of the batch mode **/
+typedef struct {
+    int type;       // BATCH_FILE or BATCH_EXPRESSION
+    char *text;     // Path of the file or expressions
+} batch_input;
 
 /**
  * Main function of the lexical analyzer.
@@ -37,7 +52,39 @@ int yylex(symbol_table *st);
  * of the lexical analyzer
  * 
  * @param file: String indicating the path of the file
- * @return 0 if everything went well, -1 if maximum nested files
- * exceed or -2 if the file could not be opened
+ * @return 0 if everything went well, -1 if the file is already being
+ * read (it loads itself, directly or through other files) or -2 if the
+ * file could not be opened
  */ 
 int change_input_file(char *file);
+
+/**
+ * Function to get the location of the line being analyzed,
+ * when it comes from a file
+ *
+ * @param line: Place to store the number of the line (from 1)
+ * @return The path of the file, or NULL if the line doesn't come
+ * from a file
+ */
+const char* input_location(unsigned long *line);
+
+/**
+ * Function called by the sintactic analyzer at the end of each line, once
+ * its actions have run. If the line comes from a loaded file and it had no
+ * errors, its actions are kept on the compiled file (see script.h)
+ */
+void input_line_end();
+
+/**
+ * Function to run a list of inputs in batch mode instead of the standard
+ * input. Each one is read after the previous one ends, and the analyzer
+ * returns the end of the input after the last one
+ *
+ * @param inputs: Array of inputs, that must exist until the end
+ * @param n: Number of inputs
+ * @return 0 if everything went well or -1 if none of the inputs could be
+ * opened
+ */
+int set_batch_input(batch_input *inputs, int n);
+
+#endif /* LEX_YY_H */
@@ -0,0 +1,405 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: library.c
+ * Implementation of the registry of libraries
+ * defined on the header file library.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#include "library.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* Size of the buffer used to copy the files of the libraries */
+#define COPY_BUFFER_SIZE 65536
+
+/* Descriptors of the libraries of lib/ compiled into the program (their
+ * symbol fnm_plugin_info is renamed by the Makefile) */
+extern const fnm_plugin fnm_builtin_trigonometric;
+extern const fnm_plugin fnm_builtin_exponential;
+extern const fnm_plugin fnm_builtin_round;
+
+/** Built-in libraries **/
+static struct {
+    const fnm_plugin *info;
+    int loaded;         // 1 once it has been found
+} builtins[] = {
+    {&fnm_builtin_trigonometric, 0},
+    {&fnm_builtin_exponential, 0},
+    {&fnm_builtin_round, 0}
+};
+
+/** Names of the built-in libraries **/
+typedef struct {
+    const char *name;
+    unsigned library;   // Position on 'builtins'
+} builtin_name;
+
+static const builtin_name builtin_aliases[] = {
+    {"trigonometric", 0},
+    {"trig", 0},
+    {"exponential", 1},
+    {"exp", 1},
+    {"round", 2},
+    {NULL, 0}           /* Ends with NULL */
+};
+
+/* Open addressing table of the names, built on the first search. It must
+ * have at least twice as many slots as names (a power of 2) */
+#define BUILTIN_SLOTS 16
+static const builtin_name *builtin_names[BUILTIN_SLOTS];
+static int builtin_names_ready = 0;
+
+
+/** State of the registry **/
+// Open addressing table of libraries indexed by their device and inode.
+// It holds pointers so the libraries don't move when it grows
+static struct {
+    library **slots;    // NULL on the empty slots
+    size_t size;        // Number of slots (a power of 2)
+    size_t count;       // Number of libraries
+    int binding;        // LIBRARY_BIND_NOW or LIBRARY_BIND_LAZY
+    int seeded;         // 1 once library_seed() has been called
+    unsigned long long seed;
+} registry = {NULL, 0, 0, LIBRARY_BIND_NOW, 0, 0};
+
+
+/** Declaration of private functions **/
+size_t _library_hash(dev_t dev, ino_t ino);
+unsigned _builtin_hash(const char *name);
+int _builtin_find(const char *name);
+int _builtin_same(const fnm_plugin *info, const fnm_plugin *builtin);
+library* _library_find(dev_t dev, ino_t ino);
+int _library_insert(library *lib);
+int _library_resize(size_t size);
+int _copy_file(const char *from, int to);
+int _seed_handle(void *handle, unsigned long long seed);
+
+/** PUBLIC FUNCTIONS: Defined on library.h **/
+
+void library_set_binding(int binding){
+    registry.binding = binding;
+}
+
+int library_get_binding(){
+    return registry.binding;
+}
+
+const library* library_open(const char *path, int *loaded){
+    struct stat info;
+    library *lib;
+
+    // Different paths to the same file (relative paths, links...) have
+    // the same device and inode
+    char *real = realpath(path, NULL);
+    if(real == NULL)
+        return NULL;
+    if(stat(real, &info) == -1){
+        free(real);
+        return NULL;
+    }
+
+    if((lib = _library_find(info.st_dev, info.st_ino)) != NULL){
+        free(real);
+        *loaded = 1;
+        return lib;
+    }
+
+    // With RTLD_NOW the calls don't resolve their symbol the first time
+    int mode = (registry.binding == LIBRARY_BIND_LAZY) ? RTLD_LAZY : RTLD_NOW;
+    void *handle = dlopen(real, mode);
+    if(handle == NULL || (lib = malloc(sizeof(library))) == NULL){
+        if(handle != NULL)
+            dlclose(handle);
+        free(real);
+        return NULL;
+    }
+    lib->path = real;
+    lib->dev = info.st_dev;
+    lib->ino = info.st_ino;
+    lib->handle = handle;
+
+    if(_library_insert(lib) == -1){
+        dlclose(handle);
+        free(real);
+        free(lib);
+        return NULL;
+    }
+    if(registry.seeded)
+        _seed_handle(handle, registry.seed);
+
+    *loaded = 0;
+    return lib;
+}
+
+library* library_find(const char *path){
+    size_t i;
+    library *lib = NULL;
+
+    char *real = realpath(path, NULL);
+    if(real == NULL)
+        return NULL;
+
+    // The file may have been replaced, so its inode is not used
+    for(i = 0; i < registry.size && lib == NULL; i++){
+        if(registry.slots[i] != NULL && strcmp(registry.slots[i]->path, real) == 0)
+            lib = registry.slots[i];
+    }
+
+    free(real);
+    return lib;
+}
+
+void* library_open_copy(const library *lib){
+    char copy[] = LIBRARY_COPY;
+    void *handle = NULL;
+
+    int fd = mkstemp(copy);
+    if(fd == -1)
+        return NULL;
+
+    // The copy can be removed once it's opened, since it stays mapped
+    if(_copy_file(lib->path, fd) == 0){
+        int mode = (registry.binding == LIBRARY_BIND_LAZY) ? RTLD_LAZY : RTLD_NOW;
+        handle = dlopen(copy, mode);
+    }
+    close(fd);
+    unlink(copy);
+
+    return handle;
+}
+
+void* library_replace(library *lib, void *handle){
+    struct stat info;
+    void *old = lib->handle;
+
+    lib->handle = handle;
+    if(registry.seeded)
+        _seed_handle(handle, registry.seed);
+    // The new file is found by its inode, like the rest of libraries
+    if(stat(lib->path, &info) == 0 && (info.st_dev != lib->dev || info.st_ino != lib->ino)){
+        lib->dev = info.st_dev;
+        lib->ino = info.st_ino;
+        _library_resize(registry.size);
+    }
+
+    return old;
+}
+
+const fnm_plugin* library_builtin(const char *name, int *loaded){
+    int i = _builtin_find(name);
+    if(i == -1)
+        return NULL;
+
+    *loaded = builtins[i].loaded;
+    builtins[i].loaded = 1;
+    return builtins[i].info;
+}
+
+int library_builtin_plugin(const fnm_plugin *info, int include){
+    size_t i;
+
+    for(i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++){
+        if(_builtin_same(info, builtins[i].info)){
+            int loaded = builtins[i].loaded;
+            if(include)
+                builtins[i].loaded = 1;
+            return loaded;
+        }
+    }
+    return 0;
+}
+
+int library_seed(unsigned long long seed){
+    size_t i;
+    int count = 0;
+
+    registry.seeded = 1;
+    registry.seed = seed;
+    for(i = 0; i < registry.size; i++){
+        if(registry.slots[i] != NULL)
+            count += _seed_handle(registry.slots[i]->handle, seed);
+    }
+    return count;
+}
+
+void library_free(){
+    size_t i;
+
+    for(i = 0; i < registry.size; i++){
+        if(registry.slots[i] != NULL){
+            dlclose(registry.slots[i]->handle);
+            free(registry.slots[i]->path);
+            free(registry.slots[i]);
+        }
+    }
+    free(registry.slots);
+    registry.slots = NULL;
+    registry.size = 0;
+    registry.count = 0;
+}
+
+
+/** Implementation of private functions **/
+
+size_t _library_hash(dev_t dev, ino_t ino){
+    // Mixes the bits of both numbers (64 bits finalizer of MurmurHash3)
+    unsigned long long h = (unsigned long long)ino ^ ((unsigned long long)dev << 32);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+unsigned _builtin_hash(const char *name){
+    size_t len = strlen(name);
+
+    // The first and the last characters tell most of the names apart
+    if(len == 0)
+        return 0;
+    return ((unsigned char)name[0] + (unsigned char)name[len - 1]) & (BUILTIN_SLOTS - 1);
+}
+
+int _builtin_find(const char *name){
+    size_t i;
+    unsigned slot;
+
+    // The names that share a slot go to the next free ones
+    if(!builtin_names_ready){
+        for(i = 0; builtin_aliases[i].name != NULL; i++){
+            slot = _builtin_hash(builtin_aliases[i].name);
+            while(builtin_names[slot] != NULL)
+                slot = (slot + 1) & (BUILTIN_SLOTS - 1);
+            builtin_names[slot] = &builtin_aliases[i];
+        }
+        builtin_names_ready = 1;
+    }
+
+    for(slot = _builtin_hash(name); builtin_names[slot] != NULL; slot = (slot + 1) & (BUILTIN_SLOTS - 1)){
+        if(strcmp(builtin_names[slot]->name, name) == 0)
+            return builtin_names[slot]->library;
+    }
+    return -1;
+}
+
+int _builtin_same(const fnm_plugin *info, const fnm_plugin *builtin){
+    size_t i;
+    const char *name;
+
+    if(info->version < 2 || info->functions == NULL)
+        return 0;
+
+    // The names are the first field of the functions on any version
+    for(i = 0; builtin->functions[i].name != 0; i++){
+        name = ((const fnm_function *)((const char *)info->functions + i * info->function_size))->name;
+        if(name == 0 || strcmp(name, builtin->functions[i].name) != 0)
+            return 0;
+    }
+    if(((const fnm_function *)((const char *)info->functions + i * info->function_size))->name != 0)
+        return 0;
+
+    if(info->constants == NULL || builtin->constants == NULL)
+        return info->constants == builtin->constants;
+    for(i = 0; builtin->constants[i].name != 0; i++){
+        if(info->constants[i].name == 0 || strcmp(info->constants[i].name, builtin->constants[i].name) != 0)
+            return 0;
+    }
+    return info->constants[i].name == 0;
+}
+
+library* _library_find(dev_t dev, ino_t ino){
+    size_t i;
+
+    if(registry.count == 0)
+        return NULL;
+
+    for(i = _library_hash(dev, ino) & (registry.size - 1); registry.slots[i] != NULL;
+            i = (i + 1) & (registry.size - 1)){
+        if(registry.slots[i]->dev == dev && registry.slots[i]->ino == ino)
+            return registry.slots[i];
+    }
+    return NULL;
+}
+
+int _library_insert(library *lib){
+    size_t i;
+
+    // The table is kept at most half full
+    if(2 * (registry.count + 1) > registry.size
+            && _library_resize(registry.size == 0 ? LIBRARY_SLOTS : 2 * registry.size) == -1)
+        return -1;
+
+    i = _library_hash(lib->dev, lib->ino) & (registry.size - 1);
+    while(registry.slots[i] != NULL)
+        i = (i + 1) & (registry.size - 1);
+    registry.slots[i] = lib;
+    registry.count++;
+    return 0;
+}
+
+int _library_resize(size_t size){
+    size_t i, j;
+
+    library **slots = calloc(size, sizeof(library *));
+    if(slots == NULL)
+        return -1;
+
+    for(i = 0; i < registry.size; i++){
+        if(registry.slots[i] == NULL)
+            continue;
+        j = _library_hash(registry.slots[i]->dev, registry.slots[i]->ino) & (size - 1);
+        while(slots[j] != NULL)
+            j = (j + 1) & (size - 1);
+        slots[j] = registry.slots[i];
+    }
+
+    free(registry.slots);
+    registry.slots = slots;
+    registry.size = size;
+    return 0;
+}
+
+int _copy_file(const char *from, int to){
+    char buffer[COPY_BUFFER_SIZE];
+    ssize_t n;
+
+    int fd = open(from, O_RDONLY);
+    if(fd == -1)
+        return -1;
+
+    while((n = read(fd, buffer, COPY_BUFFER_SIZE)) > 0){
+        if(write(to, buffer, n) != n){
+            n = -1;
+            break;
+        }
+    }
+
+    close(fd);
+    return (n == 0) ? 0 : -1;
+}
+
+int _seed_handle(void *handle, unsigned long long seed){
+    // Most libraries don't use random numbers
+    fnm_seed set_seed = (fnm_seed)dlsym(handle, FNM_PLUGIN_SEED);
+    if(set_seed == NULL)
+        return 0;
+    set_seed(seed);
+    return 1;
+}
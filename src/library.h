@@ -0,0 +1,143 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: library.h
+ * Definitions of the registry of the included
+ * libraries. Each library is opened only once,
+ * identified by its device and inode, and is
+ * closed when the program finishes
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <sys/types.h>
+#include "../lib/fnm_plugin.h"
+
+/* Initial number of slots of the registry (must be a power of 2) */
+#define LIBRARY_SLOTS 16
+
+/* Template of the copies of the libraries opened by library_open_copy() */
+#define LIBRARY_COPY "/tmp/fnm-library-XXXXXX"
+
+/* Prefix of the names of the libraries compiled into the program */
+#define LIBRARY_BUILTIN "builtin:"
+
+/** Binding of the symbols of a library **/
+#define LIBRARY_BIND_NOW    0   // Resolved when the library is opened
+#define LIBRARY_BIND_LAZY   1   // Resolved on the first call
+
+/** Library of the registry **/
+typedef struct {
+    char *path;     // Canonical path of the file
+    dev_t dev;      // Device of the file
+    ino_t ino;      // Inode of the file
+    void *handle;   // Handle returned by dlopen()
+} library;
+
+/**
+ * Sets how the symbols of the next libraries are bound
+ *
+ * @param binding: LIBRARY_BIND_NOW (default) or LIBRARY_BIND_LAZY
+ */
+void library_set_binding(int binding);
+
+/**
+ * Returns how the symbols of the next libraries are bound
+ *
+ * @return LIBRARY_BIND_NOW or LIBRARY_BIND_LAZY
+ */
+int library_get_binding();
+
+/**
+ * Opens a library, or finds it on the registry if the same file was
+ * already opened (through this or any other path)
+ *
+ * @param path: Path (relative or absolute) to the .so file
+ * @param loaded: Place to store 1 if the library was already on the
+ * registry or 0 if it has just been opened
+ * @return The library or NULL if it couldn't be opened
+ */
+const library* library_open(const char *path, int *loaded);
+
+/**
+ * Finds a library of the registry by the path of its file
+ *
+ * @param path: Path (relative or absolute) to the .so file
+ * @return The library or NULL if it was not opened
+ */
+library* library_find(const char *path);
+
+/**
+ * Opens the current version of the file of a library next to the one on
+ * the registry. The file is copied first, since dlopen() would return the
+ * handle already opened for the same file
+ *
+ * @param lib: Library of the registry
+ * @return The handle of the new version or NULL if it couldn't be opened
+ */
+void* library_open_copy(const library *lib);
+
+/**
+ * Replaces the handle of a library of the registry by a new version
+ * opened with library_open_copy()
+ *
+ * @param lib: Library of the registry
+ * @param handle: Handle of the new version
+ * @return The previous handle, that must be closed with dlclose() once
+ * none of its functions can be called
+ */
+void* library_replace(library *lib, void *handle);
+
+/**
+ * Finds a library compiled into the program, like "trig" for the
+ * library lib/trigonometric.c. They don't need to be opened, so
+ * including them doesn't call dlopen() nor dlsym()
+ *
+ * @param name: Name of the library, without the prefix LIBRARY_BUILTIN
+ * (short or full name: "trig", "exp", "round", "trigonometric"...)
+ * @param loaded: Place to store 1 if the library was already found
+ * before or 0 if it's the first time
+ * @return The descriptor of the library or NULL if there is none with
+ * that name
+ */
+const fnm_plugin* library_builtin(const char *name, int *loaded);
+
+/**
+ * Finds the built-in library whose functions and constants are the ones
+ * of the descriptor of a .so file, like lib/round.so for "builtin:round",
+ * so they are not included twice. The name of the file doesn't matter
+ *
+ * @param info: Descriptor exported by the .so file
+ * @param include: 1 to mark the built-in library as included, once the
+ * file has been included, or 0 to only check it
+ * @return 1 if the built-in library was already included, or 0 if it
+ * was not or the descriptor is not the one of a built-in library
+ */
+int library_builtin_plugin(const fnm_plugin *info, int include);
+
+/**
+ * Sets the seed of the random numbers of the included libraries, calling
+ * their function FNM_PLUGIN_SEED. The libraries included later receive
+ * the same seed
+ *
+ * @param seed: New seed
+ * @return The number of libraries that use the seed
+ */
+int library_seed(unsigned long long seed);
+
+/**
+ * Closes all the libraries and frees the memory of the registry. The
+ * functions of the libraries can't be called after it
+ */
+void library_free();
+
+#endif /* LIBRARY_H */
@@ -16,18 +16,82 @@
 /********************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "ST.h"
 #include "sintactic.tab.h"
+#include "reduce.h"
+#include "output.h"
+
+/* Exit status of wrong arguments on the command line */
+#define EXIT_USAGE 2
+
+/** Declaration of private functions **/
+void _usage(const char *program);
 
 int main(int argc, char *argv[]) {
+    int i, n = 0, options = 1;
+
+    // Reads the inputs of the batch mode, in the same order
+    batch_input *inputs = malloc(argc * sizeof(batch_input));
+    for(i = 1; i < argc; i++){
+        if(options && strcmp(argv[i], "--") == 0)
+            options = 0; // The next arguments are files
+        else if(options && strcmp(argv[i], "-e") == 0){
+            if(++i == argc){
+                _usage(argv[0]);
+                free(inputs);
+                return EXIT_USAGE;
+            }
+            inputs[n].type = BATCH_EXPRESSION;
+            inputs[n++].text = argv[i];
+        }
+        else if(options && (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)){
+            _usage(argv[0]);
+            free(inputs);
+            return EXIT_SUCCESS;
+        }
+        else if(options && argv[i][0] == '-'){
+            _usage(argv[0]);
+            free(inputs);
+            return EXIT_USAGE;
+        }
+        else{
+            inputs[n].type = BATCH_FILE;
+            inputs[n++].text = argv[i];
+        }
+    }
+
+    // Colors, prompt and buffer depending on where the output goes
+    output_init();
 
     // Instance and initialize the symbol table
     // with the defined commands (commands.h)
     symbol_table *st = st_init(list_commands);
+    // Adds the predefined reductions (reduce.h)
+    reduce_init(st, list_reductions);
     
+    if(n > 0){
+        // Runs the files and expressions and finishes like 'quit'
+        startBatch(st, inputs, n);
+        free(inputs);
+        quit(st);
+    }
+    free(inputs);
+
     // Begins interactive program execution
     // Starts the syntactic analyzer (sintactic.tab.h)
     startExecution(st);
 
     return 0;
-}
\ No newline at end of file
+}
+
+
+/** Implementation of private functions **/
+
+void _usage(const char *program){
+    fprintf(stderr, "Usage: %s [-e expressions] [file...]\n", program);
+    fprintf(stderr, "Without arguments, starts the interactive mode. Otherwise, runs the\n");
+    fprintf(stderr, "files and expressions in order, without banner nor prompt, and exits\n");
+    fprintf(stderr, "with status 0 if no line had errors, 1 otherwise or 2 on wrong arguments\n");
+}
@@ -0,0 +1,273 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: number.c
+ * Implementation of the reading of the number
+ * literals defined on the header file number.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * The decimal literals are read with the algorithm of Eisel and Lemire
+ * (D. Lemire, "Number parsing at a gigabyte per second", Software: Practice
+ * and Experience, 2021). The first 19 significant digits are multiplied by
+ * a power of 5 of 128 bits from number_tables.h, and the highest bits of
+ * the product are the mantissa. Small numbers are computed exactly with
+ * doubles (Clinger's fast path). The rare literals that can't be decided
+ * with 128 bits are read by strtod_l() on the "C" locale.
+ */
+
+#define _GNU_SOURCE     // strtod_l() and newlocale()
+#include "number.h"
+#include "number_tables.h"
+
+#include <locale.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Binary format of a double **/
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_MIN_EXPONENT (-1023)
+#define DOUBLE_INFINITE_EXPONENT 0x7FF
+
+/* Significant digits that fit on 64 bits */
+#define EXACT_DIGITS 19
+
+/* Limits of the numbers computed exactly with doubles */
+#define CLINGER_MAX_MANTISSA (1ULL << (DOUBLE_MANTISSA_BITS + 1))
+#define CLINGER_MAX_EXPONENT 22
+
+/* Greatest exponent read from a literal (the result is 0 or inf before) */
+#define MAX_EXPONENT 100000
+
+/* Characters copied on the stack for strtod_l() */
+#define FALLBACK_SIZE 128
+
+/* Exact powers of 10 of the fast path */
+static const double exact_pow10[CLINGER_MAX_EXPONENT + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* "C" locale of strtod_l(), created the first time it's needed (the
+ * literals are also read by the thread of the pipelined loads) */
+static locale_t c_locale = (locale_t)0;
+static pthread_once_t c_locale_once = PTHREAD_ONCE_INIT;
+
+
+/** Declaration of private functions **/
+int _eisel_lemire(uint64_t w, int64_t q, double *result);
+double _fallback(const char *text, size_t length);
+void _c_locale_new();
+double _radix(const char *digits, size_t length, int bits);
+
+/** PUBLIC FUNCTIONS: Defined on number.h **/
+
+double number_decimal(const char *text, size_t length){
+    const char *end = text + length;
+    uint64_t w = 0;
+    int64_t q = 0, exponent = 0;
+    int digits = 0, fraction = 0, truncated = 0, negative = 0;
+    double a, b;
+
+    // Mantissa: w * 10^q with the first EXACT_DIGITS significant digits
+    for(; text < end && *text != 'e' && *text != 'E'; text++){
+        if(*text == '.'){
+            fraction = 1;
+            continue;
+        }
+        unsigned d = (unsigned)(*text - '0');
+        if(digits < EXACT_DIGITS){
+            w = 10 * w + d;
+            digits += (w != 0);     // The leading zeros aren't significant
+            q -= fraction;
+        }
+        else{
+            truncated |= (d != 0);
+            q += !fraction;
+        }
+    }
+
+    // Exponent
+    if(text < end){
+        text++;
+        if(text < end && (*text == '+' || *text == '-'))
+            negative = (*text++ == '-');
+        for(; text < end; text++)
+            if(exponent < MAX_EXPONENT)
+                exponent = 10 * exponent + (*text - '0');
+        q += negative ? -exponent : exponent;
+    }
+
+    if(w == 0)
+        return 0.0;
+
+    if(!truncated){
+        // Both factors are exact, so the product is correctly rounded
+        if(w <= CLINGER_MAX_MANTISSA && q >= -CLINGER_MAX_EXPONENT && q <= CLINGER_MAX_EXPONENT)
+            return (q < 0) ? (double)w / exact_pow10[-q] : (double)w * exact_pow10[q];
+        if(_eisel_lemire(w, q, &a))
+            return a;
+    }
+    // The literal is between w and w + 1 (times 10^q): if both are rounded
+    // to the same double, so is the literal
+    else if(_eisel_lemire(w, q, &a) && _eisel_lemire(w + 1, q, &b) && a == b)
+        return a;
+
+    return _fallback(end - length, length);
+}
+
+double number_binary(const char *digits, size_t length){
+    return _radix(digits, length, 1);
+}
+
+double number_hexadecimal(const char *digits, size_t length){
+    return _radix(digits, length, 4);
+}
+
+
+/** Implementation of private functions **/
+
+int _eisel_lemire(uint64_t w, int64_t q, double *result){
+    uint64_t bits;
+
+    if(q < NUMBER_POW5_MIN_EXPONENT){
+        *result = 0.0;
+        return 1;
+    }
+    if(q > NUMBER_POW5_MAX_EXPONENT){
+        *result = INFINITY;
+        return 1;
+    }
+
+    // Product of the normalized w and 5^q, with 128 bits
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+    const uint64_t *pow5 = number_pow5[q - NUMBER_POW5_MIN_EXPONENT];
+    unsigned __int128 product = (unsigned __int128)w * pow5[1];
+    uint64_t high = (uint64_t)(product >> 64), low = (uint64_t)product;
+    if((high & 0x1FF) == 0x1FF){
+        // The 9 bits below the rounding bit are all 1, so the low 64 bits
+        // of 5^q could carry into them
+        unsigned __int128 second = (unsigned __int128)w * pow5[0];
+        uint64_t carry = (uint64_t)(second >> 64);
+        low += carry;
+        high += (low < carry);
+        if(low == UINT64_MAX && (q < -27 || q > 55))
+            return 0;   // Still undecided: the product isn't exact
+    }
+
+    // Mantissa with one more bit to round, and its biased exponent
+    int upper = (int)(high >> 63);
+    int shift = upper + 64 - DOUBLE_MANTISSA_BITS - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(log2(10^q)) + 63 = floor(q * log2(10)) + 63
+    int32_t power2 = (int32_t)(((217706 * q) >> 16) + 63 + upper - lz - DOUBLE_MIN_EXPONENT);
+
+    if(power2 <= 0){
+        // Subnormal number
+        if(-power2 + 1 >= 64){
+            *result = 0.0;
+            return 1;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+        // The rounding can give the smallest normal number
+        power2 = (mantissa >= (1ULL << DOUBLE_MANTISSA_BITS));
+        bits = (mantissa & ((1ULL << DOUBLE_MANTISSA_BITS) - 1)) | ((uint64_t)power2 << DOUBLE_MANTISSA_BITS);
+        memcpy(result, &bits, sizeof(double));
+        return 1;
+    }
+
+    // Exactly in the middle: only possible for small exponents. Rounds to
+    // even clearing the rounding bit
+    if(low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high)
+        mantissa &= ~1ULL;
+
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if(mantissa >= (2ULL << DOUBLE_MANTISSA_BITS)){
+        // The rounding carried to a new bit
+        mantissa = (1ULL << DOUBLE_MANTISSA_BITS);
+        power2++;
+    }
+    mantissa &= ~(1ULL << DOUBLE_MANTISSA_BITS);
+    if(power2 >= DOUBLE_INFINITE_EXPONENT){
+        power2 = DOUBLE_INFINITE_EXPONENT;
+        mantissa = 0;
+    }
+
+    bits = mantissa | ((uint64_t)power2 << DOUBLE_MANTISSA_BITS);
+    memcpy(result, &bits, sizeof(double));
+    return 1;
+}
+
+double _fallback(const char *text, size_t length){
+    char stack[FALLBACK_SIZE];
+    char *copy = (length < FALLBACK_SIZE) ? stack : malloc(length + 1);
+    double result;
+
+    // strtod_l() needs the text ended with '\0'
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    pthread_once(&c_locale_once, _c_locale_new);
+    if(c_locale != (locale_t)0)
+        result = strtod_l(copy, NULL, c_locale);
+    else
+        result = strtod(copy, NULL);
+
+    if(copy != stack)
+        free(copy);
+    return result;
+}
+
+void _c_locale_new(){
+    c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+}
+
+double _radix(const char *digits, size_t length, int bits){
+    uint64_t m = 0;
+    int64_t shift = 0;
+    int sticky = 0;
+    size_t i;
+
+    // The first 64 bits are kept on m. The next ones only matter to round
+    for(i = 0; i < length; i++){
+        char c = digits[i];
+        unsigned d = (c <= '9') ? (unsigned)(c - '0') : (unsigned)((c | 0x20) - 'a' + 10);
+        if((m >> (64 - bits)) == 0)
+            m = (m << bits) | d;
+        else{
+            sticky |= (d != 0);
+            shift += bits;
+        }
+    }
+
+    if(m == 0)
+        return 0.0;
+
+    // The 53 highest bits are the mantissa, rounded by the rest (ties to even)
+    int lz = __builtin_clzll(m);
+    m <<= lz;
+    uint64_t mantissa = m >> (63 - DOUBLE_MANTISSA_BITS);
+    uint64_t rest = m & ((1ULL << (63 - DOUBLE_MANTISSA_BITS)) - 1);
+    uint64_t half = 1ULL << (62 - DOUBLE_MANTISSA_BITS);
+    if(rest > half || (rest == half && (sticky || (mantissa & 1))))
+        mantissa++;
+
+    // ldexp() is exact, and gives inf if the literal is too big
+    if(shift - lz + 63 > -DOUBLE_MIN_EXPONENT)
+        return INFINITY;
+    return ldexp((double)mantissa, (int)(shift - lz + 63 - DOUBLE_MANTISSA_BITS));
+}
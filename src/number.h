@@ -0,0 +1,53 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: number.h
+ * Definitions of the functions that read the
+ * number literals: decimal, binary and
+ * hexadecimal, rounded to the nearest double
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include <stddef.h>
+
+/**
+ * Reads a decimal literal, with the syntax of the lexical analyzer:
+ * digits, optionally a '.' and more digits, and optionally an exponent
+ * ('e' or 'E', a sign and digits). The result is correctly rounded and
+ * doesn't depend on the locale
+ *
+ * @param text: First character of the literal, that needn't end with '\0'
+ * @param length: Number of characters of the literal
+ * @return The nearest double to the literal
+ */
+double number_decimal(const char *text, size_t length);
+
+/**
+ * Reads the digits of a binary literal, of any length
+ *
+ * @param digits: First digit, after the prefix '0b'
+ * @param length: Number of digits
+ * @return The nearest double to the literal (ties to even)
+ */
+double number_binary(const char *digits, size_t length);
+
+/**
+ * Reads the digits of a hexadecimal literal, of any length
+ *
+ * @param digits: First digit, after the prefix '0x'
+ * @param length: Number of digits
+ * @return The nearest double to the literal (ties to even)
+ */
+double number_hexadecimal(const char *digits, size_t length);
+
+#endif /* NUMBER_H */
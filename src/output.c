@@ -0,0 +1,90 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: output.c
+ * Implementation of the output of the program
+ * defined on the header file output.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#include "output.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <stdio_ext.h>
+
+/* Escape sequences of the colors, in the order of their numbers */
+static const char *colors[] = {
+    "\x1b[0m",  // OUTPUT_RESET
+    "\x1b[31m", // OUTPUT_RED
+    "\x1b[32m", // OUTPUT_GREEN
+    "\x1b[33m", // OUTPUT_YELLOW
+    "\x1b[34m", // OUTPUT_BLUE
+    "\x1b[35m", // OUTPUT_MAGENTA
+    "\x1b[36m"  // OUTPUT_CYAN
+};
+
+/** State of the output **/
+static struct {
+    int terminal;       // 1 if the standard output is a terminal
+    int typed;          // 1 if the standard input is a terminal
+} output = {1, 1};
+
+/* Buffer of the output when it's not a terminal */
+static char buffer[OUTPUT_BUFFER_SIZE];
+
+
+/** PUBLIC FUNCTIONS: Defined on output.h **/
+
+void output_init(){
+    output.terminal = isatty(STDOUT_FILENO);
+    output.typed = isatty(STDIN_FILENO);
+
+    // A terminal keeps the default buffer, written at the end of each line
+    if(!output.terminal)
+        setvbuf(stdout, buffer, _IOFBF, OUTPUT_BUFFER_SIZE);
+}
+
+int output_is_terminal(){
+    return output.terminal;
+}
+
+void output_color(int color){
+    if(output.terminal)
+        fputs(colors[color], stdout);
+}
+
+void output_message(int color, const char *format, ...){
+    va_list args;
+
+    output_color(color);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    output_color(OUTPUT_RESET);
+    putchar('\n');
+}
+
+void output_prompt(){
+    if(output.terminal)
+        fputs("$> ", stdout);
+}
+
+void output_line_end(){
+    if(output.terminal)
+        return;
+    if(output.typed || __fpending(stdout) >= OUTPUT_FLUSH_SIZE)
+        fflush(stdout);
+}
+
+void output_flush(){
+    fflush(stdout);
+}
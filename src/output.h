@@ -0,0 +1,84 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: output.h
+ * Definitions of the output of the program.
+ * On a terminal the messages have colors and
+ * the prompt is shown. Otherwise (pipes and
+ * files) both are omitted and the output is
+ * written through a large buffer
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+/* Size of the buffer of the output when it's not a terminal */
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+/* Pending bytes that make the buffer be written at the end of a line */
+#define OUTPUT_FLUSH_SIZE (3 * OUTPUT_BUFFER_SIZE / 4)
+
+/** Colors of the messages **/
+#define OUTPUT_RESET    0
+#define OUTPUT_RED      1
+#define OUTPUT_GREEN    2
+#define OUTPUT_YELLOW   3
+#define OUTPUT_BLUE     4
+#define OUTPUT_MAGENTA  5
+#define OUTPUT_CYAN     6
+
+/**
+ * Checks if the standard output is a terminal and prepares it. Must be
+ * called before writing anything
+ */
+void output_init();
+
+/**
+ * Checks if the standard output is a terminal
+ *
+ * @return 1 if it's a terminal or 0 otherwise
+ */
+int output_is_terminal();
+
+/**
+ * Changes the color of the next text written (only on a terminal)
+ *
+ * @param color: One of the colors OUTPUT_*, or OUTPUT_RESET to return
+ * to the default one
+ */
+void output_color(int color);
+
+/**
+ * Writes a line of text with a color (like printf(), without '\n')
+ *
+ * @param color: One of the colors OUTPUT_*
+ * @param format: Format of the text, followed by its arguments
+ */
+void output_message(int color, const char *format, ...);
+
+/**
+ * Writes the prompt (only on a terminal)
+ */
+void output_prompt();
+
+/**
+ * Marks the end of an input line. Out of a terminal the buffer is written
+ * once it has OUTPUT_FLUSH_SIZE bytes, so the lines are not split, or
+ * after every line if somebody is typing the input
+ */
+void output_line_end();
+
+/**
+ * Writes everything that remains on the buffer
+ */
+void output_flush();
+
+#endif /* OUTPUT_H */
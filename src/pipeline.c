@@ -0,0 +1,514 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: pipeline.c
+ * Implementation of the pipelined reading of
+ * the loaded files defined on the header file
+ * pipeline.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * A file goes through three stages, each one on its own thread: the reader
+ * divides it in blocks of whole lines (and takes the page faults of the
+ * map), the scanner finds the tokens of each block, and the analyzer (the
+ * main thread) classifies the identifiers, parses and runs the lines in
+ * order. The reader and the scanner take two workers of the thread pool
+ * (pool_spawn()), so the file is read without a pipeline if they are not
+ * free. The identifiers are classified by the analyzer because their
+ * lexical components depend on the lines run before them (an include can
+ * change them), so the semantics are the same as without the pipeline.
+ *
+ * The blocks go from each stage to the next one through rings with a single
+ * producer and a single consumer, and the analyzer returns them to the
+ * reader through a third ring. There are as many blocks as slots on each
+ * ring, so they are never full, and a stage only waits when its input ring
+ * is empty: first spinning, and then sleeping until another stage changes
+ * a ring.
+ */
+
+#define _GNU_SOURCE     // memrchr()
+#include "pipeline.h"
+#include "number.h"
+#include "pool.h"
+#include "sintactic.tab.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Blocks of a pipeline: it's also the size of its rings (a power of 2) */
+#define PIPELINE_BLOCKS 8
+
+/* Characters of a block: it's extended to the end of its last line */
+#define PIPELINE_BLOCK_SIZE ((size_t)32 << 10)
+
+/* Times a stage checks its ring before sleeping */
+#define PIPELINE_SPIN 2048
+
+/* Initial number of tokens and characters of texts of a block */
+#define TOKENS_INITIAL_SIZE 4096
+#define TEXTS_INITIAL_SIZE 4096
+
+/** Token of a block, with its text as a position on the texts of the block **/
+typedef struct {
+    int token;
+    uint32_t end;
+    union {
+        double val;
+        size_t text;
+    };
+} _token;
+
+/** Block of lines of the file **/
+typedef struct {
+    const char *text;       // Its characters on the file
+    size_t length;
+    long offset;            // Position of text on the file
+    int last;               // 1 if it ends the file
+    _token *tokens;         // Tokens, followed by PIPELINE_END on the last block
+    size_t n_tokens;
+    size_t tokens_size;
+    char *texts;            // Texts of the tokens
+    size_t texts_length;
+    size_t texts_size;
+} _block;
+
+/** Ring with a single producer and a single consumer **/
+// The positions only grow: the slot of a position is its remainder
+typedef struct {
+    _Atomic size_t head;        // Next block to take (consumer)
+    char pad1[64 - sizeof(size_t)];
+    _Atomic size_t tail;        // Next free slot (producer)
+    char pad2[64 - sizeof(size_t)];
+    _block *slots[PIPELINE_BLOCKS];
+} _ring;
+
+/** Pipeline of a file **/
+struct pipeline {
+    const char *text;
+    size_t size;
+    long offset;
+
+    _ring free;             // Empty blocks: analyzer -> reader
+    _ring read;             // Blocks of lines: reader -> scanner
+    _ring scanned;          // Blocks of tokens: scanner -> analyzer
+    _block blocks[PIPELINE_BLOCKS];
+
+    pthread_t reader, scanner;
+    _Atomic int stop;           // 1 when the threads must finish
+    _Atomic int sleepers;       // Stages waiting for a ring
+    pthread_mutex_t lock;
+    pthread_cond_t changed;     // Signals a change of a ring or the stop
+
+    // State of the analyzer
+    _block *current;            // Block being returned, or NULL
+    size_t next;                // Next token of current
+    long position;              // Position after the last token returned
+    pipeline_token token;       // Last token returned
+};
+
+/* 1 if the pipelines are enabled */
+static int enabled = 1;
+
+
+/** Declaration of private functions **/
+void _push(pipeline *p, _ring *r, _block *b);
+_block* _pop(pipeline *p, _ring *r);
+void _stop(pipeline *p);
+void* _reader(void *param);
+void* _scanner(void *param);
+int _scan(_block *b);
+int _add_token(_block *b, int token, size_t end, const char *text, size_t length);
+size_t _string_end(const char *text, size_t i, size_t n);
+size_t _decimal_end(const char *text, size_t i, size_t n);
+int _is_id(char c, int first);
+int _is_digit(char c);
+int _is_hex(char c);
+void _free(pipeline *p);
+
+/** PUBLIC FUNCTIONS: Defined on pipeline.h **/
+
+void pipeline_set_enabled(int value){
+    enabled = value;
+}
+
+int pipeline_get_enabled(){
+    return enabled;
+}
+
+pipeline* pipeline_new(const char *text, size_t size, long offset){
+    int i;
+
+    pipeline *p = calloc(1, sizeof(pipeline));
+    if(p == NULL)
+        return NULL;
+    p->text = text;
+    p->size = size;
+    p->offset = offset;
+    p->position = offset;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->changed, NULL);
+
+    // All the blocks begin on the ring of the reader
+    int valid = 1;
+    for(i = 0; i < PIPELINE_BLOCKS; i++){
+        _block *b = &p->blocks[i];
+        b->tokens = malloc(TOKENS_INITIAL_SIZE * sizeof(_token));
+        b->tokens_size = TOKENS_INITIAL_SIZE;
+        b->texts = malloc(TEXTS_INITIAL_SIZE);
+        b->texts_size = TEXTS_INITIAL_SIZE;
+        valid = valid && b->tokens != NULL && b->texts != NULL;
+        p->free.slots[i] = b;
+    }
+    atomic_store(&p->free.tail, PIPELINE_BLOCKS);
+
+    // The threads are workers of the pool, so there must be two free
+    if(!valid || pool_spawn(&p->reader, _reader, p) == -1){
+        _free(p);
+        return NULL;
+    }
+    if(pool_spawn(&p->scanner, _scanner, p) == -1){
+        _stop(p);
+        pool_join(p->reader);
+        _free(p);
+        return NULL;
+    }
+
+    return p;
+}
+
+const pipeline_token* pipeline_next(pipeline *p){
+    // The blocks are returned to the reader once all their tokens are read
+    while(p->current == NULL || p->next == p->current->n_tokens){
+        if(p->current != NULL){
+            if(p->current->last)
+                break;
+            _push(p, &p->free, p->current);
+        }
+        p->current = _pop(p, &p->scanned);
+        p->next = 0;
+        if(p->current == NULL)
+            break;
+    }
+
+    // After the end, the last token is repeated
+    if(p->current == NULL || p->next == p->current->n_tokens){
+        p->token.token = PIPELINE_END;
+        return &p->token;
+    }
+
+    _token *token = &p->current->tokens[p->next++];
+    p->token.token = token->token;
+    p->token.end = token->end;
+    if(token->token == NUM)
+        p->token.val = token->val;
+    else
+        p->token.text = p->current->texts + token->text;
+    p->position = p->current->offset + (long)token->end;
+    return &p->token;
+}
+
+long pipeline_offset(const pipeline *p){
+    return p->position;
+}
+
+void pipeline_free(pipeline *p){
+    _stop(p);
+    pool_join(p->reader);
+    pool_join(p->scanner);
+    _free(p);
+}
+
+/** Implementation of private functions **/
+
+// Adds a block to a ring. It's never full, since it has a slot per block
+void _push(pipeline *p, _ring *r, _block *b){
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    r->slots[tail % PIPELINE_BLOCKS] = b;
+    atomic_store(&r->tail, tail + 1);
+
+    // The stages that sleep are woken up (see _pop())
+    if(atomic_load(&p->sleepers) > 0){
+        pthread_mutex_lock(&p->lock);
+        pthread_cond_broadcast(&p->changed);
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+// Takes the next block of a ring, waiting for it. It returns NULL if the
+// pipeline is stopped
+_block* _pop(pipeline *p, _ring *r){
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    int spin = 0;
+
+    while(atomic_load_explicit(&r->tail, memory_order_acquire) == head){
+        if(atomic_load_explicit(&p->stop, memory_order_relaxed))
+            return NULL;
+        if(spin++ < PIPELINE_SPIN)
+            continue;
+
+        // The sleeper is counted before checking the ring again, and
+        // _push() changes the ring before checking the sleepers, so one of
+        // them sees the other
+        pthread_mutex_lock(&p->lock);
+        atomic_fetch_add(&p->sleepers, 1);
+        while(atomic_load(&r->tail) == head && !atomic_load(&p->stop))
+            pthread_cond_wait(&p->changed, &p->lock);
+        atomic_fetch_sub(&p->sleepers, 1);
+        pthread_mutex_unlock(&p->lock);
+    }
+
+    _block *b = r->slots[head % PIPELINE_BLOCKS];
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return b;
+}
+
+// Makes the threads finish, even if they are waiting
+void _stop(pipeline *p){
+    pthread_mutex_lock(&p->lock);
+    atomic_store(&p->stop, 1);
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->lock);
+}
+
+// Stage of the reader: divides the file in blocks of whole lines
+void* _reader(void *param){
+    pipeline *p = (pipeline *)param;
+    size_t position = 0, i;
+    _block *b;
+
+    do{
+        if((b = _pop(p, &p->free)) == NULL)
+            return NULL;
+
+        // The block ends after the last '\n' of its size, or after the
+        // first one if its line is longer
+        size_t end = position + PIPELINE_BLOCK_SIZE;
+        if(end >= p->size)
+            end = p->size;
+        else{
+            const char *last = memrchr(p->text + position, '\n', end - position);
+            if(last == NULL)
+                last = memchr(p->text + end, '\n', p->size - end);
+            end = (last != NULL) ? (size_t)(last - p->text) + 1 : p->size;
+        }
+
+        // Its pages are read here, instead of on the scanner
+        volatile char touch = 0;
+        for(i = position; i < end; i += 4096)
+            touch += p->text[i];
+
+        b->text = p->text + position;
+        b->length = end - position;
+        b->offset = p->offset + (long)position;
+        b->last = (end == p->size);
+        position = end;
+        _push(p, &p->read, b);
+    } while(!b->last);
+
+    return NULL;
+}
+
+// Stage of the scanner: finds the tokens of each block
+void* _scanner(void *param){
+    pipeline *p = (pipeline *)param;
+    _block *b;
+
+    do{
+        if((b = _pop(p, &p->read)) == NULL)
+            return NULL;
+
+        // Without memory, the file ends on the previous block
+        if(_scan(b) == -1){
+            b->n_tokens = 0;
+            b->last = 1;
+        }
+        if(b->last && _add_token(b, PIPELINE_END, b->length, NULL, 0) == -1)
+            b->n_tokens = 0;
+        _push(p, &p->scanned, b);
+    } while(!b->last);
+
+    return NULL;
+}
+
+// Finds the tokens of a block, with the rules of the lexical analyzer
+// (lexical.l): at each position the longest token is taken. Any change of
+// those rules must be made here too
+int _scan(_block *b){
+    const char *text = b->text;
+    size_t n = b->length, i = 0, end;
+    int status = 0;
+
+    b->n_tokens = 0;
+    b->texts_length = 0;
+    while(i < n && status == 0){
+        char c = text[i];
+        end = i + 1;
+
+        switch(c){
+            case ' ': case '\t':
+                // Only the spaces after a '\n' count (see pipeline.h)
+                while(end < n && (text[end] == ' ' || text[end] == '\t'))
+                    end++;
+                if(i == 0 || text[i - 1] == '\n')
+                    status = _add_token(b, PIPELINE_SPACE, end, NULL, 0);
+                break;
+            case '\n': case '+': case '-': case '*': case '/': case '%': case '^':
+            case '=': case ':': case ',': case '[': case ']': case '(': case ')':
+                status = _add_token(b, c, end, NULL, 0);
+                break;
+            case '"':
+                // Without its closing quote, it's an unexpected symbol
+                end = _string_end(text, i, n);
+                if(end > i)
+                    status = _add_token(b, STRING, end, text + i + 1, end - i - 2);
+                else
+                    status = _add_token(b, PIPELINE_ERROR, end = i + 1, text + i, 1);
+                break;
+            default:
+                if(_is_id(c, 1)){
+                    while(end < n && _is_id(text[end], 0))
+                        end++;
+                    status = _add_token(b, PIPELINE_ID, end, text + i, end - i);
+                }
+                else if(_is_digit(c)){
+                    double val;
+                    if(c == '0' && i + 2 < n && (text[i + 1] == 'b' || text[i + 1] == 'B')
+                       && (text[i + 2] == '0' || text[i + 2] == '1')){
+                        for(end = i + 3; end < n && (text[end] == '0' || text[end] == '1'); end++);
+                        val = number_binary(text + i + 2, end - i - 2);
+                    }
+                    else if(c == '0' && i + 2 < n && (text[i + 1] == 'x' || text[i + 1] == 'X')
+                            && _is_hex(text[i + 2])){
+                        for(end = i + 3; end < n && _is_hex(text[end]); end++);
+                        val = number_hexadecimal(text + i + 2, end - i - 2);
+                    }
+                    else{
+                        end = _decimal_end(text, i, n);
+                        val = number_decimal(text + i, end - i);
+                    }
+                    if((status = _add_token(b, NUM, end, NULL, 0)) == 0)
+                        b->tokens[b->n_tokens - 1].val = val;
+                }
+                else
+                    status = _add_token(b, PIPELINE_ERROR, end, text + i, 1);
+        }
+        i = end;
+    }
+
+    return status;
+}
+
+// Adds a token to a block, with a copy of its text if it has one
+int _add_token(_block *b, int token, size_t end, const char *text, size_t length){
+    if(b->n_tokens == b->tokens_size){
+        _token *tokens = realloc(b->tokens, 2 * b->tokens_size * sizeof(_token));
+        if(tokens == NULL)
+            return -1;
+        b->tokens = tokens;
+        b->tokens_size *= 2;
+    }
+    _token *t = &b->tokens[b->n_tokens];
+
+    if(text != NULL){
+        if(b->texts_length + length + 1 > b->texts_size){
+            size_t size = 2 * b->texts_size;
+            while(b->texts_length + length + 1 > size)
+                size *= 2;
+            char *texts = realloc(b->texts, size);
+            if(texts == NULL)
+                return -1;
+            b->texts = texts;
+            b->texts_size = size;
+        }
+        memcpy(b->texts + b->texts_length, text, length);
+        b->texts[b->texts_length + length] = '\0';
+        t->text = b->texts_length;
+        b->texts_length += length + 1;
+    }
+    else
+        t->text = 0;
+
+    t->token = token;
+    t->end = (uint32_t)end;
+    b->n_tokens++;
+    return 0;
+}
+
+// Returns the end of the string literal that begins on the position i
+// (after its closing quote), or i if it isn't closed on its line. A quote
+// after a '\' can be part of it, so it ends on the last quote until the
+// first one without it
+size_t _string_end(const char *text, size_t i, size_t n){
+    size_t j, end = i;
+
+    for(j = i + 1; j < n && text[j] != '\n'; j++){
+        if(text[j] == '"'){
+            end = j + 1;
+            if(text[j - 1] != '\\')
+                break;
+        }
+    }
+    return end;
+}
+
+// Returns the end of the decimal literal that begins on the position i:
+// an integer without leading zeros, a fraction and an exponent
+size_t _decimal_end(const char *text, size_t i, size_t n){
+    size_t end = i + 1, j;
+
+    if(text[i] != '0'){
+        while(end < n && _is_digit(text[end]))
+            end++;
+    }
+    if(end + 1 < n && text[end] == '.' && _is_digit(text[end + 1])){
+        for(end += 2; end < n && _is_digit(text[end]); end++);
+    }
+    if(end < n && (text[end] == 'e' || text[end] == 'E')){
+        j = end + 1;
+        if(j < n && (text[j] == '+' || text[j] == '-'))
+            j++;
+        if(j < n && _is_digit(text[j])){
+            if(text[j++] != '0'){
+                while(j < n && _is_digit(text[j]))
+                    j++;
+            }
+            end = j;
+        }
+    }
+    return end;
+}
+
+int _is_id(char c, int first){
+    return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (!first && _is_digit(c));
+}
+
+int _is_digit(char c){
+    return c >= '0' && c <= '9';
+}
+
+int _is_hex(char c){
+    return _is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+void _free(pipeline *p){
+    int i;
+
+    for(i = 0; i < PIPELINE_BLOCKS; i++){
+        free(p->blocks[i].tokens);
+        free(p->blocks[i].texts);
+    }
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->changed);
+    free(p);
+}
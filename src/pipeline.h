@@ -0,0 +1,105 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: pipeline.h
+ * Definitions of the pipelined reading of the
+ * loaded files: a thread reads the file and
+ * another one scans its tokens, while the
+ * analyzer runs the previous lines
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Smallest file read by a pipeline: the smaller ones aren't worth the threads */
+#define PIPELINE_MIN_SIZE ((size_t)64 << 10)
+
+/** Tokens that aren't lexical components of the sintactic analyzer **/
+#define PIPELINE_END    (-1)    // End of the file
+#define PIPELINE_ID     (-2)    // Identifier, whose component depends on the symbol table
+#define PIPELINE_ERROR  (-3)    // Unexpected symbol
+#define PIPELINE_SPACE  (-4)    // Spaces at the beginning of a line (they
+                                // are only counted for the lines of the errors)
+
+/** Token scanned by a pipeline **/
+typedef struct {
+    int token;          // NUM, STRING, a character or PIPELINE_*
+    uint32_t end;       // Position after it, from the beginning of its block
+    union {
+        double val;         // Value of NUM
+        const char *text;   // Text of PIPELINE_ID, PIPELINE_ERROR and STRING
+                            // (without the quotes), ended with '\0'
+    };
+} pipeline_token;
+
+/** Pipeline of a file **/
+// Struct pipeline is defined on pipeline.c and it's transparent to the user
+typedef struct pipeline pipeline;
+
+/**
+ * Enables or disables the pipelines of the next loaded files
+ *
+ * @param enabled: 1 to read the large files with a pipeline (default) or
+ * 0 to read them on the thread of the analyzer
+ */
+void pipeline_set_enabled(int enabled);
+
+/**
+ * Returns if the pipelines are enabled
+ *
+ * @return 1 if they are enabled or 0 otherwise
+ */
+int pipeline_get_enabled();
+
+/**
+ * Starts the threads that read a file mapped on memory and scan its tokens,
+ * with the same rules as the lexical analyzer. They take two workers of the
+ * thread pool until the pipeline is freed. The file must remain mapped
+ * until the pipeline is freed
+ *
+ * @param text: Contents of the file
+ * @param size: Number of characters of the file
+ * @param offset: Position of the text on the file (-1 if it begins with
+ * the '\n' added before the file)
+ * @return The new pipeline or NULL if there was an error or the pool has
+ * not two free workers
+ */
+pipeline* pipeline_new(const char *text, size_t size, long offset);
+
+/**
+ * Returns the next token of a file, waiting for it if it isn't scanned yet.
+ * The token is valid until the next call
+ *
+ * @param p: The pipeline
+ * @return The token (PIPELINE_END after the last one)
+ */
+const pipeline_token* pipeline_next(pipeline *p);
+
+/**
+ * Returns the position of the file after the last token returned
+ *
+ * @param p: The pipeline
+ * @return The position (the offset of pipeline_new() before the first token)
+ */
+long pipeline_offset(const pipeline *p);
+
+/**
+ * Stops the threads of a pipeline, even before the end of its file, and
+ * frees its memory
+ *
+ * @param p: The pipeline
+ */
+void pipeline_free(pipeline *p);
+
+#endif /* PIPELINE_H */
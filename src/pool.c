@@ -0,0 +1,363 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: pool.c
+ * Implementation of the thread pool defined
+ * on the header file pool.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#include "pool.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/** Worker of the pool **/
+// The deque of a worker is the range of tasks [begin, end): the owner
+// takes tasks from the beginning and thieves take halves from the end
+typedef struct {
+    pthread_mutex_t lock;
+    size_t begin, end;      // Tasks still in the deque
+    pool_stats stats;       // Utilization counters
+    char pad[64];           // Keeps the workers on different cache lines
+} _worker;
+
+/** State of the pool **/
+static struct {
+    unsigned n_threads;         // Number of workers (0 until the first use)
+    unsigned n_workers;         // Workers running (0 if not created)
+    _worker *workers;
+    pthread_t *threads;
+    pthread_mutex_t lock;       // Protects the fields below
+    pthread_cond_t start;       // Signals a new job or the end of the pool
+    pthread_cond_t done;        // Signals that a worker finished a job
+    pthread_mutex_t run_lock;   // Held while a job is running
+    unsigned long generation;   // Number of the current job
+    unsigned long first;        // Number of the job when the pool was created
+    unsigned active;            // Workers (except the 0) still in the job
+    unsigned job_workers;       // Workers that take part in the current job
+    unsigned spawned;           // Workers taken by pool_spawn()
+    int quit;                   // 1 if the workers must finish
+    pool_task task;             // Task of the current job
+    void *arg;                  // Argument of the current job
+    struct timespec created;    // Moment when the pool was created
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .run_lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/* 1 on the threads that are running a task of the pool */
+static __thread int in_pool = 0;
+
+
+/** Declaration of private functions **/
+int _pool_start();
+void* _pool_thread(void *param);
+void _pool_work(unsigned id);
+int _pool_pop(_worker *w, size_t *task);
+int _pool_steal(unsigned id);
+double _elapsed(const struct timespec *from);
+
+/** PUBLIC FUNCTIONS: Defined on pool.h **/
+
+void pool_set_threads(unsigned n){
+    if(n == 0){
+        // One worker per available processor
+        long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n = (n_cpus > 0) ? (unsigned)n_cpus : 1;
+    }
+    if(n > POOL_MAX_THREADS)
+        n = POOL_MAX_THREADS;
+
+    // The workers are created again with the new size on the next use
+    if(n != pool.n_threads)
+        pool_free();
+    pool.n_threads = n;
+}
+
+unsigned pool_get_threads(){
+    if(pool.n_threads == 0){
+        char *env = getenv(POOL_THREADS_ENV), *end;
+        unsigned long n = 0;
+        if(env != NULL){
+            n = strtoul(env, &end, 10);
+            if(*env == '\0' || *end != '\0')
+                n = 0;
+        }
+        pool_set_threads(n > POOL_MAX_THREADS ? POOL_MAX_THREADS : (unsigned)n);
+    }
+    return pool.n_threads;
+}
+
+void pool_run(size_t n_tasks, pool_task task, void *arg){
+    size_t i;
+
+    // Small jobs, jobs inside a task and jobs while another is running
+    // are run on the calling thread
+    if(n_tasks == 0)
+        return;
+    if(n_tasks == 1 || pool_get_threads() == 1 || in_pool
+            || pthread_mutex_trylock(&pool.run_lock) != 0){
+        for(i = 0; i < n_tasks; i++)
+            task(arg, i, 0);
+        return;
+    }
+
+    if(pool.n_workers == 0 && _pool_start() == -1){
+        pthread_mutex_unlock(&pool.run_lock);
+        for(i = 0; i < n_tasks; i++)
+            task(arg, i, 0);
+        return;
+    }
+
+    // The workers taken by pool_spawn() leave the last ones without work
+    unsigned id, n;
+    pthread_mutex_lock(&pool.lock);
+    n = (pool.spawned < pool.n_workers) ? pool.n_workers - pool.spawned : 1;
+    if(n == 1){
+        pthread_mutex_unlock(&pool.lock);
+        pthread_mutex_unlock(&pool.run_lock);
+        for(i = 0; i < n_tasks; i++)
+            task(arg, i, 0);
+        return;
+    }
+
+    // Every worker begins with a contiguous part of the tasks
+    for(id = 0; id < pool.n_workers; id++){
+        pool.workers[id].begin = (id < n) ? n_tasks * id / n : 0;
+        pool.workers[id].end = (id < n) ? n_tasks * (id + 1) / n : 0;
+    }
+    pool.task = task;
+    pool.arg = arg;
+    pool.job_workers = n;
+    pool.active = pool.n_workers - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    _pool_work(0);
+
+    // The job ends when no worker is running any task
+    pthread_mutex_lock(&pool.lock);
+    while(pool.active > 0)
+        pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool.run_lock);
+}
+
+int pool_spawn(pthread_t *thread, void *(*start)(void *), void *arg){
+    unsigned n = pool_get_threads();
+
+    pthread_mutex_lock(&pool.lock);
+    if(pool.spawned + 1 >= n){
+        pthread_mutex_unlock(&pool.lock);
+        return -1;
+    }
+    pool.spawned++;
+    pthread_mutex_unlock(&pool.lock);
+
+    if(pthread_create(thread, NULL, start, arg) != 0){
+        pthread_mutex_lock(&pool.lock);
+        pool.spawned--;
+        pthread_mutex_unlock(&pool.lock);
+        return -1;
+    }
+    return 0;
+}
+
+void pool_join(pthread_t thread){
+    pthread_join(thread, NULL);
+
+    pthread_mutex_lock(&pool.lock);
+    pool.spawned--;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+int pool_get_stats(unsigned worker, pool_stats *stats){
+    if(worker >= pool.n_workers)
+        return -1;
+
+    pthread_mutex_lock(&pool.workers[worker].lock);
+    *stats = pool.workers[worker].stats;
+    pthread_mutex_unlock(&pool.workers[worker].lock);
+    return 0;
+}
+
+double pool_get_uptime(){
+    return (pool.n_workers > 0) ? _elapsed(&pool.created) : 0;
+}
+
+void pool_free(){
+    unsigned i;
+
+    if(pool.n_workers == 0)
+        return;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = 1;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    for(i = 1; i < pool.n_workers; i++)
+        pthread_join(pool.threads[i], NULL);
+    for(i = 0; i < pool.n_workers; i++)
+        pthread_mutex_destroy(&pool.workers[i].lock);
+
+    free(pool.workers);
+    free(pool.threads);
+    pool.workers = NULL;
+    pool.threads = NULL;
+    pool.n_workers = 0;
+    pool.quit = 0;
+}
+
+
+/** Implementation of private functions **/
+
+int _pool_start(){
+    unsigned i, n = pool_get_threads();
+
+    pool.workers = calloc(n, sizeof(_worker));
+    pool.threads = malloc(n * sizeof(pthread_t));
+    if(pool.workers == NULL || pool.threads == NULL){
+        free(pool.workers);
+        free(pool.threads);
+        return -1;
+    }
+    for(i = 0; i < n; i++)
+        pthread_mutex_init(&pool.workers[i].lock, NULL);
+
+    // The worker 0 is the thread that calls pool_run()
+    pool.first = pool.generation;
+    pool.n_workers = 1;
+    for(i = 1; i < n; i++){
+        if(pthread_create(&pool.threads[i], NULL, _pool_thread,
+                (void *)(size_t)i) != 0)
+            break;
+        pool.n_workers++;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &pool.created);
+    return 0;
+}
+
+void* _pool_thread(void *param){
+    unsigned id = (unsigned)(size_t)param;
+    unsigned long seen = pool.first;
+
+    in_pool = 1;
+    pthread_mutex_lock(&pool.lock);
+    for(;;){
+        while(!pool.quit && pool.generation == seen)
+            pthread_cond_wait(&pool.start, &pool.lock);
+        if(pool.quit)
+            break;
+        seen = pool.generation;
+        int works = (id < pool.job_workers);
+        pthread_mutex_unlock(&pool.lock);
+
+        if(works)
+            _pool_work(id);
+
+        pthread_mutex_lock(&pool.lock);
+        if(--pool.active == 0)
+            pthread_cond_signal(&pool.done);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    return NULL;
+}
+
+void _pool_work(unsigned id){
+    _worker *w = &pool.workers[id];
+    unsigned long tasks = 0, steals = 0;
+    struct timespec begin;
+    size_t task;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    in_pool = 1;
+
+    // Runs its own tasks and then steals until every deque is empty
+    for(;;){
+        while(_pool_pop(w, &task) == 0){
+            pool.task(pool.arg, task, id);
+            tasks++;
+        }
+        if(_pool_steal(id) == -1)
+            break;
+        steals++;
+    }
+
+    in_pool = (id != 0);
+    double busy = _elapsed(&begin);
+
+    pthread_mutex_lock(&w->lock);
+    w->stats.tasks += tasks;
+    w->stats.steals += steals;
+    w->stats.jobs++;
+    w->stats.busy += busy;
+    pthread_mutex_unlock(&w->lock);
+}
+
+int _pool_pop(_worker *w, size_t *task){
+    int status = -1;
+
+    pthread_mutex_lock(&w->lock);
+    if(w->begin < w->end){
+        *task = w->begin++;
+        status = 0;
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    return status;
+}
+
+int _pool_steal(unsigned id){
+    unsigned i;
+    _worker *w = &pool.workers[id];
+
+    // Looks for work on the other deques, beginning by the next worker
+    for(i = 1; i < pool.job_workers; i++){
+        _worker *victim = &pool.workers[(id + i) % pool.job_workers];
+        size_t begin = 0, end = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        if(victim->begin < victim->end){
+            // Takes the second half of its remaining tasks
+            size_t half = (victim->end - victim->begin + 1) / 2;
+            end = victim->end;
+            begin = end - half;
+            victim->end = begin;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if(begin < end){
+            pthread_mutex_lock(&w->lock);
+            w->begin = begin;
+            w->end = end;
+            pthread_mutex_unlock(&w->lock);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+double _elapsed(const struct timespec *from){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - from->tv_sec) + (now.tv_nsec - from->tv_nsec) / 1e9;
+}
@@ -0,0 +1,121 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: pool.h
+ * Definitions of the thread pool shared by
+ * all the parallel operations. Each worker
+ * has its own deque of tasks and steals from
+ * the others when it runs out of work
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+/* Maximum number of workers of the pool */
+#define POOL_MAX_THREADS 256
+
+/* Environment variable with the default number of workers */
+#define POOL_THREADS_ENV "FNM_THREADS"
+
+/**
+ * Task run by the pool
+ *
+ * @param arg: The argument passed to pool_run()
+ * @param task: Number of the task (from 0 to n_tasks - 1)
+ * @param worker: Number of the worker running the task (from 0 to
+ * pool_get_threads() - 1). It can be used to index per worker buffers
+ */
+typedef void (*pool_task)(void *arg, size_t task, unsigned worker);
+
+/** Utilization counters of a worker **/
+typedef struct {
+    unsigned long tasks;    // Tasks run by the worker
+    unsigned long steals;   // Times it took tasks from another worker
+    unsigned long jobs;     // Calls to pool_run() it took part in
+    double busy;            // Seconds spent running tasks
+} pool_stats;
+
+/**
+ * Sets the number of workers of the pool. If the pool is already
+ * running, it's stopped and created again on the next use
+ *
+ * @param n: Number of workers (0 to use one per available processor)
+ */
+void pool_set_threads(unsigned n);
+
+/**
+ * Returns the number of workers of the pool. Until pool_set_threads() is
+ * called, it's taken from the environment variable POOL_THREADS_ENV or,
+ * if it's not defined, one per available processor
+ *
+ * @return The number of workers
+ */
+unsigned pool_get_threads();
+
+/**
+ * Runs a set of independent tasks on the pool and waits for all of them.
+ * The calling thread works as the worker 0, and the other workers are
+ * created on the first call. A call made from inside a task runs all
+ * its tasks on the calling thread
+ *
+ * @param n_tasks: Number of tasks
+ * @param task: Function that runs each task
+ * @param arg: Argument passed to every task
+ */
+void pool_run(size_t n_tasks, pool_task task, void *arg);
+
+/**
+ * Starts a thread that runs next to the main thread for a long time (like
+ * the stages that read a file), taking one of the workers of the pool, so
+ * that the threads running never exceed pool_get_threads(). While it runs,
+ * the jobs of pool_run() use one worker less
+ *
+ * @param thread: Place to store the thread
+ * @param start: Function run by the thread
+ * @param arg: Argument passed to the function
+ * @return 0 if everything went well or -1 if there are no workers left
+ * (the calling thread always keeps one) or the thread couldn't be created
+ */
+int pool_spawn(pthread_t *thread, void *(*start)(void *), void *arg);
+
+/**
+ * Waits for a thread started by pool_spawn() to finish, and gives its
+ * worker back to the pool
+ *
+ * @param thread: The thread
+ */
+void pool_join(pthread_t thread);
+
+/**
+ * Gets the utilization counters of a worker since the pool was created
+ *
+ * @param worker: Number of the worker
+ * @param stats: Place to store the counters
+ * @return 0 if everything went well or -1 if the worker doesn't exist
+ */
+int pool_get_stats(unsigned worker, pool_stats *stats);
+
+/**
+ * Returns the time since the pool was created
+ *
+ * @return The number of seconds (0 if the pool is not running)
+ */
+double pool_get_uptime();
+
+/**
+ * Stops the workers of the pool and frees its memory
+ */
+void pool_free();
+
+#endif /* POOL_H */
@@ -0,0 +1,222 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: reduce.c
+ * Implementation of the reduction functions
+ * defined on the header file reduce.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#include "reduce.h"
+
+#include <stdlib.h>
+#include <math.h>
+#include "sintactic.tab.h"
+#include "pool.h"
+
+
+/* List of predefined reductions */
+init_reductions list_reductions[] = {
+    {"sum", REDUCE_SUM},
+    {"prod", REDUCE_PROD},
+    {"min", REDUCE_MIN},
+    {"max", REDUCE_MAX},
+    {"mean", REDUCE_MEAN},
+    {0, 0} // Must end with two 0, following reduce_init() preconditions
+};
+
+/** Shared state of a reduction running on the thread pool **/
+typedef struct {
+    reduce_op op;           // The reduction
+    ast_node *node;         // The vector expression
+    size_t size;            // Number of elements of the expression
+    size_t height;          // Height of the expression tree
+    double *partial;        // Partial result of each chunk
+    double **blocks;        // Blocks of each worker (allocated on first use)
+    int status;             // 0 or -1 if some worker ran out of memory
+} _reduction;
+
+
+/** Declaration of private functions **/
+void _reduce_task(void *param, size_t chunk, unsigned worker);
+double _reduce_chunk(_reduction *r, size_t chunk, double *block, double *scratch);
+double _pairwise_sum(const double *x, size_t n);
+double _combine(reduce_op op, const double *partial, size_t n);
+
+/** PUBLIC FUNCTIONS: Defined on reduce.h **/
+
+void reduce_init(symbol_table *st, init_reductions reductions_list[]){
+    int i;
+    for(i = 0; reductions_list[i].fnct_name != 0; i++){
+        st_insert(st, reductions_list[i].fnct_name, REDUCE);
+        st_get_info_row(st, reductions_list[i].fnct_name)->value.op = reductions_list[i].op;
+    }
+}
+
+int reduce(reduce_op op, ast_node *node, double *result){
+    _reduction r;
+    r.op = op;
+    r.node = node;
+    r.size = node->size;
+    r.height = ast_height(node);
+    r.status = 0;
+
+    // Reductions of an empty vector
+    if(r.size == 0){
+        *result = reduce_constant(op, 0, 0);
+        return 0;
+    }
+
+    size_t i, n_chunks = (r.size + REDUCE_CHUNK_SIZE - 1) / REDUCE_CHUNK_SIZE;
+    unsigned n_workers = pool_get_threads();
+    r.partial = malloc(n_chunks * sizeof(double));
+    r.blocks = calloc(n_workers, sizeof(double *));
+    if(r.partial == NULL || r.blocks == NULL){
+        free(r.partial);
+        free(r.blocks);
+        return -1;
+    }
+
+    // Each chunk is a task of the thread pool, unless the expression
+    // calls functions that are not thread safe
+    if(ast_is_thread_safe(node))
+        pool_run(n_chunks, _reduce_task, &r);
+    else{
+        for(i = 0; i < n_chunks; i++)
+            _reduce_task(&r, i, 0);
+    }
+
+    if(r.status == 0){
+        *result = _combine(op, r.partial, n_chunks);
+        if(op == REDUCE_MEAN)
+            *result /= (double)r.size;
+    }
+
+    for(i = 0; i < n_workers; i++)
+        free(r.blocks[i]);
+    free(r.blocks);
+    free(r.partial);
+    return r.status;
+}
+
+double reduce_constant(reduce_op op, double num, size_t size){
+    switch(op){
+        case REDUCE_SUM:  return num * (double)size;
+        case REDUCE_PROD: return pow(num, (double)size);
+        default:          return (size > 0) ? num : NAN;
+    }
+}
+
+
+/** Implementation of private functions **/
+
+void _reduce_task(void *param, size_t chunk, unsigned worker){
+    _reduction *r = (_reduction *)param;
+
+    // One block for the elements and one per level of the tree
+    if(r->blocks[worker] == NULL){
+        r->blocks[worker] = aligned_alloc(VEC_ALIGNMENT, (r->height + 2) * AST_BLOCK_SIZE * sizeof(double));
+        if(r->blocks[worker] == NULL){
+            __atomic_store_n(&r->status, -1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+
+    double *block = r->blocks[worker];
+    r->partial[chunk] = _reduce_chunk(r, chunk, block, block + AST_BLOCK_SIZE);
+}
+
+FNM_TARGET_CLONES
+double _reduce_chunk(_reduction *r, size_t chunk, double *block, double *scratch){
+    size_t start = chunk * REDUCE_CHUNK_SIZE;
+    size_t end = start + REDUCE_CHUNK_SIZE;
+    if(end > r->size)
+        end = r->size;
+
+    double acc = (r->op == REDUCE_PROD) ? 1 : 0;
+    double comp = 0; // Compensation of the sum (Neumaier)
+    size_t i, pos;
+
+    for(pos = start; pos < end; pos += AST_BLOCK_SIZE){
+        size_t len = (end - pos < AST_BLOCK_SIZE) ? end - pos : AST_BLOCK_SIZE;
+        const double *x = ast_eval_block(r->node, pos, len, block, scratch);
+
+        switch(r->op){
+            case REDUCE_SUM:
+            case REDUCE_MEAN: {
+                // Pairwise sum inside the block, compensated between blocks
+                double y = _pairwise_sum(x, len);
+                double t = acc + y;
+                if(fabs(acc) >= fabs(y))
+                    comp += (acc - t) + y;
+                else
+                    comp += (y - t) + acc;
+                acc = t;
+                break;
+            }
+            case REDUCE_PROD:
+                for(i = 0; i < len; i++)
+                    acc *= x[i];
+                break;
+            case REDUCE_MIN:
+                if(pos == start)
+                    acc = x[0];
+                for(i = 0; i < len; i++)
+                    acc = (x[i] < acc || isnan(x[i])) ? x[i] : acc;
+                break;
+            case REDUCE_MAX:
+                if(pos == start)
+                    acc = x[0];
+                for(i = 0; i < len; i++)
+                    acc = (x[i] > acc || isnan(x[i])) ? x[i] : acc;
+                break;
+        }
+    }
+
+    return acc + comp;
+}
+
+FNM_TARGET_CLONES
+double _pairwise_sum(const double *x, size_t n){
+    size_t i;
+
+    if(n <= 16){
+        // Base case: eight independent accumulators
+        double s[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        for(i = 0; i + 8 <= n; i += 8){
+            s[0] += x[i];     s[1] += x[i + 1];
+            s[2] += x[i + 2]; s[3] += x[i + 3];
+            s[4] += x[i + 4]; s[5] += x[i + 5];
+            s[6] += x[i + 6]; s[7] += x[i + 7];
+        }
+        for(; i < n; i++)
+            s[0] += x[i];
+        return ((s[0] + s[1]) + (s[2] + s[3])) + ((s[4] + s[5]) + (s[6] + s[7]));
+    }
+
+    size_t half = (n / 2) & ~(size_t)7;
+    return _pairwise_sum(x, half) + _pairwise_sum(x + half, n - half);
+}
+
+double _combine(reduce_op op, const double *partial, size_t n){
+    // The partial results are combined as a balanced tree
+    if(n == 1)
+        return partial[0];
+
+    double x = _combine(op, partial, n / 2);
+    double y = _combine(op, partial + n / 2, n - n / 2);
+
+    switch(op){
+        case REDUCE_PROD: return x * y;
+        case REDUCE_MIN:  return (y < x || isnan(y)) ? y : x;
+        case REDUCE_MAX:  return (y > x || isnan(y)) ? y : x;
+        default:          return x + y;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: reduce.h
+ * Definitions of the reduction functions
+ * (sum, prod, min, max and mean) that split
+ * the elements of a vector expression across
+ * the workers of the thread pool
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include "ST.h"
+#include "AST.h"
+
+/* Number of elements of each chunk of a reduction */
+// The chunks don't depend on the number of threads and their partial
+// results are always combined in the same order, so the result of a
+// reduction is the same regardless of the number of threads
+#define REDUCE_CHUNK_SIZE (8 * AST_BLOCK_SIZE)
+
+/** Available reductions **/
+typedef enum {
+    REDUCE_SUM,     // Sum of the elements (compensated)
+    REDUCE_PROD,    // Product of the elements
+    REDUCE_MIN,     // Minimum element
+    REDUCE_MAX,     // Maximum element
+    REDUCE_MEAN     // Arithmetic mean of the elements (compensated)
+} reduce_op;
+
+typedef struct {
+    char *fnct_name;
+    reduce_op op;
+} init_reductions;
+
+/* List of predefined reductions */
+extern init_reductions list_reductions[];
+
+/**
+ * Adds the predefined reductions to the symbol table
+ *
+ * @param st: Pointer to the symbol table
+ * @param reductions_list: List of reduction names and identifiers.
+ * The last row must be all 0
+ */
+void reduce_init(symbol_table *st, init_reductions reductions_list[]);
+
+/**
+ * Computes a reduction over the elements of a resolved vector
+ * expression. The expression is evaluated block by block, so its
+ * elements are never stored
+ *
+ * @param op: The reduction
+ * @param node: The root of the vector expression
+ * @param result: Place to store the result of the reduction
+ * @return 0 if everything went well or -1 if there was not enough memory
+ */
+int reduce(reduce_op op, ast_node *node, double *result);
+
+/**
+ * Computes a reduction over a vector whose elements are all the same
+ *
+ * @param op: The reduction
+ * @param num: The value of every element
+ * @param size: The number of elements
+ * @return The result of the reduction
+ */
+double reduce_constant(reduce_op op, double num, size_t size);
+
+#endif /* REDUCE_H */
\ No newline at end of file
@@ -0,0 +1,339 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: schedule.c
+ * Implementation of the parallel execution of
+ * the lines of the loaded files, by levels of
+ * their graph of dependencies
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * The lines waiting to run are divided in levels: a line goes to the level
+ * after the last line it depends on, so the lines of a level don't depend
+ * on each other and they are evaluated at the same time. A line depends on
+ * a previous one that assigns a variable it uses (it must see the new
+ * value). A line that assigns a variable can share the level of the
+ * previous lines that use or assign it, because the values are only
+ * assigned once the whole level has been evaluated, and in the order of
+ * the lines. The lines that call a function without FNM_MATH (like the
+ * random numbers) never go to a level before the previous ones, and they
+ * are evaluated on the calling thread in their order, so their calls are
+ * the same as running the lines one by one.
+ *
+ * The values to print are kept until the end, when every line is finished
+ * in its order. An echoed assignment keeps a copy of the value, since a
+ * later line of its level may assign the variable again.
+ */
+
+#include "schedule.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pool.h"
+#include "vector.h"
+#include "../lib/fnm_plugin.h"
+
+
+/* Initial number of lines and variables of the queue */
+#define LINES_INITIAL_SIZE 64
+#define READS_INITIAL_SIZE 256
+
+/** Line of the queue, with its dependencies **/
+typedef struct {
+    schedule_line line;
+    size_t first_read;      // Its variables on the list of reads
+    size_t n_reads;
+    int ordered;            // 1 if it calls functions without FNM_MATH
+    size_t level;
+} _line;
+
+/** Levels of a variable on the table of dependencies **/
+// Both levels are counted from 1, and they are 0 if there is none
+typedef struct {
+    const info_row *row;    // NULL if the slot is empty
+    size_t write;           // Level of its last assignment
+    size_t read;            // Last level that uses it
+} _dependency;
+
+/** Lines of a level evaluated by the thread pool **/
+typedef struct {
+    _line **lines;
+} _level;
+
+/* 1 if the lines of the loaded files run in parallel */
+static int enabled = 0;
+
+/* Lines waiting to run */
+static _line *lines = NULL;
+static size_t n_lines = 0, lines_size = 0;
+
+/* Variables used by the lines waiting */
+static const info_row **reads = NULL;
+static size_t n_reads = 0, reads_size = 0;
+
+
+/** Declaration of private functions **/
+int _collect(ast_node *node, _line *line);
+int _add_read(_line *line, const info_row *row);
+_dependency* _dependency_of(_dependency *table, size_t mask, const info_row *row);
+size_t _levels();
+void _evaluate_line(_line *line);
+void _commit(_line *line, schedule_assign assign);
+void _level_task(void *param, size_t task, unsigned worker);
+
+/** PUBLIC FUNCTIONS: Defined on schedule.h **/
+
+void schedule_set_enabled(int value){
+    enabled = value;
+}
+
+int schedule_get_enabled(){
+    return enabled;
+}
+
+int schedule_add(ast_node *node, info_row *row, const char *file, unsigned long line, unsigned long number){
+    if(n_lines == lines_size){
+        size_t size = lines_size ? 2 * lines_size : LINES_INITIAL_SIZE;
+        _line *new_lines = realloc(lines, size * sizeof(_line));
+        if(new_lines == NULL)
+            return -1;
+        lines = new_lines;
+        lines_size = size;
+    }
+
+    _line *l = &lines[n_lines];
+    memset(l, 0, sizeof(_line));
+    l->first_read = n_reads;
+    if(_collect(node, l) == -1){
+        n_reads = l->first_read;
+        return -1;
+    }
+    l->line.node = node;
+    l->line.row = row;
+    l->line.file = file;
+    l->line.line = line;
+    l->line.number = number;
+    n_lines++;
+    return 0;
+}
+
+schedule_line* schedule_last(){
+    return n_lines ? &lines[n_lines - 1].line : NULL;
+}
+
+size_t schedule_pending(){
+    return n_lines;
+}
+
+void schedule_run(schedule_assign assign, schedule_finish finish){
+    size_t i, l, n_levels;
+
+    if(n_lines == 0)
+        return;
+
+    // The lines are sorted by their level, keeping their order in each one
+    n_levels = _levels();
+    _line **order = malloc(2 * n_lines * sizeof(_line *));
+    size_t *first = calloc(n_levels + 1, sizeof(size_t));
+    if(order == NULL || first == NULL){
+        // Without memory, the lines run one by one
+        for(i = 0; i < n_lines; i++){
+            _evaluate_line(&lines[i]);
+            _commit(&lines[i], assign);
+        }
+    }
+    else{
+        _line **tasks = order + n_lines;
+        for(i = 0; i < n_lines; i++)
+            first[lines[i].level + 1]++;
+        for(l = 0; l < n_levels; l++)
+            first[l + 1] += first[l];
+        for(i = 0; i < n_lines; i++)
+            order[first[lines[i].level]++] = &lines[i];
+        // Each level begins where the previous one ends
+        for(l = n_levels; l > 0; l--)
+            first[l] = first[l - 1];
+        first[0] = 0;
+
+        for(l = 0; l < n_levels; l++){
+            _line **level = &order[first[l]];
+            size_t n = first[l + 1] - first[l];
+
+            // The lines that can run at the same time are evaluated by the
+            // thread pool, and the ordered ones by this thread in their order
+            _level job = { tasks };
+            size_t n_tasks = 0;
+            for(i = 0; i < n; i++){
+                if(!level[i]->ordered)
+                    tasks[n_tasks++] = level[i];
+            }
+            pool_run(n_tasks, _level_task, &job);
+
+            // A line only shares its level with the later lines that assign
+            // its variables, so each one is assigned after the evaluation of
+            // the previous ones
+            for(i = 0; i < n; i++){
+                if(level[i]->ordered)
+                    _evaluate_line(level[i]);
+                _commit(level[i], assign);
+            }
+        }
+    }
+    free(order);
+    free(first);
+
+    for(i = 0; i < n_lines; i++){
+        schedule_line *line = &lines[i].line;
+        finish(line);
+        free(line->symbol);
+        vec_free(line->value.vec);
+    }
+    n_lines = 0;
+    n_reads = 0;
+}
+
+
+/** Implementation of private functions **/
+
+int _collect(ast_node *node, _line *line){
+    size_t i;
+
+    if(node == NULL)
+        return 0;
+    if(node->type == AST_VAR && _add_read(line, node->value.id) == -1)
+        return -1;
+    if(node->index != NULL && _add_read(line, node->index) == -1)
+        return -1;
+    if(node->type == AST_CALL && (node->value.id->flags & FNM_MATH) != FNM_MATH)
+        line->ordered = 1;
+
+    for(i = 0; i < node->n_items; i++){
+        if(_collect(node->items[i], line) == -1)
+            return -1;
+    }
+    if(_collect(node->left, line) == -1 || _collect(node->right, line) == -1)
+        return -1;
+    return 0;
+}
+
+int _add_read(_line *line, const info_row *row){
+    if(n_reads == reads_size){
+        size_t size = reads_size ? 2 * reads_size : READS_INITIAL_SIZE;
+        const info_row **new_reads = realloc(reads, size * sizeof(info_row *));
+        if(new_reads == NULL)
+            return -1;
+        reads = new_reads;
+        reads_size = size;
+    }
+
+    reads[n_reads++] = row;
+    line->n_reads++;
+    return 0;
+}
+
+_dependency* _dependency_of(_dependency *table, size_t mask, const info_row *row){
+    // Open addressing with linear probing
+    size_t slot = (size_t)(((uintptr_t)row >> 4) * 0x9E3779B97F4A7C15ULL) & mask;
+    while(table[slot].row != NULL && table[slot].row != row)
+        slot = (slot + 1) & mask;
+    table[slot].row = row;
+    return &table[slot];
+}
+
+size_t _levels(){
+    size_t i, j, size = 16, n_levels = 0, ordered = 0;
+
+    // At most one variable per read and per line
+    while(size < 2 * (n_reads + n_lines))
+        size *= 2;
+    _dependency *table = calloc(size, sizeof(_dependency));
+    if(table == NULL){
+        // Each line on its own level, like running them one by one
+        for(i = 0; i < n_lines; i++){
+            lines[i].level = i;
+            lines[i].ordered = 1;
+        }
+        return n_lines;
+    }
+
+    for(i = 0; i < n_lines; i++){
+        _line *line = &lines[i];
+        const info_row **used = &reads[line->first_read];
+        size_t level = line->ordered ? ordered : 0;
+
+        // After the lines that assign its variables
+        for(j = 0; j < line->n_reads; j++){
+            _dependency *d = _dependency_of(table, size - 1, used[j]);
+            if(d->write > level)
+                level = d->write;
+        }
+        // Not before the lines that use or assign its variable
+        _dependency *w = NULL;
+        if(line->line.row != NULL){
+            w = _dependency_of(table, size - 1, line->line.row);
+            if(w->write > level + 1)
+                level = w->write - 1;
+            if(w->read > level + 1)
+                level = w->read - 1;
+        }
+
+        line->level = level;
+        for(j = 0; j < line->n_reads; j++){
+            _dependency *d = _dependency_of(table, size - 1, used[j]);
+            if(d->read < level + 1)
+                d->read = level + 1;
+        }
+        if(w != NULL)
+            w->write = level + 1;
+        if(line->ordered)
+            ordered = level;
+        if(level + 1 > n_levels)
+            n_levels = level + 1;
+    }
+
+    free(table);
+    return n_levels;
+}
+
+void _evaluate_line(_line *l){
+    schedule_line *line = &l->line;
+    ast_error error;
+
+    line->status = ast_eval(line->node, &line->value, &error);
+    if(line->status == -1){
+        // The symbol may be on a buffer of the thread
+        line->error = error.info;
+        line->symbol = strdup(error.symbol);
+        line->error_row = error.row;
+    }
+    ast_free(line->node);
+    line->node = NULL;
+}
+
+void _commit(_line *l, schedule_assign assign){
+    schedule_line *line = &l->line;
+
+    if(line->row == NULL || line->status == -1)
+        return;
+
+    // The echoed value is kept, the variable may be assigned again
+    ast_value value = line->value;
+    line->value.vec = NULL;
+    if(line->echo && value.vec != NULL)
+        line->value.vec = vec_copy(value.vec);
+    assign(line->row, &value);
+}
+
+void _level_task(void *param, size_t task, unsigned worker){
+    _level *job = (_level *)param;
+    _evaluate_line(job->lines[task]);
+}
@@ -0,0 +1,115 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: schedule.h
+ * Definitions of the parallel execution of
+ * the lines of the loaded files: the lines
+ * that don't depend on each other run at the
+ * same time on the thread pool
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stddef.h>
+#include "ST.h"
+#include "AST.h"
+
+/* Greatest number of lines waiting to run: the next one runs them first */
+#define SCHEDULE_MAX_LINES 4096
+
+/** Line waiting to run **/
+typedef struct {
+    ast_node *node;         // Its expression (NULL once it's evaluated)
+    info_row *row;          // Variable assigned (NULL if the value is printed)
+    int echo;               // 1 if the assigned value is also printed
+    const char *file;       // Location of the line
+    unsigned long line;
+    unsigned long number;   // Number given by the caller (see schedule_add())
+    int status;             // Result of the evaluation (0 or -1)
+    ast_value value;        // Value to print, if any
+    const char *error;      // Description of the error
+    char *symbol;           // Symbol that caused the error
+    info_row *error_row;    // Uninitialized variable found (NULL if there is none)
+} schedule_line;
+
+/**
+ * Function that stores the value of an assigned variable
+ *
+ * @param row: The variable
+ * @param value: Its new value, that becomes owned by the variable
+ */
+typedef void (*schedule_assign)(info_row *row, ast_value *value);
+
+/**
+ * Function called for each line once it has run
+ *
+ * @param line: The line, with its value to print or its error
+ */
+typedef void (*schedule_finish)(const schedule_line *line);
+
+/**
+ * Enables or disables the parallel execution of the loaded files
+ *
+ * @param enabled: 1 to run their lines in parallel or 0 to run them one
+ * by one (default)
+ */
+void schedule_set_enabled(int enabled);
+
+/**
+ * Returns if the parallel execution is enabled
+ *
+ * @return 1 if it's enabled or 0 otherwise
+ */
+int schedule_get_enabled();
+
+/**
+ * Adds a line to the lines waiting to run. Its dependencies are the
+ * variables of its expression and the assigned one, taken at this moment
+ *
+ * @param node: Expression of the line, that becomes owned by the line
+ * @param row: Variable assigned by the line (NULL if its value is printed)
+ * @param file: Path of its file, that must exist until it runs
+ * @param line: Number of the line on the file
+ * @param number: Number to identify the line on schedule_finish
+ * @return 0 if everything went well or -1 if it couldn't be added (the
+ * expression isn't freed then)
+ */
+int schedule_add(ast_node *node, info_row *row, const char *file, unsigned long line, unsigned long number);
+
+/**
+ * Returns the last line added, while it waits to run
+ *
+ * @return The line or NULL if there are no lines waiting
+ */
+schedule_line* schedule_last();
+
+/**
+ * Returns the number of lines waiting to run
+ *
+ * @return The number of lines
+ */
+size_t schedule_pending();
+
+/**
+ * Runs all the lines waiting, with the same results as running them one
+ * by one. A line only waits for the previous ones that assign a variable
+ * it uses or that use or assign its variable, and the lines that call
+ * functions without FNM_MATH run on the calling thread in their order.
+ * The variables are assigned and the lines are finished on the calling
+ * thread in the order of the lines
+ *
+ * @param assign: Function that stores the value of an assigned variable
+ * @param finish: Function called for each line, in their order
+ */
+void schedule_run(schedule_assign assign, schedule_finish finish);
+
+#endif /* SCHEDULE_H */
@@ -0,0 +1,738 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: script.c
+ * Implementation of the compiled files defined
+ * on the header file script.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * A compiled file is a header, the real path of its source file and five
+ * arrays: numbers, lines, identifiers, actions and texts. It's mapped on
+ * memory as it is, so it's fully checked when it's opened: the positions
+ * must be inside the arrays, and the actions of each line are simulated to
+ * check that they find the values they use (a file that was cut while it
+ * was written, or that comes from another program, is compiled again).
+ * The arrays are also checked with a hash, since a number or a string
+ * changed on the disk would still be valid but give other results.
+ */
+
+#define _GNU_SOURCE     // realpath() with NULL
+#include "script.h"
+#include "sintactic.tab.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Beginning of the compiled files */
+#define SCRIPT_MAGIC "FNMC"
+
+/* Initial number of elements of the arrays of a compiled file being built */
+#define WRITER_INITIAL_SIZE 256
+
+/* Constants of the hashes of the contents, paths, texts and numbers */
+#define HASH_SEED 0x9E3779B97F4A7C15ULL
+#define HASH_K1 0x87C37B91114253D5ULL
+#define HASH_K2 0x4CF5AD432745937FULL
+
+/** Header of a compiled file, followed by the path and the arrays **/
+typedef struct {
+    char magic[4];          // SCRIPT_MAGIC
+    uint32_t version;       // SCRIPT_VERSION
+    uint64_t size;          // Identification of the source file
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t hash;
+    uint64_t check;         // Hash of the arrays (see _check())
+    uint32_t path_size;     // Characters of the path, with '\0' and padding
+    uint32_t n_numbers;
+    uint32_t n_lines;
+    uint32_t n_symbols;
+    uint32_t n_actions;
+    uint32_t texts_size;
+} script_header;
+
+/** Table of positions, to store each text or number once **/
+typedef struct {
+    uint32_t *slots;        // SCRIPT_NONE if the slot is empty
+    size_t size;            // A power of 2
+    size_t n;
+} script_pool;
+
+/** Compiled file being built **/
+struct script_writer {
+    double *numbers;
+    size_t n_numbers, numbers_size;
+    script_line *lines;
+    size_t n_lines, lines_size;
+    script_symbol *symbols;
+    size_t n_symbols, symbols_size;
+    script_action *actions;
+    size_t n_actions, actions_size;
+    char *texts;
+    size_t texts_length, texts_size;
+    script_pool text_pool;
+    script_pool number_pool;
+    int broken;             // 1 if the memory ran out or a position doesn't fit
+                            // its 32 bits: it isn't saved
+};
+
+/** Values of the stack of a compiled line **/
+#define KIND_EXP    'e'     // Expression
+#define KIND_ITEMS  'i'     // Elements of a vector or arguments
+#define KIND_GRID   'g'     // Sweep
+#define KIND_ASSIGN 'a'     // Assigned variable
+
+/** Kinds of values of the actions **/
+#define VALUE_NONE      0
+#define VALUE_NUMBER    1
+#define VALUE_STRING    2
+#define VALUE_SYMBOL    3   // Identifier of the line, a variable
+
+/** Effect of an action on the stack and what it uses **/
+typedef struct {
+    const char *pops;   // Values taken from the stack, from the bottom
+    char push;          // Value left on the stack (0 if it ends the line)
+    int lc[2];          // Lexical components of its identifier (0 if none)
+    int value;          // Kind of its value
+} script_effect;
+
+static const script_effect effects[SCRIPT_OPS] = {
+    [SCRIPT_NUM]                = {"",     KIND_EXP,    {0, 0},             VALUE_NUMBER},
+    [SCRIPT_VAR]                = {"",     KIND_EXP,    {VAR, CONST},       VALUE_NONE},
+    [SCRIPT_CALL]               = {"i",    KIND_EXP,    {FNCT, 0},          VALUE_NONE},
+    [SCRIPT_REDUCE]             = {"e",    KIND_EXP,    {REDUCE, 0},        VALUE_NONE},
+    [SCRIPT_SERIES]             = {"eee",  KIND_EXP,    {REDUCE, 0},        VALUE_SYMBOL},
+    [SCRIPT_EVAL_SWEEP]         = {"g",    KIND_EXP,    {0, 0},             VALUE_NONE},
+    [SCRIPT_OP]                 = {"ee",   KIND_EXP,    {0, 0},             VALUE_NONE},
+    [SCRIPT_LIST]               = {"",     KIND_EXP,    {0, 0},             VALUE_NONE},
+    [SCRIPT_VECTOR]             = {"i",    KIND_EXP,    {0, 0},             VALUE_NONE},
+    [SCRIPT_ITEMS]              = {"e",    KIND_ITEMS,  {0, 0},             VALUE_NONE},
+    [SCRIPT_APPEND]             = {"ie",   KIND_ITEMS,  {0, 0},             VALUE_NONE},
+    [SCRIPT_SWEEP]              = {"eeee", KIND_GRID,   {VAR, 0},           VALUE_NONE},
+    [SCRIPT_SWEEP_APPEND]       = {"geee", KIND_GRID,   {VAR, 0},           VALUE_NONE},
+    [SCRIPT_ASSIGN]             = {"e",    KIND_ASSIGN, {VAR, 0},           VALUE_NONE},
+    [SCRIPT_ASSIGN_CHAIN]       = {"a",    KIND_ASSIGN, {VAR, 0},           VALUE_NONE},
+    [SCRIPT_CONST_ASSIGN]       = {"e",    KIND_ASSIGN, {CONST, 0},         VALUE_NONE},
+    [SCRIPT_CONST_ASSIGN_CHAIN] = {"a",    KIND_ASSIGN, {CONST, 0},         VALUE_NONE},
+    [SCRIPT_COMMAND]            = {"",     0,           {COMMAND, 0},       VALUE_NONE},
+    [SCRIPT_COMMAND_P]          = {"",     0,           {COMMAND_P, 0},     VALUE_STRING},
+    [SCRIPT_COMMAND_2P]         = {"",     0,           {COMMAND_2P, 0},    VALUE_STRING},
+    [SCRIPT_COMMAND_N]          = {"e",    0,           {COMMAND_N, 0},     VALUE_NONE},
+    [SCRIPT_SWEEP_WRITE]        = {"g",    0,           {0, 0},             VALUE_STRING},
+    [SCRIPT_ECHO]               = {"a",    0,           {0, 0},             VALUE_NONE},
+    [SCRIPT_PRINT]              = {"e",    0,           {0, 0},             VALUE_NONE}
+};
+
+/* Line being compiled (line_writer is NULL if it isn't compiled) */
+static script_writer *line_writer = NULL;
+static script_line line_current;
+
+
+/** Declaration of private functions **/
+uint64_t _hash(const void *data, size_t length, uint64_t seed);
+char* _script_file(const char *path, int create);
+int _reserve(void **array, size_t *size, size_t n, size_t item);
+int _pool_grow(script_writer *writer, script_pool *pool, int numbers);
+uint32_t _text(script_writer *writer, const char *text);
+uint32_t _number(script_writer *writer, double num);
+uint16_t _symbol(script_writer *writer, const char *name);
+int _write(int fd, const void *data, size_t size);
+uint64_t _check(const void *numbers, const void *lines, const void *symbols, const void *actions, const void *texts, const script_header *header);
+int _check_line(const script *code, const script_line *line, uint32_t n_numbers, uint32_t texts_size, char *stack);
+int _check_symbol(const script *code, const script_line *line, uint32_t symbol, int lc1, int lc2);
+
+/** PUBLIC FUNCTIONS: Defined on script.h **/
+
+int script_key_init(script_key *key, const char *file, uint64_t size, const struct timespec *mtime, const char *text){
+    key->path = realpath(file, NULL);
+    if(key->path == NULL)
+        return -1;
+
+    key->size = size;
+    key->mtime_sec = (int64_t)mtime->tv_sec;
+    key->mtime_nsec = (int64_t)mtime->tv_nsec;
+    key->hash = _hash(text, (size_t)size, HASH_SEED);
+    return 0;
+}
+
+void script_key_free(script_key *key){
+    free(key->path);
+    key->path = NULL;
+}
+
+script* script_open(const script_key *key){
+    struct stat info;
+    script_header header;
+    size_t i;
+
+    char *file = _script_file(key->path, 0);
+    if(file == NULL)
+        return NULL;
+    int fd = open(file, O_RDONLY);
+    free(file);
+    if(fd == -1)
+        return NULL;
+
+    // The header is read first, to map only the files of this source
+    if(fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(script_header)
+       || pread(fd, &header, sizeof(script_header), 0) != (ssize_t)sizeof(script_header)
+       || memcmp(header.magic, SCRIPT_MAGIC, 4) != 0 || header.version != SCRIPT_VERSION
+       || header.size != key->size || header.mtime_sec != key->mtime_sec
+       || header.mtime_nsec != key->mtime_nsec || header.hash != key->hash){
+        close(fd);
+        return NULL;
+    }
+
+    // Positions of the arrays, that end with the file
+    uint64_t numbers = sizeof(script_header) + (uint64_t)header.path_size;
+    uint64_t lines = numbers + (uint64_t)header.n_numbers * sizeof(double);
+    uint64_t symbols = lines + (uint64_t)header.n_lines * sizeof(script_line);
+    uint64_t actions = symbols + (uint64_t)header.n_symbols * sizeof(script_symbol);
+    uint64_t texts = actions + (uint64_t)header.n_actions * sizeof(script_action);
+    if(header.path_size % sizeof(double) != 0 || texts + header.texts_size != (uint64_t)info.st_size){
+        close(fd);
+        return NULL;
+    }
+
+    char *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping remains
+    if(map == MAP_FAILED)
+        return NULL;
+
+    // Another path with the same hash
+    size_t path_length = strlen(key->path);
+    if(path_length >= header.path_size || memcmp(map + sizeof(script_header), key->path, path_length + 1) != 0){
+        munmap(map, (size_t)info.st_size);
+        return NULL;
+    }
+
+    script *code = malloc(sizeof(script));
+    if(code == NULL){
+        munmap(map, (size_t)info.st_size);
+        return NULL;
+    }
+    code->numbers = (const double *)(map + numbers);
+    code->lines = (const script_line *)(map + lines);
+    code->n_lines = header.n_lines;
+    code->symbols = (const script_symbol *)(map + symbols);
+    code->actions = (const script_action *)(map + actions);
+    code->texts = map + texts;
+    code->map = map;
+    code->map_size = (size_t)info.st_size;
+
+    int valid = (_check(code->numbers, code->lines, code->symbols, code->actions, code->texts, &header) == header.check);
+
+    // All the texts end with '\0', so a position inside the array is valid
+    valid = valid && (header.texts_size == 0 || code->texts[header.texts_size - 1] == '\0');
+    for(i = 0; i < header.n_symbols && valid; i++){
+        switch(code->symbols[i].lc){
+            case VAR: case CONST: case FNCT: case COMMAND: case COMMAND_P:
+            case COMMAND_2P: case COMMAND_N: case REDUCE: case SWEEP:
+                valid = (code->symbols[i].name < header.texts_size);
+                break;
+            default:
+                valid = 0;
+        }
+    }
+
+    // Lines in order, inside the source file, and their actions
+    size_t max_actions = 0;
+    for(i = 0; i < code->n_lines && valid; i++){
+        const script_line *line = &code->lines[i];
+        valid = line->start < line->end && line->end <= key->size
+                && (i == 0 || line->start >= code->lines[i - 1].end)
+                && line->n_symbols <= SCRIPT_MAX_SYMBOLS
+                && (uint64_t)line->first_symbol + line->n_symbols <= header.n_symbols
+                && (uint64_t)line->first_action + line->n_actions <= header.n_actions;
+        if(line->n_actions > max_actions)
+            max_actions = line->n_actions;
+    }
+    char *stack = valid ? malloc(max_actions + 1) : NULL;
+    for(i = 0; i < code->n_lines && stack != NULL; i++){
+        if(_check_line(code, &code->lines[i], header.n_numbers, header.texts_size, stack) == -1)
+            break;
+    }
+    free(stack);
+    if(stack == NULL || i < code->n_lines){
+        script_close(code);
+        return NULL;
+    }
+
+    return code;
+}
+
+void script_close(script *code){
+    munmap(code->map, code->map_size);
+    free(code);
+}
+
+const char* script_text(const script *code, uint32_t position){
+    return code->texts + position;
+}
+
+script_writer* script_writer_new(){
+    return calloc(1, sizeof(script_writer));
+}
+
+int script_writer_save(script_writer *writer, const script_key *key){
+    script_header header;
+    char padding[sizeof(double)] = {0};
+
+    if(writer->broken || key->path == NULL)
+        return -1;
+
+    char *file = _script_file(key->path, 1);
+    if(file == NULL)
+        return -1;
+
+    // The file is written with another name and renamed, so a compiled
+    // file is never seen half written, even by other processes
+    char *temporary = malloc(strlen(file) + strlen(".XXXXXX") + 1);
+    if(temporary == NULL){
+        free(file);
+        return -1;
+    }
+    strcpy(temporary, file);
+    strcat(temporary, ".XXXXXX");
+    int fd = mkstemp(temporary);
+    if(fd == -1){
+        free(temporary);
+        free(file);
+        return -1;
+    }
+
+    size_t path_length = strlen(key->path) + 1;
+    memset(&header, 0, sizeof(script_header));
+    memcpy(header.magic, SCRIPT_MAGIC, 4);
+    header.version = SCRIPT_VERSION;
+    header.size = key->size;
+    header.mtime_sec = key->mtime_sec;
+    header.mtime_nsec = key->mtime_nsec;
+    header.hash = key->hash;
+    header.path_size = (uint32_t)((path_length + sizeof(double) - 1) / sizeof(double) * sizeof(double));
+    header.n_numbers = (uint32_t)writer->n_numbers;
+    header.n_lines = (uint32_t)writer->n_lines;
+    header.n_symbols = (uint32_t)writer->n_symbols;
+    header.n_actions = (uint32_t)writer->n_actions;
+    header.texts_size = (uint32_t)writer->texts_length;
+    header.check = _check(writer->numbers, writer->lines, writer->symbols, writer->actions, writer->texts, &header);
+
+    int status = _write(fd, &header, sizeof(script_header));
+    status |= _write(fd, key->path, path_length);
+    status |= _write(fd, padding, header.path_size - path_length);
+    status |= _write(fd, writer->numbers, writer->n_numbers * sizeof(double));
+    status |= _write(fd, writer->lines, writer->n_lines * sizeof(script_line));
+    status |= _write(fd, writer->symbols, writer->n_symbols * sizeof(script_symbol));
+    status |= _write(fd, writer->actions, writer->n_actions * sizeof(script_action));
+    status |= _write(fd, writer->texts, writer->texts_length);
+    if(close(fd) == -1)
+        status = -1;
+
+    if(status == 0 && rename(temporary, file) == 0){
+        free(temporary);
+        free(file);
+        return 0;
+    }
+    unlink(temporary);
+    free(temporary);
+    free(file);
+    return -1;
+}
+
+void script_writer_free(script_writer *writer){
+    if(line_writer == writer)
+        line_writer = NULL;
+
+    free(writer->numbers);
+    free(writer->lines);
+    free(writer->symbols);
+    free(writer->actions);
+    free(writer->texts);
+    free(writer->text_pool.slots);
+    free(writer->number_pool.slots);
+    free(writer);
+}
+
+void script_line_begin(script_writer *writer, size_t start){
+    line_writer = (writer != NULL && !writer->broken) ? writer : NULL;
+    if(line_writer == NULL)
+        return;
+    if(start > UINT32_MAX){
+        writer->broken = 1;
+        line_writer = NULL;
+        return;
+    }
+
+    line_current.start = (uint32_t)start;
+    line_current.first_symbol = (uint32_t)writer->n_symbols;
+    line_current.n_symbols = 0;
+    line_current.first_action = (uint32_t)writer->n_actions;
+    line_current.n_actions = 0;
+}
+
+void script_line_symbol(int lc, const char *name){
+    script_writer *writer = line_writer;
+
+    if(writer == NULL)
+        return;
+
+    // Each identifier is added once
+    uint32_t position = _text(writer, name);
+    if(_symbol(writer, name) != SCRIPT_NO_SYMBOL)
+        return;
+    if(line_current.n_symbols == SCRIPT_MAX_SYMBOLS
+       || _reserve((void **)&writer->symbols, &writer->symbols_size, writer->n_symbols, sizeof(script_symbol)) == -1){
+        script_line_fail();
+        return;
+    }
+    writer->symbols[writer->n_symbols].lc = (uint32_t)lc;
+    writer->symbols[writer->n_symbols].name = position;
+    writer->n_symbols++;
+    line_current.n_symbols++;
+}
+
+void script_line_fail(){
+    // What the line already added is removed
+    if(line_writer != NULL){
+        line_writer->n_symbols = line_current.first_symbol;
+        line_writer->n_actions = line_current.first_action;
+    }
+    line_writer = NULL;
+}
+
+void script_line_end(size_t end){
+    script_writer *writer = line_writer;
+
+    if(writer == NULL)
+        return;
+    if(end > UINT32_MAX)
+        writer->broken = 1;
+    if(writer->broken || _reserve((void **)&writer->lines, &writer->lines_size, writer->n_lines, sizeof(script_line)) == -1){
+        script_line_fail();
+        return;
+    }
+
+    line_current.end = (uint32_t)end;
+    line_current.n_actions = (uint32_t)writer->n_actions - line_current.first_action;
+    writer->lines[writer->n_lines++] = line_current;
+    line_writer = NULL;
+}
+
+void script_emit(script_op op, const char *name, const char *text, int type, double num){
+    script_writer *writer = line_writer;
+    script_action action = {(uint8_t)op, (uint8_t)type, SCRIPT_NO_SYMBOL, SCRIPT_NONE};
+
+    if(writer == NULL)
+        return;
+
+    // The identifiers are the ones of the line
+    if(name != NULL && (action.symbol = _symbol(writer, name)) == SCRIPT_NO_SYMBOL){
+        script_line_fail();
+        return;
+    }
+    if(op == SCRIPT_NUM)
+        action.value = _number(writer, num);
+    else if(op == SCRIPT_SERIES){
+        if((action.value = _symbol(writer, text)) == SCRIPT_NO_SYMBOL){
+            script_line_fail();
+            return;
+        }
+    }
+    else if(text != NULL)
+        action.value = _text(writer, text);
+
+    if(writer->broken || _reserve((void **)&writer->actions, &writer->actions_size, writer->n_actions, sizeof(script_action)) == -1){
+        script_line_fail();
+        return;
+    }
+    writer->actions[writer->n_actions++] = action;
+}
+
+
+/** Implementation of private functions **/
+
+uint64_t _hash(const void *data, size_t length, uint64_t seed){
+    const char *text = data;
+    uint64_t h = seed ^ (length * HASH_K1), word;
+    size_t i;
+
+    // 8 characters at a time
+    for(i = 0; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)){
+        memcpy(&word, text + i, sizeof(uint64_t));
+        h ^= word * HASH_K1;
+        h = ((h << 31) | (h >> 33)) * HASH_K2;
+    }
+    word = 0;
+    if(i < length)
+        memcpy(&word, text + i, length - i);
+    h ^= word * HASH_K1;
+
+    // Final mix, so every bit depends on all the characters
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+char* _script_file(const char *path, int create){
+    const char *base = getenv("XDG_CACHE_HOME"), *home = "";
+    char name[2 * sizeof(uint64_t) + sizeof(SCRIPT_EXTENSION)];
+
+    // $XDG_CACHE_HOME must be an absolute path, or else it's ignored
+    if(base == NULL || base[0] != '/'){
+        base = getenv("HOME");
+        home = "/.cache";
+        if(base == NULL || base[0] == '\0')
+            return NULL;
+    }
+
+    char *file = malloc(strlen(base) + strlen(home) + 1 + strlen(SCRIPT_FOLDER) + 1 + sizeof(name));
+    if(file == NULL)
+        return NULL;
+
+    // The folders are created before the first compiled file
+    sprintf(file, "%s%s", base, home);
+    if(create && mkdir(file, 0700) == -1 && errno != EEXIST){
+        free(file);
+        return NULL;
+    }
+    strcat(file, "/" SCRIPT_FOLDER);
+    if(create && mkdir(file, 0700) == -1 && errno != EEXIST){
+        free(file);
+        return NULL;
+    }
+
+    sprintf(name, "%016llx" SCRIPT_EXTENSION, (unsigned long long)_hash(path, strlen(path), HASH_K2));
+    strcat(file, "/");
+    strcat(file, name);
+    return file;
+}
+
+int _reserve(void **array, size_t *size, size_t n, size_t item){
+    if(n < *size)
+        return 0;
+
+    // The positions are stored on 32 bits
+    size_t new_size = *size ? 2 * *size : WRITER_INITIAL_SIZE;
+    if(n >= SCRIPT_NONE)
+        return -1;
+    void *new_array = realloc(*array, new_size * item);
+    if(new_array == NULL)
+        return -1;
+
+    *array = new_array;
+    *size = new_size;
+    return 0;
+}
+
+int _pool_grow(script_writer *writer, script_pool *pool, int numbers){
+    size_t i, size = pool->size ? 2 * pool->size : WRITER_INITIAL_SIZE;
+
+    uint32_t *slots = malloc(size * sizeof(uint32_t));
+    if(slots == NULL)
+        return -1;
+    memset(slots, 0xFF, size * sizeof(uint32_t));
+
+    for(i = 0; i < pool->size; i++){
+        uint32_t position = pool->slots[i];
+        if(position != SCRIPT_NONE){
+            uint64_t h;
+            if(numbers)
+                h = _hash(&writer->numbers[position], sizeof(double), HASH_SEED);
+            else
+                h = _hash(writer->texts + position, strlen(writer->texts + position), HASH_SEED);
+            size_t slot = h & (size - 1);
+            while(slots[slot] != SCRIPT_NONE)
+                slot = (slot + 1) & (size - 1);
+            slots[slot] = position;
+        }
+    }
+
+    free(pool->slots);
+    pool->slots = slots;
+    pool->size = size;
+    return 0;
+}
+
+uint32_t _text(script_writer *writer, const char *text){
+    script_pool *pool = &writer->text_pool;
+
+    // The table is kept at most half full
+    if(2 * (pool->n + 1) > pool->size && _pool_grow(writer, pool, 0) == -1){
+        writer->broken = 1;
+        return SCRIPT_NONE;
+    }
+
+    size_t length = strlen(text);
+    size_t slot = _hash(text, length, HASH_SEED) & (pool->size - 1);
+    while(pool->slots[slot] != SCRIPT_NONE){
+        if(strcmp(writer->texts + pool->slots[slot], text) == 0)
+            return pool->slots[slot];
+        slot = (slot + 1) & (pool->size - 1);
+    }
+
+    // New text
+    while(writer->texts_length + length + 1 > writer->texts_size){
+        if(_reserve((void **)&writer->texts, &writer->texts_size, writer->texts_length + length, sizeof(char)) == -1){
+            writer->broken = 1;
+            return SCRIPT_NONE;
+        }
+    }
+    uint32_t position = (uint32_t)writer->texts_length;
+    memcpy(writer->texts + position, text, length + 1);
+    writer->texts_length += length + 1;
+    pool->slots[slot] = position;
+    pool->n++;
+
+    return position;
+}
+
+uint32_t _number(script_writer *writer, double num){
+    script_pool *pool = &writer->number_pool;
+
+    if(2 * (pool->n + 1) > pool->size && _pool_grow(writer, pool, 1) == -1){
+        writer->broken = 1;
+        return SCRIPT_NONE;
+    }
+
+    // The numbers are compared by their bits (0 and -0 are different)
+    size_t slot = _hash(&num, sizeof(double), HASH_SEED) & (pool->size - 1);
+    while(pool->slots[slot] != SCRIPT_NONE){
+        if(memcmp(&writer->numbers[pool->slots[slot]], &num, sizeof(double)) == 0)
+            return pool->slots[slot];
+        slot = (slot + 1) & (pool->size - 1);
+    }
+
+    if(_reserve((void **)&writer->numbers, &writer->numbers_size, writer->n_numbers, sizeof(double)) == -1){
+        writer->broken = 1;
+        return SCRIPT_NONE;
+    }
+    uint32_t position = (uint32_t)writer->n_numbers++;
+    writer->numbers[position] = num;
+    pool->slots[slot] = position;
+    pool->n++;
+
+    return position;
+}
+
+uint16_t _symbol(script_writer *writer, const char *name){
+    uint32_t i, position = _text(writer, name);
+
+    // The texts are stored once, so the same name has the same position
+    for(i = 0; i < line_current.n_symbols; i++){
+        if(writer->symbols[line_current.first_symbol + i].name == position)
+            return (uint16_t)i;
+    }
+    return SCRIPT_NO_SYMBOL;
+}
+
+int _write(int fd, const void *data, size_t size){
+    const char *bytes = data;
+
+    while(size > 0){
+        ssize_t written = write(fd, bytes, size);
+        if(written == -1){
+            if(errno == EINTR)
+                continue;
+            return -1;
+        }
+        bytes += written;
+        size -= (size_t)written;
+    }
+    return 0;
+}
+
+uint64_t _check(const void *numbers, const void *lines, const void *symbols, const void *actions, const void *texts, const script_header *header){
+    uint64_t h = _hash(numbers, header->n_numbers * sizeof(double), HASH_K1);
+    h = _hash(lines, header->n_lines * sizeof(script_line), h);
+    h = _hash(symbols, header->n_symbols * sizeof(script_symbol), h);
+    h = _hash(actions, header->n_actions * sizeof(script_action), h);
+    return _hash(texts, header->texts_size, h);
+}
+
+int _check_line(const script *code, const script_line *line, uint32_t n_numbers, uint32_t texts_size, char *stack){
+    size_t i, top = 0;
+
+    for(i = 0; i < line->n_actions; i++){
+        const script_action *action = &code->actions[line->first_action + i];
+        if(action->op >= SCRIPT_OPS)
+            return -1;
+        const script_effect *effect = &effects[action->op];
+
+        // Its identifiers are the ones of the line, as when it was compiled
+        if(effect->lc[0] != 0){
+            if(_check_symbol(code, line, action->symbol, effect->lc[0], effect->lc[1]) == -1)
+                return -1;
+        }
+        else if(action->symbol != SCRIPT_NO_SYMBOL)
+            return -1;
+        switch(effect->value){
+            case VALUE_NUMBER:
+                if(action->value >= n_numbers)
+                    return -1;
+                break;
+            case VALUE_STRING:
+                if(action->value >= texts_size)
+                    return -1;
+                break;
+            case VALUE_SYMBOL:
+                if(_check_symbol(code, line, action->value, VAR, 0) == -1)
+                    return -1;
+                break;
+            default:
+                if(action->value != SCRIPT_NONE)
+                    return -1;
+        }
+
+        // The negation has a single operand
+        const char *pops = effect->pops;
+        if(action->op == SCRIPT_OP){
+            if(action->type == AST_NEG)
+                pops = "e";
+            else if(action->type != AST_RANGE && (action->type < AST_ADD || action->type > AST_POW))
+                return -1;
+        }
+        else if(action->type != 0)
+            return -1;
+
+        // The values it takes must be on the stack
+        size_t n = strlen(pops);
+        if(n > top || memcmp(&stack[top - n], pops, n) != 0)
+            return -1;
+        top -= n;
+        if(effect->push != 0)
+            stack[top++] = effect->push;
+        else if(top != 0 || i + 1 != line->n_actions)
+            return -1;  // The action of the line is the last one
+    }
+
+    // Nothing is left for the next line
+    return (top == 0) ? 0 : -1;
+}
+
+int _check_symbol(const script *code, const script_line *line, uint32_t symbol, int lc1, int lc2){
+    if(symbol >= line->n_symbols)
+        return -1;
+
+    uint32_t lc = code->symbols[line->first_symbol + symbol].lc;
+    if(lc == (uint32_t)lc1 || (lc2 != 0 && lc == (uint32_t)lc2))
+        return 0;
+    return -1;
+}
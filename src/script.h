@@ -0,0 +1,253 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: script.h
+ * Definitions of the compiled form of the
+ * loaded files (.fnmc), kept on disk to run
+ * them again without analyzing their text
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+/*
+ * A compiled file keeps, for each line of a loaded file that was recognized
+ * without errors, the actions of the rules that recognized it, in the order
+ * the sintactic analyzer ran them. The identifiers are kept by name, with
+ * their lexical component: a line is only run from its actions if they
+ * still have the same one (a library may have been included since), and
+ * otherwise its text is analyzed again, like the lines that weren't
+ * compiled. The lines are found by their position on the file, which is
+ * identified by its path, size, time of modification and contents.
+ */
+
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "ST.h"
+
+/* Version of the format. It changes with the tokens or the rules of the
+ * sintactic analyzer, so the files of older versions are compiled again */
+#define SCRIPT_VERSION 1
+
+/* Extension of the compiled files */
+#define SCRIPT_EXTENSION ".fnmc"
+
+/* Folder of the compiled files, inside $XDG_CACHE_HOME or ~/.cache */
+#define SCRIPT_FOLDER "FreeNoteMath"
+
+/* Value of the positions of the actions that don't have them */
+#define SCRIPT_NONE UINT32_MAX
+#define SCRIPT_NO_SYMBOL UINT16_MAX
+
+/* Greatest number of identifiers of a compiled line */
+#define SCRIPT_MAX_SYMBOLS (SCRIPT_NO_SYMBOL - 1)
+
+/** Actions of the compiled lines **/
+// Each one repeats the action of a rule of the sintactic analyzer
+typedef enum {
+    SCRIPT_NUM,                 // exp: NUM
+    SCRIPT_VAR,                 // exp: VAR | CONST
+    SCRIPT_CALL,                // exp: FNCT '(' items ')'
+    SCRIPT_REDUCE,              // exp: REDUCE '(' exp ')'
+    SCRIPT_SERIES,              // exp: REDUCE '(' VAR ',' exp ',' exp ',' exp ')'
+    SCRIPT_EVAL_SWEEP,          // exp: SWEEP '(' grid ')'
+    SCRIPT_OP,                  // exp: exp '+' exp | '-' exp | ...
+    SCRIPT_LIST,                // exp: '[' ']'
+    SCRIPT_VECTOR,              // exp: '[' items ']'
+    SCRIPT_ITEMS,               // items: exp
+    SCRIPT_APPEND,              // items: items ',' exp
+    SCRIPT_SWEEP,               // grid: exp ',' VAR ',' exp ',' exp ',' exp
+    SCRIPT_SWEEP_APPEND,        // grid: grid ',' VAR ',' exp ',' exp ',' exp
+    SCRIPT_ASSIGN,              // assign: VAR '=' exp
+    SCRIPT_ASSIGN_CHAIN,        // assign: VAR '=' assign
+    SCRIPT_CONST_ASSIGN,        // assign: CONST '=' exp
+    SCRIPT_CONST_ASSIGN_CHAIN,  // assign: CONST '=' assign
+    SCRIPT_COMMAND,             // command: COMMAND
+    SCRIPT_COMMAND_P,           // command: COMMAND_P '(' STRING ')'
+    SCRIPT_COMMAND_2P,          // command: COMMAND_2P '(' STRING ')'
+    SCRIPT_COMMAND_N,           // command: COMMAND_N '(' exp ')'
+    SCRIPT_SWEEP_WRITE,         // command: SWEEP '(' grid ',' STRING ')'
+    SCRIPT_ECHO,                // line: assign '\n'
+    SCRIPT_PRINT,               // line: exp '\n'
+    SCRIPT_OPS                  // Number of actions
+} script_op;
+
+/** Action of a compiled line **/
+typedef struct {
+    uint8_t op;         // The action (see script_op)
+    uint8_t type;       // Operator of SCRIPT_OP (see AST.h)
+    uint16_t symbol;    // Its identifier, among the ones of the line
+    uint32_t value;     // Position of its number or string, or second
+                        // identifier of SCRIPT_SERIES
+} script_action;
+
+/** Identifier of a compiled line **/
+typedef struct {
+    uint32_t lc;        // Its lexical component when the line was compiled
+    uint32_t name;      // Position of its name on the texts
+} script_symbol;
+
+/** Compiled line **/
+typedef struct {
+    uint32_t start;         // Position of its first character on the file
+    uint32_t end;           // Position after its '\n'
+    uint32_t first_symbol;
+    uint32_t n_symbols;
+    uint32_t first_action;
+    uint32_t n_actions;
+} script_line;
+
+/** Compiled file, mapped on memory **/
+typedef struct {
+    const script_line *lines;   // Sorted by their position
+    size_t n_lines;
+    const script_symbol *symbols;
+    const script_action *actions;
+    const double *numbers;
+    const char *texts;          // Names and strings, ended with '\0'
+    void *map;
+    size_t map_size;
+} script;
+
+/** Compiled line passed from the lexical analyzer to the sintactic one **/
+typedef struct {
+    const script *code;
+    const script_line *line;
+    info_row **rows;            // Its identifiers on the symbol table
+} script_run;
+
+/** Identification of the source file of a compiled file **/
+typedef struct {
+    char *path;             // Real path of the file
+    uint64_t size;
+    int64_t mtime_sec;      // Time of the last modification
+    int64_t mtime_nsec;
+    uint64_t hash;          // Hash of the contents
+} script_key;
+
+/** Compiled file being built **/
+// Struct script_writer is defined on script.c and it's transparent to the user
+typedef struct script_writer script_writer;
+
+/**
+ * Identifies a source file by its path, size, time of modification and
+ * contents
+ *
+ * @param key: Place to store the identification. It must be freed with
+ * script_key_free()
+ * @param file: Path of the file
+ * @param size: Size of the file
+ * @param mtime: Time of the last modification of the file
+ * @param text: Contents of the file, of size characters
+ * @return 0 if everything went well or -1 if there was an error
+ */
+int script_key_init(script_key *key, const char *file, uint64_t size, const struct timespec *mtime, const char *text);
+
+/**
+ * Frees the memory associated to the identification of a file
+ *
+ * @param key: The identification
+ */
+void script_key_free(script_key *key);
+
+/**
+ * Maps on memory the compiled form of a source file, if it exists and it
+ * was compiled from the same contents
+ *
+ * @param key: Identification of the source file
+ * @return The compiled file, that must be closed with script_close(), or
+ * NULL if there is none or it's not valid
+ */
+script* script_open(const script_key *key);
+
+/**
+ * Closes a compiled file
+ *
+ * @param code: The compiled file
+ */
+void script_close(script *code);
+
+/**
+ * Returns a name or string of a compiled file
+ *
+ * @param code: The compiled file
+ * @param position: Position of the text
+ * @return The text
+ */
+const char* script_text(const script *code, uint32_t position);
+
+/**
+ * Creates an empty compiled file
+ *
+ * @return The new compiled file or NULL if there was an error
+ */
+script_writer* script_writer_new();
+
+/**
+ * Writes a compiled file to disk, next to the rest of compiled files
+ *
+ * @param writer: The compiled file
+ * @param key: Identification of its source file
+ * @return 0 if everything went well or -1 if there was an error
+ */
+int script_writer_save(script_writer *writer, const script_key *key);
+
+/**
+ * Frees the memory associated to a compiled file being built
+ *
+ * @param writer: The compiled file
+ */
+void script_writer_free(script_writer *writer);
+
+/**
+ * Begins a line: its identifiers and actions are added to a compiled file
+ *
+ * @param writer: The compiled file, or NULL if the line isn't compiled
+ * @param start: Position of its first character on the source file. If
+ *        it doesn't fit 32 bits, the compiled file isn't saved
+ */
+void script_line_begin(script_writer *writer, size_t start);
+
+/**
+ * Adds an identifier to the current line, if it's being compiled
+ *
+ * @param lc: Its lexical component
+ * @param name: Its name
+ */
+void script_line_symbol(int lc, const char *name);
+
+/**
+ * Marks the current line as not compiled (it had errors, or its tokens come
+ * from several files). Its text is analyzed again when it's run
+ */
+void script_line_fail();
+
+/**
+ * Ends the current line. If it didn't fail, it's kept on its compiled file
+ *
+ * @param end: Position after its '\n' on the source file. If it doesn't
+ *        fit 32 bits, the compiled file isn't saved
+ */
+void script_line_end(size_t end);
+
+/**
+ * Adds an action to the current line, if it's being compiled
+ *
+ * @param op: The action
+ * @param name: Name of its identifier (NULL if it has none)
+ * @param text: Its string or second identifier (NULL if it has none)
+ * @param type: Operator of SCRIPT_OP
+ * @param num: Number of SCRIPT_NUM
+ */
+void script_emit(script_op op, const char *name, const char *text, int type, double num);
+
+#endif /* SCRIPT_H */
@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0.4"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,8 +66,8 @@
 
 
 
-/* Copy the first part of user declarations.  */
-#line 19 "sintactic.y" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 19 "sintactic.y"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -70,20 +75,59 @@
 #include <math.h>   // pow() and trigonometric functions are available by default
 #include "sintactic.tab.h"
 #include "ST.h"
+#include "AST.h"
 #include "lex.yy.h"
+#include "output.h"
+#include "format.h"
+#include "script.h"
+#include "schedule.h"
+#include "pool.h"
 
-// Colors to print the output
-#define ANSI_COLOR_RED     "\x1b[31m"
-#define ANSI_COLOR_GREEN   "\x1b[32m"
-#define ANSI_COLOR_YELLOW  "\x1b[33m"
-#define ANSI_COLOR_BLUE    "\x1b[34m"
-#define ANSI_COLOR_MAGENTA "\x1b[35m"
-#define ANSI_COLOR_CYAN    "\x1b[36m"
-#define ANSI_COLOR_RESET   "\x1b[0m"
 
+// Definition of function that prints the banner of the interactive mode
+void show_banner();
 
 // Definition of function called by yyparse when preparing to read a new line
-void newline();
+void newline(symbol_table *st);
+
+// Definition of function that evaluates an expression tree and frees it
+int evaluate(symbol_table *st, ast_node *node, ast_value *value);
+// Definition of function that evaluates a sweep, writes it to a file and frees it
+void write_sweep(symbol_table *st, ast_node *node, char *path);
+// Definition of function that stores a value in a variable
+void assign_value(info_row *row, ast_value *value);
+// Definition of function that prints the value of an expression
+void print_value(double num, vector *vec);
+// Definitions of functions that run the actions of the rules, also run by
+// the compiled lines
+info_row* assign_expression(symbol_table *st, info_row *row, ast_node *node);
+info_row* assign_chain(info_row *row, info_row *value);
+info_row* assign_constant(symbol_table *st, info_row *row, ast_node *node);
+void run_command_number(symbol_table *st, info_row *row, ast_node *node);
+void print_expression(symbol_table *st, ast_node *node);
+void echo_assignment(info_row *row);
+// Definition of function that runs the actions of a compiled line
+void run_compiled(symbol_table *st, const script_run *run);
+// Definition of function that leaves the expression of a line of a loaded
+// file to run in parallel with the next lines
+int defer_line(ast_node *node, info_row *row);
+// Definition of function that runs the lines that wait to run
+void run_pending_lines();
+// Definition of function that runs the lines that wait to run and deletes
+// their variables that could not be initialized
+void finish_pending_lines(symbol_table *st);
+// Definition of function that shows the value or the error of a line that
+// has run in parallel
+void finish_line(const schedule_line *line);
+// Definition of function that deletes the variables that could not be
+// initialized on the last lines
+void delete_discarded(symbol_table *st);
+// Definition of function that marks a variable to be deleted if it
+// remains uninitialized at the end of the line
+void discard(info_row *row);
+// Definition of function that marks a variable to be deleted if it
+// remains uninitialized and no line uses it after a given one
+void discard_after(info_row *row, unsigned long line);
 
 // Definition of function called by yyparse to manage syntax errors
 void syntax_error(symbol_table *st, char *info);
@@ -96,24 +140,36 @@ int echo = ECHO_OFF; // Disabled by default
 /* Variable that controls if an error has ocurred */
 int flag_error = 0;
 
-#line 100 "sintactic.tab.c" /* yacc.c:339  */
+/* Number of lines with errors */
+unsigned long error_lines = 0;
+
+/* Number of lines analyzed, that identifies the line that uses each symbol
+ * and the lines that wait to run */
+unsigned long lines_analyzed = 0;
+
+#line 151 "sintactic.tab.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULLPTR nullptr
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
 #  else
-#   define YY_NULLPTR 0
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
 
 /* Debug traces.  */
 #ifndef YYDEBUG
@@ -123,37 +179,47 @@ int flag_error = 0;
 extern int yydebug;
 #endif
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    NUM = 258,
-    VAR = 259,
-    CONST = 260,
-    FNCT = 261,
-    COMMAND = 262,
-    COMMAND_P = 263,
-    COMMAND_2P = 264,
-    STRING = 265,
-    NEG = 266
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    NUM = 258,                     /* NUM  */
+    VAR = 259,                     /* VAR  */
+    CONST = 260,                   /* CONST  */
+    FNCT = 261,                    /* FNCT  */
+    COMMAND = 262,                 /* COMMAND  */
+    COMMAND_P = 263,               /* COMMAND_P  */
+    COMMAND_2P = 264,              /* COMMAND_2P  */
+    COMMAND_N = 265,               /* COMMAND_N  */
+    STRING = 266,                  /* STRING  */
+    REDUCE = 267,                  /* REDUCE  */
+    SWEEP = 268,                   /* SWEEP  */
+    COMPILED = 269,                /* COMPILED  */
+    NEG = 270                      /* NEG  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
 union YYSTYPE
 {
-#line 57 "sintactic.y" /* yacc.c:355  */
+#line 103 "sintactic.y"
 
     double      val;        // Type for numbers
     info_row    *id;        // Type for pointers to symbol table
     char        *str;       // Type for strings
+    ast_node    *node;      // Type for expression trees
+    const script_run *compiled; // Type for compiled lines
 
-#line 155 "sintactic.tab.c" /* yacc.c:355  */
-};
+#line 221 "sintactic.tab.c"
 
+};
 typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
 # define YYSTYPE_IS_DECLARED 1
@@ -162,40 +228,144 @@ typedef union YYSTYPE YYSTYPE;
 
 extern YYSTYPE yylval;
 
+
 int yyparse (symbol_table *st);
 
 
 
-/* Copy the second part of user declarations.  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_NUM = 3,                        /* NUM  */
+  YYSYMBOL_VAR = 4,                        /* VAR  */
+  YYSYMBOL_CONST = 5,                      /* CONST  */
+  YYSYMBOL_FNCT = 6,                       /* FNCT  */
+  YYSYMBOL_COMMAND = 7,                    /* COMMAND  */
+  YYSYMBOL_COMMAND_P = 8,                  /* COMMAND_P  */
+  YYSYMBOL_COMMAND_2P = 9,                 /* COMMAND_2P  */
+  YYSYMBOL_COMMAND_N = 10,                 /* COMMAND_N  */
+  YYSYMBOL_STRING = 11,                    /* STRING  */
+  YYSYMBOL_REDUCE = 12,                    /* REDUCE  */
+  YYSYMBOL_SWEEP = 13,                     /* SWEEP  */
+  YYSYMBOL_COMPILED = 14,                  /* COMPILED  */
+  YYSYMBOL_15_ = 15,                       /* '='  */
+  YYSYMBOL_16_ = 16,                       /* ':'  */
+  YYSYMBOL_17_ = 17,                       /* '+'  */
+  YYSYMBOL_18_ = 18,                       /* '-'  */
+  YYSYMBOL_19_ = 19,                       /* '*'  */
+  YYSYMBOL_20_ = 20,                       /* '/'  */
+  YYSYMBOL_21_ = 21,                       /* '%'  */
+  YYSYMBOL_NEG = 22,                       /* NEG  */
+  YYSYMBOL_23_ = 23,                       /* '^'  */
+  YYSYMBOL_24_n_ = 24,                     /* '\n'  */
+  YYSYMBOL_25_ = 25,                       /* '('  */
+  YYSYMBOL_26_ = 26,                       /* ')'  */
+  YYSYMBOL_27_ = 27,                       /* ','  */
+  YYSYMBOL_28_ = 28,                       /* '['  */
+  YYSYMBOL_29_ = 29,                       /* ']'  */
+  YYSYMBOL_YYACCEPT = 30,                  /* $accept  */
+  YYSYMBOL_input = 31,                     /* input  */
+  YYSYMBOL_line = 32,                      /* line  */
+  YYSYMBOL_command = 33,                   /* command  */
+  YYSYMBOL_assign = 34,                    /* assign  */
+  YYSYMBOL_exp = 35,                       /* exp  */
+  YYSYMBOL_items = 36,                     /* items  */
+  YYSYMBOL_grid = 37                       /* grid  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
 
-#line 172 "sintactic.tab.c" /* yacc.c:358  */
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
 #else
 typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -203,15 +373,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -225,47 +408,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
-#endif
-
-#if !defined _Noreturn \
-     && (!defined __STDC_VERSION__ || __STDC_VERSION__ < 201112)
-# if defined _MSC_VER && 1200 <= _MSC_VER
-#  define _Noreturn __declspec (noreturn)
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
 # else
-#  define _Noreturn YY_ATTRIBUTE ((__noreturn__))
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -278,8 +457,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -344,8 +537,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -354,17 +546,17 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -377,11 +569,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -393,12 +585,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -410,39 +602,42 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  2
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   88
+#define YYLAST   271
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  22
+#define YYNTOKENS  30
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  6
+#define YYNNTS  8
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  27
+#define YYNRULES  40
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  54
+#define YYNSTATES  107
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   266
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   270
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      19,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,    16,     2,     2,
-      20,    21,    14,    12,     2,    13,     2,    15,     2,     2,
+      24,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,    11,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,    21,     2,     2,
+      25,    26,    19,    17,    27,    18,     2,    20,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    16,     2,
+       2,    15,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,    18,     2,     2,     2,     2,     2,
+       2,    28,     2,    29,    23,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -459,180 +654,243 @@ static const yytype_uint8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
-       5,     6,     7,     8,     9,    10,    17
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      22
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_uint8 yyrline[] =
 {
-       0,    86,    86,    87,    90,    91,    92,    95,    99,   102,
-     103,   104,   107,   116,   125,   128,   133,   134,   135,   144,
-     145,   146,   147,   148,   149,   150,   151,   152
+       0,   142,   142,   143,   146,   147,   148,   152,   156,   157,
+     162,   167,   173,   179,   183,   190,   194,   198,   202,   208,
+     209,   210,   211,   212,   213,   218,   219,   220,   221,   222,
+     223,   224,   225,   226,   227,   228,   229,   232,   233,   236,
+     241
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "NUM", "VAR", "CONST", "FNCT", "COMMAND",
-  "COMMAND_P", "COMMAND_2P", "STRING", "'='", "'+'", "'-'", "'*'", "'/'",
-  "'%'", "NEG", "'^'", "'\\n'", "'('", "')'", "$accept", "input", "line",
-  "command", "assign", "exp", YY_NULLPTR
+  "\"end of file\"", "error", "\"invalid token\"", "NUM", "VAR", "CONST",
+  "FNCT", "COMMAND", "COMMAND_P", "COMMAND_2P", "COMMAND_N", "STRING",
+  "REDUCE", "SWEEP", "COMPILED", "'='", "':'", "'+'", "'-'", "'*'", "'/'",
+  "'%'", "NEG", "'^'", "'\\n'", "'('", "')'", "','", "'['", "']'",
+  "$accept", "input", "line", "command", "assign", "exp", "items", "grid", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,    61,    43,    45,    42,    47,    37,   266,    94,    10,
-      40,    41
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -16
+#define YYPACT_NINF (-18)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-16)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -1
+#define YYTABLE_NINF (-1)
 
-#define yytable_value_is_error(Yytable_value) \
-  0
+#define yytable_value_is_error(Yyn) \
+  ((Yyn) == YYTABLE_NINF)
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
-static const yytype_int8 yypact[] =
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
 {
-     -16,    25,   -16,   -12,   -16,    -7,     5,     7,   -16,    15,
-      16,    36,   -16,    36,   -16,    18,    24,    -1,   -16,    47,
-      47,    36,    37,    38,   -16,   -16,    28,    50,   -16,   -16,
-      36,    36,    36,    36,    36,    36,   -16,   -16,    70,   -16,
-      70,    60,    33,    34,   -16,    43,    43,   -15,   -15,    28,
-      28,   -16,   -16,   -16
+     -18,   104,   -18,   -17,   -18,     6,    19,    13,   -18,    15,
+      23,    31,    35,    37,   -18,    46,   -18,    46,     7,   -18,
+      55,    62,   -15,   -18,   121,   121,    46,    83,    87,    46,
+     132,    46,   -18,   -18,    48,    76,    49,   -18,   240,     4,
+     -18,   -18,    46,    46,    46,    46,    46,    46,    46,   -18,
+     -18,   240,   -18,   240,    -9,    74,    75,   207,    79,   218,
+      64,     0,    46,   -18,    46,   -18,   248,    34,    34,    16,
+      16,    76,    76,   -18,   -18,   -18,   -18,    46,   -18,   111,
+     -18,    11,    51,   240,   135,    92,    93,    95,   119,    46,
+      46,    46,   -18,   147,   159,   171,    46,    46,    46,   229,
+     183,   195,   -18,    46,    46,   240,   240
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       2,     0,     1,     0,    16,    18,    17,     0,     9,     0,
-       0,     0,     4,     0,     3,     0,     0,     0,     8,     0,
-       0,     0,     0,     0,    18,    17,    25,     0,     5,     6,
-       0,     0,     0,     0,     0,     0,     7,    12,    13,    14,
-      15,     0,     0,     0,    27,    20,    21,    22,    23,    24,
-      26,    19,    10,    11
+       2,     0,     1,     0,    19,    21,    20,     0,    10,     0,
+       0,     0,     0,     0,     8,     0,     4,     0,     0,     3,
+       0,     0,     0,     9,     0,     0,     0,     0,     0,     0,
+       0,     0,    21,    20,     0,    31,     0,    35,    37,     0,
+       5,     6,     0,     0,     0,     0,     0,     0,     0,     7,
+      15,    16,    17,    18,     0,     0,     0,     0,    21,     0,
+       0,     0,     0,    33,     0,    36,    34,    26,    27,    28,
+      29,    30,    32,    22,    11,    12,    13,     0,    23,     0,
+      25,     0,     0,    38,     0,     0,     0,     0,     0,     0,
+       0,     0,    14,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,    24,     0,     0,    39,    40
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -16,   -16,   -16,   -16,   -14,   -11
+     -18,   -18,   -18,   -18,    68,    -1,   105,    78
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     1,    14,    15,    16,    17
+       0,     1,    19,    20,    21,    38,    39,    61
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
-static const yytype_uint8 yytable[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
 {
-      26,    34,    27,    35,    19,    37,    39,    18,    38,    40,
-      41,    30,    31,    32,    33,    34,    20,    35,    36,    45,
-      46,    47,    48,    49,    50,     2,     3,    21,     4,     5,
-       6,     7,     8,     9,    10,    22,    23,    28,    11,     4,
-      24,    25,     7,    29,    12,    13,    35,    42,    43,    11,
-       4,     5,     6,     7,    52,    53,    13,    32,    33,    34,
-      11,    35,    30,    31,    32,    33,    34,    13,    35,     0,
-       0,    44,    30,    31,    32,    33,    34,     0,    35,     0,
-       0,    51,    30,    31,    32,    33,    34,     0,    35
+      22,    42,    43,    44,    45,    46,    47,    23,    48,    49,
+       4,    32,    33,     7,    35,    86,    36,    73,    64,    12,
+      34,    24,    87,    51,    53,    15,    80,    81,    57,    59,
+      60,    64,    17,    65,    25,    18,    37,    47,    26,    48,
+      27,    66,    67,    68,    69,    70,    71,    72,    28,     4,
+      32,    33,     7,    45,    46,    47,    29,    48,    12,    34,
+      30,    60,    31,    83,    15,    42,    43,    44,    45,    46,
+      47,    17,    48,    62,    18,    63,    84,    80,    88,    40,
+      42,    43,    44,    45,    46,    47,    41,    48,    93,    94,
+      95,    79,    50,    52,    55,    99,   100,   101,    56,    48,
+      74,    75,   105,   106,     2,     3,    77,     4,     5,     6,
+       7,     8,     9,    10,    11,    85,    12,    13,    14,    90,
+      91,    92,    15,    86,     4,     5,     6,     7,    16,    17,
+       0,    54,    18,    12,    34,     4,    58,    33,     7,    15,
+      82,     0,     0,     0,    12,    34,    17,     0,     0,    18,
+      15,    42,    43,    44,    45,    46,    47,    17,    48,     0,
+      18,     0,    89,    42,    43,    44,    45,    46,    47,     0,
+      48,     0,     0,     0,    96,    42,    43,    44,    45,    46,
+      47,     0,    48,     0,     0,     0,    97,    42,    43,    44,
+      45,    46,    47,     0,    48,     0,     0,     0,    98,    42,
+      43,    44,    45,    46,    47,     0,    48,     0,     0,     0,
+     103,    42,    43,    44,    45,    46,    47,     0,    48,     0,
+       0,     0,   104,    42,    43,    44,    45,    46,    47,     0,
+      48,     0,     0,    76,    42,    43,    44,    45,    46,    47,
+       0,    48,     0,     0,    78,    42,    43,    44,    45,    46,
+      47,     0,    48,     0,     0,   102,    42,    43,    44,    45,
+      46,    47,     0,    48,    -1,    43,    44,    45,    46,    47,
+       0,    48
 };
 
 static const yytype_int8 yycheck[] =
 {
-      11,    16,    13,    18,    11,    19,    20,    19,    19,    20,
-      21,    12,    13,    14,    15,    16,    11,    18,    19,    30,
-      31,    32,    33,    34,    35,     0,     1,    20,     3,     4,
-       5,     6,     7,     8,     9,    20,    20,    19,    13,     3,
-       4,     5,     6,    19,    19,    20,    18,    10,    10,    13,
-       3,     4,     5,     6,    21,    21,    20,    14,    15,    16,
-      13,    18,    12,    13,    14,    15,    16,    20,    18,    -1,
-      -1,    21,    12,    13,    14,    15,    16,    -1,    18,    -1,
-      -1,    21,    12,    13,    14,    15,    16,    -1,    18
+       1,    16,    17,    18,    19,    20,    21,    24,    23,    24,
+       3,     4,     5,     6,    15,     4,    17,    26,    27,    12,
+      13,    15,    11,    24,    25,    18,    26,    27,    29,    30,
+      31,    27,    25,    29,    15,    28,    29,    21,    25,    23,
+      25,    42,    43,    44,    45,    46,    47,    48,    25,     3,
+       4,     5,     6,    19,    20,    21,    25,    23,    12,    13,
+      25,    62,    25,    64,    18,    16,    17,    18,    19,    20,
+      21,    25,    23,    25,    28,    26,    77,    26,    27,    24,
+      16,    17,    18,    19,    20,    21,    24,    23,    89,    90,
+      91,    27,    24,    25,    11,    96,    97,    98,    11,    23,
+      26,    26,   103,   104,     0,     1,    27,     3,     4,     5,
+       6,     7,     8,     9,    10,     4,    12,    13,    14,    27,
+      27,    26,    18,     4,     3,     4,     5,     6,    24,    25,
+      -1,    26,    28,    12,    13,     3,     4,     5,     6,    18,
+      62,    -1,    -1,    -1,    12,    13,    25,    -1,    -1,    28,
+      18,    16,    17,    18,    19,    20,    21,    25,    23,    -1,
+      28,    -1,    27,    16,    17,    18,    19,    20,    21,    -1,
+      23,    -1,    -1,    -1,    27,    16,    17,    18,    19,    20,
+      21,    -1,    23,    -1,    -1,    -1,    27,    16,    17,    18,
+      19,    20,    21,    -1,    23,    -1,    -1,    -1,    27,    16,
+      17,    18,    19,    20,    21,    -1,    23,    -1,    -1,    -1,
+      27,    16,    17,    18,    19,    20,    21,    -1,    23,    -1,
+      -1,    -1,    27,    16,    17,    18,    19,    20,    21,    -1,
+      23,    -1,    -1,    26,    16,    17,    18,    19,    20,    21,
+      -1,    23,    -1,    -1,    26,    16,    17,    18,    19,    20,
+      21,    -1,    23,    -1,    -1,    26,    16,    17,    18,    19,
+      20,    21,    -1,    23,    16,    17,    18,    19,    20,    21,
+      -1,    23
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-       0,    23,     0,     1,     3,     4,     5,     6,     7,     8,
-       9,    13,    19,    20,    24,    25,    26,    27,    19,    11,
-      11,    20,    20,    20,     4,     5,    27,    27,    19,    19,
-      12,    13,    14,    15,    16,    18,    19,    26,    27,    26,
-      27,    27,    10,    10,    21,    27,    27,    27,    27,    27,
-      27,    21,    21,    21
+       0,    31,     0,     1,     3,     4,     5,     6,     7,     8,
+       9,    10,    12,    13,    14,    18,    24,    25,    28,    32,
+      33,    34,    35,    24,    15,    15,    25,    25,    25,    25,
+      25,    25,     4,     5,    13,    35,    35,    29,    35,    36,
+      24,    24,    16,    17,    18,    19,    20,    21,    23,    24,
+      34,    35,    34,    35,    36,    11,    11,    35,     4,    35,
+      35,    37,    25,    26,    27,    29,    35,    35,    35,    35,
+      35,    35,    35,    26,    26,    26,    26,    27,    26,    27,
+      26,    27,    37,    35,    35,     4,     4,    11,    27,    27,
+      27,    27,    26,    35,    35,    35,    27,    27,    27,    35,
+      35,    35,    26,    27,    27,    35,    35
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       0,    22,    23,    23,    24,    24,    24,    24,    24,    25,
-      25,    25,    26,    26,    26,    26,    27,    27,    27,    27,
-      27,    27,    27,    27,    27,    27,    27,    27
+       0,    30,    31,    31,    32,    32,    32,    32,    32,    32,
+      33,    33,    33,    33,    33,    34,    34,    34,    34,    35,
+      35,    35,    35,    35,    35,    35,    35,    35,    35,    35,
+      35,    35,    35,    35,    35,    35,    35,    36,    36,    37,
+      37
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,     2,     0,     2,     1,     2,     2,     2,     2,     1,
-       4,     4,     3,     3,     3,     3,     1,     1,     1,     4,
-       3,     3,     3,     3,     3,     2,     3,     3
+       0,     2,     0,     2,     1,     2,     2,     2,     1,     2,
+       1,     4,     4,     4,     6,     3,     3,     3,     3,     1,
+       1,     1,     4,     4,    10,     4,     3,     3,     3,     3,
+       3,     2,     3,     3,     3,     2,     3,     1,     3,     9,
+       9
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (st, YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (st, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 
 /* Enable debugging if requested.  */
@@ -649,56 +907,53 @@ do {                                            \
     YYFPRINTF Args;                             \
 } while (0)
 
-/* This macro is provided for backward compatibility. */
-#ifndef YY_LOCATION_PRINT
-# define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-#endif
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, st); \
+                  Kind, Value, st); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, symbol_table *st)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, symbol_table *st)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
-  YYUSE (st);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (st);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, symbol_table *st)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, symbol_table *st)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, st);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, st);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -707,7 +962,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, sym
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -730,21 +985,21 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, int yyrule, symbol_table *st)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, symbol_table *st)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &(yyvsp[(yyi + 1) - (yynrhs)])
-                                              , st);
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], st);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -759,8 +1014,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -783,250 +1038,53 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-static YYSIZE_T
-yystrlen (const char *yystr)
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
-
-  return yyd - 1;
-}
-#  endif
-# endif
-
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-        switch (*++yyp)
-          {
-          case '\'':
-          case ',':
-            goto do_not_strip_quotes;
-
-          case '\\':
-            if (*++yyp != '\\')
-              goto do_not_strip_quotes;
-            /* Fall through.  */
-          default:
-            if (yyres)
-              yyres[yyn] = *yyp;
-            yyn++;
-            break;
-
-          case '"':
-            if (yyres)
-              yyres[yyn] = '\0';
-            return yyn;
-          }
-    do_not_strip_quotes: ;
-    }
 
-  if (! yyres)
-    return yystrlen (yystr);
 
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
 
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
-
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
-  }
-
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, symbol_table *st)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, symbol_table *st)
 {
-  YYUSE (yyvaluep);
-  YYUSE (st);
+  YY_USE (yyvaluep);
+  YY_USE (st);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  switch (yykind)
+    {
+    case YYSYMBOL_exp: /* exp  */
+#line 127 "sintactic.y"
+            { ast_free(((*yyvaluep).node)); }
+#line 1066 "sintactic.tab.c"
+        break;
+
+    case YYSYMBOL_items: /* items  */
+#line 127 "sintactic.y"
+            { ast_free(((*yyvaluep).node)); }
+#line 1072 "sintactic.tab.c"
+        break;
+
+    case YYSYMBOL_grid: /* grid  */
+#line 127 "sintactic.y"
+            { ast_free(((*yyvaluep).node)); }
+#line 1078 "sintactic.tab.c"
+        break;
+
+      default:
+        break;
+    }
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-
-
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 /* The semantic value of the lookahead symbol.  */
@@ -1035,6 +1093,8 @@ YYSTYPE yylval;
 int yynerrs;
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1042,43 +1102,36 @@ int yynerrs;
 int
 yyparse (symbol_table *st)
 {
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    YYSIZE_T yystacksize;
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
@@ -1086,71 +1139,75 @@ yyparse (symbol_table *st)
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
                     &yystacksize);
-
         yyss = yyss1;
         yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
@@ -1158,30 +1215,31 @@ yyparse (symbol_table *st)
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1192,18 +1250,29 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex (st);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1231,15 +1300,13 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1254,7 +1321,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1274,179 +1341,276 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 3:
-#line 87 "sintactic.y" /* yacc.c:1646  */
-    { newline(); }
-#line 1281 "sintactic.tab.c" /* yacc.c:1646  */
+  case 3: /* input: input line  */
+#line 143 "sintactic.y"
+                                    { newline(st); }
+#line 1348 "sintactic.tab.c"
     break;
 
-  case 6:
-#line 92 "sintactic.y" /* yacc.c:1646  */
-    {   if(echo == ECHO_ON && !flag_error) 
-                                            printf("\t%.10g\n", (yyvsp[-1].val));                      
+  case 6: /* line: assign '\n'  */
+#line 148 "sintactic.y"
+                                    {
+                                        script_emit(SCRIPT_ECHO, NULL, NULL, 0, 0);
+                                        echo_assignment((yyvsp[-1].id));
                                     }
-#line 1289 "sintactic.tab.c" /* yacc.c:1646  */
+#line 1357 "sintactic.tab.c"
     break;
 
-  case 7:
-#line 95 "sintactic.y" /* yacc.c:1646  */
-    {   
-                                        if(!flag_error)
-                                            printf("\t%.10g\n", (yyvsp[-1].val)); 
+  case 7: /* line: exp '\n'  */
+#line 152 "sintactic.y"
+                                    {
+                                        script_emit(SCRIPT_PRINT, NULL, NULL, 0, 0);
+                                        print_expression(st, (yyvsp[-1].node));
                                     }
-#line 1298 "sintactic.tab.c" /* yacc.c:1646  */
+#line 1366 "sintactic.tab.c"
     break;
 
-  case 8:
-#line 99 "sintactic.y" /* yacc.c:1646  */
-    { syntax_error(st, "Unrecognized expression"); yyerrok; }
-#line 1304 "sintactic.tab.c" /* yacc.c:1646  */
+  case 8: /* line: COMPILED  */
+#line 156 "sintactic.y"
+                                    { run_compiled(st, (yyvsp[0].compiled)); }
+#line 1372 "sintactic.tab.c"
     break;
 
-  case 9:
-#line 102 "sintactic.y" /* yacc.c:1646  */
-    { (*((yyvsp[0].id)->value.command))(st); }
-#line 1310 "sintactic.tab.c" /* yacc.c:1646  */
+  case 9: /* line: error '\n'  */
+#line 157 "sintactic.y"
+                                    { syntax_error(st, "Unrecognized expression"); yyerrok; }
+#line 1378 "sintactic.tab.c"
     break;
 
-  case 10:
-#line 103 "sintactic.y" /* yacc.c:1646  */
-    { (*((yyvsp[-3].id)->value.command))((yyvsp[-1].str)); free((yyvsp[-1].str)); }
-#line 1316 "sintactic.tab.c" /* yacc.c:1646  */
+  case 10: /* command: COMMAND  */
+#line 162 "sintactic.y"
+                                            {
+                                                script_emit(SCRIPT_COMMAND, (yyvsp[0].id)->key, NULL, 0, 0);
+                                                finish_pending_lines(st);
+                                                (*((yyvsp[0].id)->value.command))(st);
+                                            }
+#line 1388 "sintactic.tab.c"
     break;
 
-  case 11:
-#line 104 "sintactic.y" /* yacc.c:1646  */
-    { (*((yyvsp[-3].id)->value.command))((yyvsp[-1].str), st); free((yyvsp[-1].str)); }
-#line 1322 "sintactic.tab.c" /* yacc.c:1646  */
+  case 11: /* command: COMMAND_P '(' STRING ')'  */
+#line 167 "sintactic.y"
+                                            {
+                                                script_emit(SCRIPT_COMMAND_P, (yyvsp[-3].id)->key, (yyvsp[-1].str), 0, 0);
+                                                finish_pending_lines(st);
+                                                (*((yyvsp[-3].id)->value.command))((yyvsp[-1].str));
+                                                free((yyvsp[-1].str));
+                                            }
+#line 1399 "sintactic.tab.c"
     break;
 
-  case 12:
-#line 107 "sintactic.y" /* yacc.c:1646  */
-    {
-                                        if(!flag_error){
-                                            (yyval.val) = (yyvsp[0].val); 
-                                            (yyvsp[-2].id)->value.var = (yyvsp[0].val); 
-                                            (yyvsp[-2].id)->init = 1; 
-                                        }
-                                        else if(!(yyvsp[-2].id)->init)
-                                            st_delete(st, (yyvsp[-2].id)->key);                                               
+  case 12: /* command: COMMAND_2P '(' STRING ')'  */
+#line 173 "sintactic.y"
+                                            {
+                                                script_emit(SCRIPT_COMMAND_2P, (yyvsp[-3].id)->key, (yyvsp[-1].str), 0, 0);
+                                                finish_pending_lines(st);
+                                                (*((yyvsp[-3].id)->value.command))((yyvsp[-1].str), st);
+                                                free((yyvsp[-1].str));
+                                            }
+#line 1410 "sintactic.tab.c"
+    break;
+
+  case 13: /* command: COMMAND_N '(' exp ')'  */
+#line 179 "sintactic.y"
+                                            {
+                                                script_emit(SCRIPT_COMMAND_N, (yyvsp[-3].id)->key, NULL, 0, 0);
+                                                run_command_number(st, (yyvsp[-3].id), (yyvsp[-1].node));
+                                            }
+#line 1419 "sintactic.tab.c"
+    break;
+
+  case 14: /* command: SWEEP '(' grid ',' STRING ')'  */
+#line 183 "sintactic.y"
+                                            {
+                                                script_emit(SCRIPT_SWEEP_WRITE, NULL, (yyvsp[-1].str), 0, 0);
+                                                write_sweep(st, (yyvsp[-3].node), (yyvsp[-1].str));
+                                                free((yyvsp[-1].str));
+                                            }
+#line 1429 "sintactic.tab.c"
+    break;
+
+  case 15: /* assign: VAR '=' assign  */
+#line 190 "sintactic.y"
+                                    {
+                                        script_emit(SCRIPT_ASSIGN_CHAIN, (yyvsp[-2].id)->key, NULL, 0, 0);
+                                        (yyval.id) = assign_chain((yyvsp[-2].id), (yyvsp[0].id));
                                     }
-#line 1336 "sintactic.tab.c" /* yacc.c:1646  */
+#line 1438 "sintactic.tab.c"
     break;
 
-  case 13:
-#line 116 "sintactic.y" /* yacc.c:1646  */
-    { 
-                                        if(!flag_error){
-                                            (yyval.val) = (yyvsp[0].val); 
-                                            (yyvsp[-2].id)->value.var = (yyvsp[0].val); 
-                                            (yyvsp[-2].id)->init = 1; 
-                                        } 
-                                        else if(!(yyvsp[-2].id)->init)
-                                            st_delete(st, (yyvsp[-2].id)->key);
+  case 16: /* assign: VAR '=' exp  */
+#line 194 "sintactic.y"
+                                    {
+                                        script_emit(SCRIPT_ASSIGN, (yyvsp[-2].id)->key, NULL, 0, 0);
+                                        (yyval.id) = assign_expression(st, (yyvsp[-2].id), (yyvsp[0].node));
                                     }
-#line 1350 "sintactic.tab.c" /* yacc.c:1646  */
+#line 1447 "sintactic.tab.c"
     break;
 
-  case 14:
-#line 125 "sintactic.y" /* yacc.c:1646  */
-    {
-                                        semantic_error(st, "Trying to assing a value to constant", (yyvsp[-2].id)->key);
+  case 17: /* assign: CONST '=' assign  */
+#line 198 "sintactic.y"
+                                    {
+                                        script_emit(SCRIPT_CONST_ASSIGN_CHAIN, (yyvsp[-2].id)->key, NULL, 0, 0);
+                                        (yyval.id) = assign_constant(st, (yyvsp[-2].id), NULL);
                                     }
-#line 1358 "sintactic.tab.c" /* yacc.c:1646  */
+#line 1456 "sintactic.tab.c"
     break;
 
-  case 15:
-#line 128 "sintactic.y" /* yacc.c:1646  */
-    {
-                                        semantic_error(st, "Trying to assing a value to constant", (yyvsp[-2].id)->key);
+  case 18: /* assign: CONST '=' exp  */
+#line 202 "sintactic.y"
+                                    {
+                                        script_emit(SCRIPT_CONST_ASSIGN, (yyvsp[-2].id)->key, NULL, 0, 0);
+                                        (yyval.id) = assign_constant(st, (yyvsp[-2].id), (yyvsp[0].node));
                                     }
-#line 1366 "sintactic.tab.c" /* yacc.c:1646  */
+#line 1465 "sintactic.tab.c"
     break;
 
-  case 16:
-#line 133 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = (yyvsp[0].val); }
-#line 1372 "sintactic.tab.c" /* yacc.c:1646  */
+  case 19: /* exp: NUM  */
+#line 208 "sintactic.y"
+                                    { (yyval.node) = ast_num((yyvsp[0].val)); script_emit(SCRIPT_NUM, NULL, NULL, 0, (yyvsp[0].val)); }
+#line 1471 "sintactic.tab.c"
     break;
 
-  case 17:
-#line 134 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = (yyvsp[0].id)->value.var; }
-#line 1378 "sintactic.tab.c" /* yacc.c:1646  */
+  case 20: /* exp: CONST  */
+#line 209 "sintactic.y"
+                                    { (yyval.node) = ast_var((yyvsp[0].id)); script_emit(SCRIPT_VAR, (yyvsp[0].id)->key, NULL, 0, 0); }
+#line 1477 "sintactic.tab.c"
     break;
 
-  case 18:
-#line 135 "sintactic.y" /* yacc.c:1646  */
-    {
-                                        if((yyvsp[0].id)->init == 1) 
-                                            (yyval.val) = (yyvsp[0].id)->value.var;
-                                        else{
-                                            semantic_error(st, "Uninitialized variable", (yyvsp[0].id)->key);
-                                            st_delete(st, (yyvsp[0].id)->key);
-                                        }
-                                            
+  case 21: /* exp: VAR  */
+#line 210 "sintactic.y"
+                                    { (yyval.node) = ast_var((yyvsp[0].id)); script_emit(SCRIPT_VAR, (yyvsp[0].id)->key, NULL, 0, 0); }
+#line 1483 "sintactic.tab.c"
+    break;
+
+  case 22: /* exp: FNCT '(' items ')'  */
+#line 211 "sintactic.y"
+                                    { (yyval.node) = ast_call((yyvsp[-3].id), (yyvsp[-1].node)); script_emit(SCRIPT_CALL, (yyvsp[-3].id)->key, NULL, 0, 0); }
+#line 1489 "sintactic.tab.c"
+    break;
+
+  case 23: /* exp: REDUCE '(' exp ')'  */
+#line 212 "sintactic.y"
+                                    { (yyval.node) = ast_reduce((yyvsp[-3].id), (yyvsp[-1].node)); script_emit(SCRIPT_REDUCE, (yyvsp[-3].id)->key, NULL, 0, 0); }
+#line 1495 "sintactic.tab.c"
+    break;
+
+  case 24: /* exp: REDUCE '(' VAR ',' exp ',' exp ',' exp ')'  */
+#line 213 "sintactic.y"
+                                                          {
+                                        script_emit(SCRIPT_SERIES, (yyvsp[-9].id)->key, (yyvsp[-7].id)->key, 0, 0);
+                                        (yyval.node) = ast_series((yyvsp[-9].id), (yyvsp[-7].id), (yyvsp[-5].node), (yyvsp[-3].node), (yyvsp[-1].node));
+                                        discard((yyvsp[-7].id)); // The index is local to the series
                                     }
-#line 1392 "sintactic.tab.c" /* yacc.c:1646  */
+#line 1505 "sintactic.tab.c"
+    break;
+
+  case 25: /* exp: SWEEP '(' grid ')'  */
+#line 218 "sintactic.y"
+                                    { (yyval.node) = (yyvsp[-1].node); script_emit(SCRIPT_EVAL_SWEEP, NULL, NULL, 0, 0); }
+#line 1511 "sintactic.tab.c"
     break;
 
-  case 19:
-#line 144 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = (*((yyvsp[-3].id)->value.fnct_d))((yyvsp[-1].val)); }
-#line 1398 "sintactic.tab.c" /* yacc.c:1646  */
+  case 26: /* exp: exp '+' exp  */
+#line 219 "sintactic.y"
+                                    { (yyval.node) = ast_op(AST_ADD, (yyvsp[-2].node), (yyvsp[0].node)); script_emit(SCRIPT_OP, NULL, NULL, AST_ADD, 0); }
+#line 1517 "sintactic.tab.c"
     break;
 
-  case 20:
-#line 145 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = (yyvsp[-2].val) + (yyvsp[0].val); }
-#line 1404 "sintactic.tab.c" /* yacc.c:1646  */
+  case 27: /* exp: exp '-' exp  */
+#line 220 "sintactic.y"
+                                            { (yyval.node) = ast_op(AST_SUB, (yyvsp[-2].node), (yyvsp[0].node)); script_emit(SCRIPT_OP, NULL, NULL, AST_SUB, 0); }
+#line 1523 "sintactic.tab.c"
     break;
 
-  case 21:
-#line 146 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = (yyvsp[-2].val) - (yyvsp[0].val); }
-#line 1410 "sintactic.tab.c" /* yacc.c:1646  */
+  case 28: /* exp: exp '*' exp  */
+#line 221 "sintactic.y"
+                                            { (yyval.node) = ast_op(AST_MUL, (yyvsp[-2].node), (yyvsp[0].node)); script_emit(SCRIPT_OP, NULL, NULL, AST_MUL, 0); }
+#line 1529 "sintactic.tab.c"
     break;
 
-  case 22:
-#line 147 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = (yyvsp[-2].val) * (yyvsp[0].val); }
-#line 1416 "sintactic.tab.c" /* yacc.c:1646  */
+  case 29: /* exp: exp '/' exp  */
+#line 222 "sintactic.y"
+                                            { (yyval.node) = ast_op(AST_DIV, (yyvsp[-2].node), (yyvsp[0].node)); script_emit(SCRIPT_OP, NULL, NULL, AST_DIV, 0); }
+#line 1535 "sintactic.tab.c"
     break;
 
-  case 23:
-#line 148 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = (yyvsp[-2].val) / (yyvsp[0].val); }
-#line 1422 "sintactic.tab.c" /* yacc.c:1646  */
+  case 30: /* exp: exp '%' exp  */
+#line 223 "sintactic.y"
+                                    { (yyval.node) = ast_op(AST_MOD, (yyvsp[-2].node), (yyvsp[0].node)); script_emit(SCRIPT_OP, NULL, NULL, AST_MOD, 0); }
+#line 1541 "sintactic.tab.c"
     break;
 
-  case 24:
-#line 149 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = fmod((yyvsp[-2].val), (yyvsp[0].val)); }
-#line 1428 "sintactic.tab.c" /* yacc.c:1646  */
+  case 31: /* exp: '-' exp  */
+#line 224 "sintactic.y"
+                                            { (yyval.node) = ast_op(AST_NEG, (yyvsp[0].node), NULL); script_emit(SCRIPT_OP, NULL, NULL, AST_NEG, 0); }
+#line 1547 "sintactic.tab.c"
     break;
 
-  case 25:
-#line 150 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = -(yyvsp[0].val); }
-#line 1434 "sintactic.tab.c" /* yacc.c:1646  */
+  case 32: /* exp: exp '^' exp  */
+#line 225 "sintactic.y"
+                                            { (yyval.node) = ast_op(AST_POW, (yyvsp[-2].node), (yyvsp[0].node)); script_emit(SCRIPT_OP, NULL, NULL, AST_POW, 0); }
+#line 1553 "sintactic.tab.c"
     break;
 
-  case 26:
-#line 151 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = pow((yyvsp[-2].val), (yyvsp[0].val)); }
-#line 1440 "sintactic.tab.c" /* yacc.c:1646  */
+  case 33: /* exp: '(' exp ')'  */
+#line 226 "sintactic.y"
+                                            { (yyval.node) = (yyvsp[-1].node); }
+#line 1559 "sintactic.tab.c"
     break;
 
-  case 27:
-#line 152 "sintactic.y" /* yacc.c:1646  */
-    { (yyval.val) = (yyvsp[-1].val); }
-#line 1446 "sintactic.tab.c" /* yacc.c:1646  */
+  case 34: /* exp: exp ':' exp  */
+#line 227 "sintactic.y"
+                                    { (yyval.node) = ast_op(AST_RANGE, (yyvsp[-2].node), (yyvsp[0].node)); script_emit(SCRIPT_OP, NULL, NULL, AST_RANGE, 0); }
+#line 1565 "sintactic.tab.c"
     break;
 
+  case 35: /* exp: '[' ']'  */
+#line 228 "sintactic.y"
+                                    { (yyval.node) = ast_list(); script_emit(SCRIPT_LIST, NULL, NULL, 0, 0); }
+#line 1571 "sintactic.tab.c"
+    break;
+
+  case 36: /* exp: '[' items ']'  */
+#line 229 "sintactic.y"
+                                    { (yyval.node) = (yyvsp[-1].node); script_emit(SCRIPT_VECTOR, NULL, NULL, 0, 0); }
+#line 1577 "sintactic.tab.c"
+    break;
+
+  case 37: /* items: exp  */
+#line 232 "sintactic.y"
+                                    { (yyval.node) = ast_list_append(ast_list(), (yyvsp[0].node)); script_emit(SCRIPT_ITEMS, NULL, NULL, 0, 0); }
+#line 1583 "sintactic.tab.c"
+    break;
+
+  case 38: /* items: items ',' exp  */
+#line 233 "sintactic.y"
+                                    { (yyval.node) = ast_list_append((yyvsp[-2].node), (yyvsp[0].node)); script_emit(SCRIPT_APPEND, NULL, NULL, 0, 0); }
+#line 1589 "sintactic.tab.c"
+    break;
+
+  case 39: /* grid: exp ',' VAR ',' exp ',' exp ',' exp  */
+#line 236 "sintactic.y"
+                                                    {
+                                        script_emit(SCRIPT_SWEEP, (yyvsp[-6].id)->key, NULL, 0, 0);
+                                        (yyval.node) = ast_sweep((yyvsp[-8].node), (yyvsp[-6].id), (yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node));
+                                        discard((yyvsp[-6].id)); // The variable is local to the sweep
+                                    }
+#line 1599 "sintactic.tab.c"
+    break;
+
+  case 40: /* grid: grid ',' VAR ',' exp ',' exp ',' exp  */
+#line 241 "sintactic.y"
+                                                    {
+                                        script_emit(SCRIPT_SWEEP_APPEND, (yyvsp[-6].id)->key, NULL, 0, 0);
+                                        (yyval.node) = ast_sweep_append((yyvsp[-8].node), (yyvsp[-6].id), (yyvsp[-4].node), (yyvsp[-2].node), (yyvsp[0].node));
+                                        discard((yyvsp[-6].id));
+                                    }
+#line 1609 "sintactic.tab.c"
+    break;
+
+
+#line 1613 "sintactic.tab.c"
 
-#line 1450 "sintactic.tab.c" /* yacc.c:1646  */
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -1460,25 +1624,23 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -1489,50 +1651,14 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (st, YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (st, yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -1561,12 +1687,11 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
-
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -1583,13 +1708,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -1603,7 +1729,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, st);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, st);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1615,7 +1741,7 @@ yyerrlab1:
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -1626,26 +1752,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (st, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -1661,24 +1791,32 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp, st);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, st);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
+
   return yyresult;
 }
-#line 155 "sintactic.y" /* yacc.c:1906  */
+
+#line 248 "sintactic.y"
 
 
 // Function that starts de sintactic and lexical analyzer
 void startExecution(symbol_table *st){
+    // The banner is only shown on a terminal, like the prompt
+    if(output_is_terminal())
+        show_banner();
+    output_prompt();
+
+    yyparse(st);
+}
+
+// Function that prints the banner of the interactive mode
+void show_banner(){
     printf("**************************************************\n");
     printf("\t\tFreeNoteMath\tv 1.0\n");
     printf("--------------------------------------------------\n");
@@ -1693,24 +1831,436 @@ void startExecution(symbol_table *st){
     printf("\n");
     printf("Type 'help' to see the list of available commands\n");
     printf("**************************************************\n");
-    printf("$> ");
+}
 
-    yyparse(st);
+// Function that runs the inputs of the batch mode
+int startBatch(symbol_table *st, batch_input *inputs, int n){
+    // Without banner nor prompt (see newline())
+    if(set_batch_input(inputs, n) == 0)
+        yyparse(st);
+
+    return exit_status();
 }
 
+// Function that returns the exit status of the program
+int exit_status(){
+    // The interactive mode always finishes successfully
+    if(batch_mode && error_lines > 0)
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+/* Variables to delete if they remain uninitialized at the end of the line */
+// A line that waits to run may discard a variable that the next lines
+// already use, which would be created again without it
+static info_row **discarded = NULL;
+static unsigned long *discarded_lines = NULL;   // Last line that discarded each one
+static size_t n_discarded = 0;
+
 // Function called by yyparse when preparing to read a new line
-void newline(){
-    if(!input_file)
-        printf("$> "); // Displays the prompt only if not reading a file
+void newline(symbol_table *st){
+    // The lines that wait to run still use the variables of their line
+    if(schedule_pending() == 0)
+        delete_discarded(st);
+    lines_analyzed++;
+
+    // The actions of the line are kept on its compiled file
+    input_line_end();
+
+    if(flag_error)
+        error_lines++;
+    output_line_end();
+    if(!input_file && !batch_mode)
+        output_prompt(); // Displays the prompt only if not reading a file
     flag_error = 0;
 }
 
+// Function that evaluates an expression tree and frees it
+int evaluate(symbol_table *st, ast_node *node, ast_value *value){
+    ast_error error;
+    int status = -1;
+
+    // The expression is not evaluated if the line already has errors
+    if(!flag_error){
+        status = ast_eval(node, value, &error);
+        if(status == -1){
+            semantic_error(st, error.info, error.symbol);
+            if(error.row != NULL)
+                discard(error.row);
+        }
+    }
+
+    ast_free(node);
+    return status;
+}
+
+// Function that evaluates a sweep, writes it to a file and frees it
+void write_sweep(symbol_table *st, ast_node *node, char *path){
+    ast_error error;
+    size_t n_points;
+
+    // The previous lines may assign the variables of the sweep
+    run_pending_lines();
+
+    // The sweep is not evaluated if the line already has errors
+    if(!flag_error){
+        FILE *file = fopen(path, "w");
+        if(file == NULL)
+            semantic_error(st, "Could not create the file", path);
+        else{
+            if(ast_sweep_write(node, file, &n_points, &error) == -1){
+                semantic_error(st, error.info, error.symbol);
+                if(error.row != NULL)
+                    discard(error.row);
+            }
+            else
+                output_message(OUTPUT_BLUE, "** %zu points written to %s **", n_points, path);
+            fclose(file);
+        }
+    }
+
+    ast_free(node);
+}
+
+// Function that stores a value in a variable
+void assign_value(info_row *row, ast_value *value){
+    vec_free(row->vec);
+    row->vec = value->vec;
+    row->value.var = value->num;
+    row->init = 1;
+}
+
+// Function that prints the value of an expression
+void print_value(double num, vector *vec){
+    if(vec != NULL)
+        vec_print(vec);
+    else{
+        char text[FORMAT_SIZE];
+        putchar('\t');
+        fwrite(text, 1, format_number(num, text), stdout);
+        putchar('\n');
+    }
+}
+
+// Function that assigns the value of an expression to a variable
+info_row* assign_expression(symbol_table *st, info_row *row, ast_node *node){
+    ast_value value;
+
+    // The variable is assigned when the line runs
+    if(defer_line(node, row) == 0)
+        return row;
+
+    if(evaluate(st, node, &value) == 0){
+        assign_value(row, &value);
+        return row;
+    }
+    discard(row);
+    return NULL;
+}
+
+// Function that assigns the value of another assigned variable
+info_row* assign_chain(info_row *row, info_row *value){
+    // The value of the other variable is needed now
+    run_pending_lines();
+    if(!flag_error && value != NULL){
+        ast_value copy = { value->value.var, NULL };
+        if(value->vec != NULL)
+            copy.vec = vec_copy(value->vec);
+        assign_value(row, &copy);
+        return row;
+    }
+    discard(row);
+    return NULL;
+}
+
+// Function called when a value is assigned to a constant
+info_row* assign_constant(symbol_table *st, info_row *row, ast_node *node){
+    semantic_error(st, "Trying to assing a value to constant", row->key);
+    ast_free(node);
+    return NULL;
+}
+
+// Function that runs a command with a number as parameter
+void run_command_number(symbol_table *st, info_row *row, ast_node *node){
+    ast_value value;
+
+    run_pending_lines();
+
+    if(evaluate(st, node, &value) == 0){
+        if(value.vec == NULL)
+            (*(row->value.command))(&value.num);
+        else
+            semantic_error(st, "Expected a number as parameter of", row->key);
+        vec_free(value.vec);
+    }
+}
+
+// Function that evaluates an expression and prints its value
+void print_expression(symbol_table *st, ast_node *node){
+    ast_value value;
+
+    if(defer_line(node, NULL) == 0)
+        return;
+
+    if(evaluate(st, node, &value) == 0){
+        print_value(value.num, value.vec);
+        vec_free(value.vec);
+    }
+}
+
+// Function that prints the value of an assigned variable, if enabled
+void echo_assignment(info_row *row){
+    // The value of a line that waits to run is printed when it runs
+    schedule_line *last = schedule_last();
+    if(last != NULL && last->number == lines_analyzed && last->row == row){
+        last->echo = (echo == ECHO_ON);
+        return;
+    }
+    if(echo == ECHO_ON && !flag_error && row != NULL)
+        print_value(row->value.var, row->vec);
+}
+
+/* Stack of the values of the compiled lines, like the one of yyparse */
+static YYSTYPE *compiled_stack = NULL;
+static size_t compiled_size = 0;
+
+// Function that runs the actions of a compiled line, in the order in which
+// yyparse ran them (see script.h). The line was checked when its compiled
+// file was opened, so the stack always has the values that each one uses
+void run_compiled(symbol_table *st, const script_run *run){
+    const script *code = run->code;
+    const script_action *action = &code->actions[run->line->first_action];
+    const script_action *end = action + run->line->n_actions;
+    info_row *row, *index;
+    size_t top = 0;
+    char *text;
+
+    // The stack is never deeper than the number of actions
+    if(run->line->n_actions > compiled_size){
+        compiled_stack = realloc(compiled_stack, run->line->n_actions * sizeof(YYSTYPE));
+        compiled_size = run->line->n_actions;
+    }
+    YYSTYPE *stack = compiled_stack;
+
+    for(; action < end; action++){
+        // The identifiers were found by the lexical analyzer
+        row = (action->symbol != SCRIPT_NO_SYMBOL) ? run->rows[action->symbol] : NULL;
+
+        switch(action->op){
+            case SCRIPT_NUM:
+                stack[top++].node = ast_num(code->numbers[action->value]);
+                break;
+            case SCRIPT_VAR:
+                stack[top++].node = ast_var(row);
+                break;
+            case SCRIPT_CALL:
+                stack[top - 1].node = ast_call(row, stack[top - 1].node);
+                break;
+            case SCRIPT_REDUCE:
+                stack[top - 1].node = ast_reduce(row, stack[top - 1].node);
+                break;
+            case SCRIPT_SERIES:
+                index = run->rows[action->value];
+                top -= 2;
+                stack[top - 1].node = ast_series(row, index, stack[top - 1].node, stack[top].node, stack[top + 1].node);
+                discard(index);
+                break;
+            case SCRIPT_EVAL_SWEEP:
+            case SCRIPT_VECTOR:
+                break;  // The value doesn't change
+            case SCRIPT_OP:
+                if(action->type == AST_NEG)
+                    stack[top - 1].node = ast_op(AST_NEG, stack[top - 1].node, NULL);
+                else{
+                    top--;
+                    stack[top - 1].node = ast_op((ast_type)action->type, stack[top - 1].node, stack[top].node);
+                }
+                break;
+            case SCRIPT_LIST:
+                stack[top++].node = ast_list();
+                break;
+            case SCRIPT_ITEMS:
+                stack[top - 1].node = ast_list_append(ast_list(), stack[top - 1].node);
+                break;
+            case SCRIPT_APPEND:
+                top--;
+                stack[top - 1].node = ast_list_append(stack[top - 1].node, stack[top].node);
+                break;
+            case SCRIPT_SWEEP:
+                top -= 3;
+                stack[top - 1].node = ast_sweep(stack[top - 1].node, row, stack[top].node, stack[top + 1].node, stack[top + 2].node);
+                discard(row);
+                break;
+            case SCRIPT_SWEEP_APPEND:
+                top -= 3;
+                stack[top - 1].node = ast_sweep_append(stack[top - 1].node, row, stack[top].node, stack[top + 1].node, stack[top + 2].node);
+                discard(row);
+                break;
+            case SCRIPT_ASSIGN:
+                stack[top - 1].id = assign_expression(st, row, stack[top - 1].node);
+                break;
+            case SCRIPT_ASSIGN_CHAIN:
+                stack[top - 1].id = assign_chain(row, stack[top - 1].id);
+                break;
+            case SCRIPT_CONST_ASSIGN:
+                stack[top - 1].id = assign_constant(st, row, stack[top - 1].node);
+                break;
+            case SCRIPT_CONST_ASSIGN_CHAIN:
+                stack[top - 1].id = assign_constant(st, row, NULL);
+                break;
+            case SCRIPT_COMMAND:
+                finish_pending_lines(st);
+                (*(row->value.command))(st);
+                break;
+            case SCRIPT_COMMAND_P:
+                // The commands receive their own copy, like from the analyzer
+                text = strdup(script_text(code, action->value));
+                finish_pending_lines(st);
+                (*(row->value.command))(text);
+                free(text);
+                break;
+            case SCRIPT_COMMAND_2P:
+                text = strdup(script_text(code, action->value));
+                finish_pending_lines(st);
+                (*(row->value.command))(text, st);
+                free(text);
+                break;
+            case SCRIPT_COMMAND_N:
+                run_command_number(st, row, stack[--top].node);
+                break;
+            case SCRIPT_SWEEP_WRITE:
+                text = strdup(script_text(code, action->value));
+                write_sweep(st, stack[--top].node, text);
+                free(text);
+                break;
+            case SCRIPT_ECHO:
+                echo_assignment(stack[--top].id);
+                break;
+            case SCRIPT_PRINT:
+                print_expression(st, stack[--top].node);
+                break;
+        }
+    }
+}
+
+// Function that leaves the expression of a line of a loaded file to run in
+// parallel with the next lines, if it's enabled (see schedule.h). It
+// returns 0 if the line waits, or -1 if it must run now
+int defer_line(ast_node *node, info_row *row){
+    unsigned long line;
+    const char *file;
+
+    if(flag_error || !input_file || !schedule_get_enabled() || pool_get_threads() == 1)
+        return -1;
+    if((file = input_location(&line)) == NULL)
+        return -1;
+
+    if(schedule_pending() == SCHEDULE_MAX_LINES)
+        run_pending_lines();
+    if(schedule_add(node, row, file, line, lines_analyzed) == -1){
+        run_pending_lines();
+        return -1;
+    }
+    return 0;
+}
+
+// Function that runs the lines that wait to run, before anything that may
+// depend on them (commands, errors, the end of their file...)
+void run_pending_lines(){
+    schedule_run(assign_value, finish_line);
+}
+
+// Function that runs the lines that wait to run before a command, that may
+// show the variables. The command is the whole line, so the variables that
+// could not be initialized are only used by the lines that have run
+void finish_pending_lines(symbol_table *st){
+    run_pending_lines();
+    delete_discarded(st);
+}
+
+// Function that shows the value or the error of a line that has run in
+// parallel, in the order of the lines
+void finish_line(const schedule_line *line){
+    if(line->status == 0){
+        if(line->row == NULL || line->echo)
+            print_value(line->value.num, line->value.vec);
+        return;
+    }
+
+    output_message(OUTPUT_RED, "%s:%lu: SEMANTIC ERROR: %s %s", line->file, line->line, line->error, line->symbol);
+    if(line->error_row != NULL)
+        discard_after(line->error_row, line->number);
+    if(line->row != NULL)
+        discard_after(line->row, line->number);
+
+    // The line being analyzed counts its errors when it ends
+    if(line->number == lines_analyzed)
+        flag_error = 1;
+    else
+        error_lines++;
+}
+
+// Function that runs the lines of a loaded file that wait to run, when its
+// end is reached
+void end_file_lines(symbol_table *st, int line_ended){
+    // Without a line being analyzed, nothing uses the discarded variables
+    if(line_ended)
+        finish_pending_lines(st);
+    else
+        run_pending_lines();
+}
+
+// Function that deletes the variables that could not be initialized on the
+// last lines
+void delete_discarded(symbol_table *st){
+    size_t i;
+    for(i = 0; i < n_discarded; i++){
+        if(!discarded[i]->init && discarded[i]->used <= discarded_lines[i])
+            st_delete(st, discarded[i]->key);
+    }
+    n_discarded = 0;
+}
+
+// Function that marks a variable to be deleted if it remains
+// uninitialized at the end of the line
+void discard(info_row *row){
+    discard_after(row, lines_analyzed);
+}
+
+// Function that marks a variable to be deleted if it remains uninitialized
+// and no line uses it after a given one
+void discard_after(info_row *row, unsigned long line){
+    size_t i;
+    for(i = 0; i < n_discarded; i++){
+        if(discarded[i] == row){
+            if(discarded_lines[i] < line)
+                discarded_lines[i] = line;
+            return;
+        }
+    }
+
+    discarded = realloc(discarded, (n_discarded + 1) * sizeof(info_row *));
+    discarded_lines = realloc(discarded_lines, (n_discarded + 1) * sizeof(unsigned long));
+    discarded[n_discarded] = row;
+    discarded_lines[n_discarded++] = line;
+}
+
 // Function called by yyparse to manage errors
 void yyerror(symbol_table *st, char *s){
+    unsigned long line;
+
     if(strcmp(s, "syntax error") == 0){
+        script_line_fail(); // Its tokens are analyzed again on each run
         return;
     }
-    printf(ANSI_COLOR_RED "%s" ANSI_COLOR_RESET "\n", s);
+    // The errors of the previous lines are shown before
+    run_pending_lines();
+    // The errors of the files show where they are
+    const char *file = input_location(&line);
+    if(file != NULL)
+        output_message(OUTPUT_RED, "%s:%lu: %s", file, line, s);
+    else
+        output_message(OUTPUT_RED, "%s", s);
     flag_error = 1;
 }
 
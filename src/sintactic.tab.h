@@ -18,22 +18,21 @@
 #define SINTACTIC_TAB_H
 
 #include "ST.h"
+#include "AST.h"
+#include "lex.yy.h"
+#include "output.h"
+#include "script.h"
 
 
-// Colors to print the output
-#define ANSI_COLOR_RED     "\x1b[31m"
-#define ANSI_COLOR_GREEN   "\x1b[32m"
-#define ANSI_COLOR_YELLOW  "\x1b[33m"
-#define ANSI_COLOR_BLUE    "\x1b[34m"
-#define ANSI_COLOR_MAGENTA "\x1b[35m"
-#define ANSI_COLOR_CYAN    "\x1b[36m"
-#define ANSI_COLOR_RESET   "\x1b[0m"
-
 /* Token type */
 #ifndef YYTOKENTYPE
 #define YYTOKENTYPE
     enum yytokentype
     {
+        YYEMPTY = -2,
+        YYEOF = 0,
+        YYerror = 256,
+        YYUNDEF = 257,
         NUM = 258,
         VAR = 259,
         CONST = 260,
@@ -41,9 +40,14 @@
         COMMAND = 262,
         COMMAND_P = 263,
         COMMAND_2P = 264,
-        STRING = 265,
-        NEG = 266
+        COMMAND_N = 265,
+        STRING = 266,
+        REDUCE = 267,
+        SWEEP = 268,
+        COMPILED = 269,
+        NEG = 270
     };
+    typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type  */
@@ -52,6 +56,8 @@ union YYSTYPE{
     double      val;        // Type for numbers
     info_row    *id;        // Type for pointers to symbol table
     char        *str;       // Type for strings
+    ast_node    *node;      // Type for expression trees
+    const script_run *compiled; // Type for compiled lines
 };
 
 typedef union YYSTYPE YYSTYPE;
@@ -69,6 +75,12 @@ extern int echo;
 /* Variable that controls if an error has ocurred */
 extern int flag_error;
 
+/* Number of lines with errors */
+extern unsigned long error_lines;
+
+/* Number of lines analyzed, that identifies the line that uses each symbol */
+extern unsigned long lines_analyzed;
+
 /* 
  * Function that starts de sintactic and lexical analyzer
  * 
@@ -76,6 +88,25 @@ extern int flag_error;
  */
 void startExecution(symbol_table *st);
 
+/* 
+ * Function that runs a list of inputs in batch mode, without banner nor
+ * prompt, and returns when all of them have been read
+ * 
+ * @param st: Pointer to the symbol table that contains the alphanumeric strings
+ * @param inputs: Array of files and expressions to run in order
+ * @param n: Number of inputs
+ * @return The exit status of the program (see exit_status())
+ */
+int startBatch(symbol_table *st, batch_input *inputs, int n);
+
+/* 
+ * Function that returns the exit status of the program: EXIT_FAILURE in
+ * batch mode if any line had errors, or EXIT_SUCCESS otherwise
+ * 
+ * @return The exit status
+ */
+int exit_status();
+
 /*
  * Function called by yyparse to manage general errors
  * 
@@ -84,4 +115,14 @@ void startExecution(symbol_table *st);
  */ 
 void yyerror(symbol_table *st, char *s);
 
+/*
+ * Function that runs the lines of a loaded file that wait to run in
+ * parallel (see schedule.h), when the end of the file is reached
+ * 
+ * @param st: Pointer to the symbol table that contains the alphanumeric strings
+ * @param line_ended: 1 if the last line of the file was ended, so no line
+ * is being analyzed
+ */ 
+void end_file_lines(symbol_table *st, int line_ended);
+
 #endif /* SINTACTIC_TAB_H */
\ No newline at end of file
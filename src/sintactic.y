@@ -23,20 +23,59 @@
 #include <math.h>   // pow() and trigonometric functions are available by default
 #include "sintactic.tab.h"
 #include "ST.h"
+#include "AST.h"
 #include "lex.yy.h"
+#include "output.h"
+#include "format.h"
+#include "script.h"
+#include "schedule.h"
+#include "pool.h"
 
-// Colors to print the output
-#define ANSI_COLOR_RED     "\x1b[31m"
-#define ANSI_COLOR_GREEN   "\x1b[32m"
-#define ANSI_COLOR_YELLOW  "\x1b[33m"
-#define ANSI_COLOR_BLUE    "\x1b[34m"
-#define ANSI_COLOR_MAGENTA "\x1b[35m"
-#define ANSI_COLOR_CYAN    "\x1b[36m"
-#define ANSI_COLOR_RESET   "\x1b[0m"
 
+// Definition of function that prints the banner of the interactive mode
+void show_banner();
 
 // Definition of function called by yyparse when preparing to read a new line
-void newline();
+void newline(symbol_table *st);
+
+// Definition of function that evaluates an expression tree and frees it
+int evaluate(symbol_table *st, ast_node *node, ast_value *value);
+// Definition of function that evaluates a sweep, writes it to a file and frees it
+void write_sweep(symbol_table *st, ast_node *node, char *path);
+// Definition of function that stores a value in a variable
+void assign_value(info_row *row, ast_value *value);
+// Definition of function that prints the value of an expression
+void print_value(double num, vector *vec);
+// Definitions of functions that run the actions of the rules, also run by
+// the compiled lines
+info_row* assign_expression(symbol_table *st, info_row *row, ast_node *node);
+info_row* assign_chain(info_row *row, info_row *value);
+info_row* assign_constant(symbol_table *st, info_row *row, ast_node *node);
+void run_command_number(symbol_table *st, info_row *row, ast_node *node);
+void print_expression(symbol_table *st, ast_node *node);
+void echo_assignment(info_row *row);
+// Definition of function that runs the actions of a compiled line
+void run_compiled(symbol_table *st, const script_run *run);
+// Definition of function that leaves the expression of a line of a loaded
+// file to run in parallel with the next lines
+int defer_line(ast_node *node, info_row *row);
+// Definition of function that runs the lines that wait to run
+void run_pending_lines();
+// Definition of function that runs the lines that wait to run and deletes
+// their variables that could not be initialized
+void finish_pending_lines(symbol_table *st);
+// Definition of function that shows the value or the error of a line that
+// has run in parallel
+void finish_line(const schedule_line *line);
+// Definition of function that deletes the variables that could not be
+// initialized on the last lines
+void delete_discarded(symbol_table *st);
+// Definition of function that marks a variable to be deleted if it
+// remains uninitialized at the end of the line
+void discard(info_row *row);
+// Definition of function that marks a variable to be deleted if it
+// remains uninitialized and no line uses it after a given one
+void discard_after(info_row *row, unsigned long line);
 
 // Definition of function called by yyparse to manage syntax errors
 void syntax_error(symbol_table *st, char *info);
@@ -48,6 +87,13 @@ int echo = ECHO_OFF; // Disabled by default
 
 /* Variable that controls if an error has ocurred */
 int flag_error = 0;
+
+/* Number of lines with errors */
+unsigned long error_lines = 0;
+
+/* Number of lines analyzed, that identifies the line that uses each symbol
+ * and the lines that wait to run */
+unsigned long lines_analyzed = 0;
 %}
 
 %parse-param {symbol_table *st}
@@ -58,21 +104,31 @@ int flag_error = 0;
     double      val;        // Type for numbers
     info_row    *id;        // Type for pointers to symbol table
     char        *str;       // Type for strings
+    ast_node    *node;      // Type for expression trees
+    const script_run *compiled; // Type for compiled lines
 }
 
 %token      <val>   NUM                 // Final symbol: number literal
 %token      <id>    VAR CONST FNCT      // Final symbol: alphanumeric string (variable, function)
 
-%nonassoc   <id>    COMMAND COMMAND_P COMMAND_2P   // Final symbol: alphanumeric string (command)
+%nonassoc   <id>    COMMAND COMMAND_P COMMAND_2P COMMAND_N // Final symbol: alphanumeric string (command)
 
 %token      <str>   STRING              // Final symbol: string
+%token      <id>    REDUCE              // Final symbol: alphanumeric string (reduction)
+%token      <id>    SWEEP               // Final symbol: alphanumeric string (sweep)
+%token      <compiled> COMPILED         // Final symbol: line of a compiled file
 
 
 %type       <id>    command             // Non-final symbol: command
-%type       <val>   assign exp          // Non-final symbol: expression
+%type       <id>    assign              // Non-final symbol: assigned variable
+%type       <node>  exp items grid      // Non-final symbol: expression
+
+// Expression trees discarded during error recovery
+%destructor { ast_free($$); } <node>
 
 // Accepted operators and their associativity and precedence
 %right  '='
+%nonassoc ':'               // Range
 %left   '+' '-'
 %left   '*' '/'
 %left   '%'                 // Module
@@ -84,78 +140,125 @@ int flag_error = 0;
 /*      GRAMATICAL RULES        */
 
 input:        /* empty */
-            | input line            { newline(); }
+            | input line            { newline(st); }
 ;
 
 line:         '\n'
             | command '\n'
-            | assign '\n'           {   if(echo == ECHO_ON && !flag_error) 
-                                            printf("\t%.10g\n", $1);                      
+            | assign '\n'           {
+                                        script_emit(SCRIPT_ECHO, NULL, NULL, 0, 0);
+                                        echo_assignment($1);
                                     }
-            | exp '\n'              {   
-                                        if(!flag_error)
-                                            printf("\t%.10g\n", $1); 
+            | exp '\n'              {
+                                        script_emit(SCRIPT_PRINT, NULL, NULL, 0, 0);
+                                        print_expression(st, $1);
                                     }
+            | COMPILED              { run_compiled(st, $1); }
             | error '\n'            { syntax_error(st, "Unrecognized expression"); yyerrok; }
 ;
 
-command:      COMMAND                       { (*($1->value.command))(st); }
-            | COMMAND_P '(' STRING ')'      { (*($1->value.command))($3); free($3); }
-            | COMMAND_2P '(' STRING ')'      { (*($1->value.command))($3, st); free($3); }
+/* Each action is also added to the compiled line (see script.h) */
+
+command:      COMMAND                       {
+                                                script_emit(SCRIPT_COMMAND, $1->key, NULL, 0, 0);
+                                                finish_pending_lines(st);
+                                                (*($1->value.command))(st);
+                                            }
+            | COMMAND_P '(' STRING ')'      {
+                                                script_emit(SCRIPT_COMMAND_P, $1->key, $3, 0, 0);
+                                                finish_pending_lines(st);
+                                                (*($1->value.command))($3);
+                                                free($3);
+                                            }
+            | COMMAND_2P '(' STRING ')'     {
+                                                script_emit(SCRIPT_COMMAND_2P, $1->key, $3, 0, 0);
+                                                finish_pending_lines(st);
+                                                (*($1->value.command))($3, st);
+                                                free($3);
+                                            }
+            | COMMAND_N '(' exp ')'         {
+                                                script_emit(SCRIPT_COMMAND_N, $1->key, NULL, 0, 0);
+                                                run_command_number(st, $1, $3);
+                                            }
+            | SWEEP '(' grid ',' STRING ')' {
+                                                script_emit(SCRIPT_SWEEP_WRITE, NULL, $5, 0, 0);
+                                                write_sweep(st, $3, $5);
+                                                free($5);
+                                            }
 ;
 
 assign:       VAR '=' assign        {
-                                        if(!flag_error){
-                                            $$ = $3; 
-                                            $1->value.var = $3; 
-                                            $1->init = 1; 
-                                        }
-                                        else if(!$1->init)
-                                            st_delete(st, $1->key);                                               
+                                        script_emit(SCRIPT_ASSIGN_CHAIN, $1->key, NULL, 0, 0);
+                                        $$ = assign_chain($1, $3);
                                     }
-            | VAR '=' exp           { 
-                                        if(!flag_error){
-                                            $$ = $3; 
-                                            $1->value.var = $3; 
-                                            $1->init = 1; 
-                                        } 
-                                        else if(!$1->init)
-                                            st_delete(st, $1->key);
+            | VAR '=' exp           {
+                                        script_emit(SCRIPT_ASSIGN, $1->key, NULL, 0, 0);
+                                        $$ = assign_expression(st, $1, $3);
                                     }
             | CONST '=' assign      {
-                                        semantic_error(st, "Trying to assing a value to constant", $1->key);
+                                        script_emit(SCRIPT_CONST_ASSIGN_CHAIN, $1->key, NULL, 0, 0);
+                                        $$ = assign_constant(st, $1, NULL);
                                     }
             | CONST '=' exp         {
-                                        semantic_error(st, "Trying to assing a value to constant", $1->key);
+                                        script_emit(SCRIPT_CONST_ASSIGN, $1->key, NULL, 0, 0);
+                                        $$ = assign_constant(st, $1, $3);
                                     }
 ;
 
-exp:          NUM                   { $$ = $1; }
-            | CONST                 { $$ = $1->value.var; }
-            | VAR                   {
-                                        if($1->init == 1) 
-                                            $$ = $1->value.var;
-                                        else{
-                                            semantic_error(st, "Uninitialized variable", $1->key);
-                                            st_delete(st, $1->key);
-                                        }
-                                            
+exp:          NUM                   { $$ = ast_num($1); script_emit(SCRIPT_NUM, NULL, NULL, 0, $1); }
+            | CONST                 { $$ = ast_var($1); script_emit(SCRIPT_VAR, $1->key, NULL, 0, 0); }
+            | VAR                   { $$ = ast_var($1); script_emit(SCRIPT_VAR, $1->key, NULL, 0, 0); }
+            | FNCT '(' items ')'    { $$ = ast_call($1, $3); script_emit(SCRIPT_CALL, $1->key, NULL, 0, 0); }
+            | REDUCE '(' exp ')'    { $$ = ast_reduce($1, $3); script_emit(SCRIPT_REDUCE, $1->key, NULL, 0, 0); }
+            | REDUCE '(' VAR ',' exp ',' exp ',' exp ')'  {
+                                        script_emit(SCRIPT_SERIES, $1->key, $3->key, 0, 0);
+                                        $$ = ast_series($1, $3, $5, $7, $9);
+                                        discard($3); // The index is local to the series
                                     }
-            | FNCT '(' exp ')'      { $$ = (*($1->value.fnct_d))($3); }
-            | exp '+' exp           { $$ = $1 + $3; }
-            | exp '-' exp		    { $$ = $1 - $3; }
-	        | exp '*' exp		    { $$ = $1 * $3; }
-	        | exp '/' exp		    { $$ = $1 / $3; }
-            | exp '%' exp           { $$ = fmod($1, $3); }
-	        | '-' exp %prec NEG	    { $$ = -$2; }
-	        | exp '^' exp		    { $$ = pow($1, $3); }
+            | SWEEP '(' grid ')'    { $$ = $3; script_emit(SCRIPT_EVAL_SWEEP, NULL, NULL, 0, 0); }
+            | exp '+' exp           { $$ = ast_op(AST_ADD, $1, $3); script_emit(SCRIPT_OP, NULL, NULL, AST_ADD, 0); }
+            | exp '-' exp		    { $$ = ast_op(AST_SUB, $1, $3); script_emit(SCRIPT_OP, NULL, NULL, AST_SUB, 0); }
+	        | exp '*' exp		    { $$ = ast_op(AST_MUL, $1, $3); script_emit(SCRIPT_OP, NULL, NULL, AST_MUL, 0); }
+	        | exp '/' exp		    { $$ = ast_op(AST_DIV, $1, $3); script_emit(SCRIPT_OP, NULL, NULL, AST_DIV, 0); }
+            | exp '%' exp           { $$ = ast_op(AST_MOD, $1, $3); script_emit(SCRIPT_OP, NULL, NULL, AST_MOD, 0); }
+	        | '-' exp %prec NEG	    { $$ = ast_op(AST_NEG, $2, NULL); script_emit(SCRIPT_OP, NULL, NULL, AST_NEG, 0); }
+	        | exp '^' exp		    { $$ = ast_op(AST_POW, $1, $3); script_emit(SCRIPT_OP, NULL, NULL, AST_POW, 0); }
 	        | '(' exp ')'		    { $$ = $2; }
+            | exp ':' exp           { $$ = ast_op(AST_RANGE, $1, $3); script_emit(SCRIPT_OP, NULL, NULL, AST_RANGE, 0); }
+            | '[' ']'               { $$ = ast_list(); script_emit(SCRIPT_LIST, NULL, NULL, 0, 0); }
+            | '[' items ']'         { $$ = $2; script_emit(SCRIPT_VECTOR, NULL, NULL, 0, 0); }
+;
+
+items:        exp                   { $$ = ast_list_append(ast_list(), $1); script_emit(SCRIPT_ITEMS, NULL, NULL, 0, 0); }
+            | items ',' exp         { $$ = ast_list_append($1, $3); script_emit(SCRIPT_APPEND, NULL, NULL, 0, 0); }
+;
+
+grid:         exp ',' VAR ',' exp ',' exp ',' exp   {
+                                        script_emit(SCRIPT_SWEEP, $3->key, NULL, 0, 0);
+                                        $$ = ast_sweep($1, $3, $5, $7, $9);
+                                        discard($3); // The variable is local to the sweep
+                                    }
+            | grid ',' VAR ',' exp ',' exp ',' exp  {
+                                        script_emit(SCRIPT_SWEEP_APPEND, $3->key, NULL, 0, 0);
+                                        $$ = ast_sweep_append($1, $3, $5, $7, $9);
+                                        discard($3);
+                                    }
 ;
 
 %%
 
 // Function that starts de sintactic and lexical analyzer
 void startExecution(symbol_table *st){
+    // The banner is only shown on a terminal, like the prompt
+    if(output_is_terminal())
+        show_banner();
+    output_prompt();
+
+    yyparse(st);
+}
+
+// Function that prints the banner of the interactive mode
+void show_banner(){
     printf("**************************************************\n");
     printf("\t\tFreeNoteMath\tv 1.0\n");
     printf("--------------------------------------------------\n");
@@ -170,24 +273,436 @@ void startExecution(symbol_table *st){
     printf("\n");
     printf("Type 'help' to see the list of available commands\n");
     printf("**************************************************\n");
-    printf("$> ");
+}
 
-    yyparse(st);
+// Function that runs the inputs of the batch mode
+int startBatch(symbol_table *st, batch_input *inputs, int n){
+    // Without banner nor prompt (see newline())
+    if(set_batch_input(inputs, n) == 0)
+        yyparse(st);
+
+    return exit_status();
+}
+
+// Function that returns the exit status of the program
+int exit_status(){
+    // The interactive mode always finishes successfully
+    if(batch_mode && error_lines > 0)
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
 }
 
+/* Variables to delete if they remain uninitialized at the end of the line */
+// A line that waits to run may discard a variable that the next lines
+// already use, which would be created again without it
+static info_row **discarded = NULL;
+static unsigned long *discarded_lines = NULL;   // Last line that discarded each one
+static size_t n_discarded = 0;
+
 // Function called by yyparse when preparing to read a new line
-void newline(){
-    if(!input_file)
-        printf("$> "); // Displays the prompt only if not reading a file
+void newline(symbol_table *st){
+    // The lines that wait to run still use the variables of their line
+    if(schedule_pending() == 0)
+        delete_discarded(st);
+    lines_analyzed++;
+
+    // The actions of the line are kept on its compiled file
+    input_line_end();
+
+    if(flag_error)
+        error_lines++;
+    output_line_end();
+    if(!input_file && !batch_mode)
+        output_prompt(); // Displays the prompt only if not reading a file
     flag_error = 0;
 }
 
+// Function that evaluates an expression tree and frees it
+int evaluate(symbol_table *st, ast_node *node, ast_value *value){
+    ast_error error;
+    int status = -1;
+
+    // The expression is not evaluated if the line already has errors
+    if(!flag_error){
+        status = ast_eval(node, value, &error);
+        if(status == -1){
+            semantic_error(st, error.info, error.symbol);
+            if(error.row != NULL)
+                discard(error.row);
+        }
+    }
+
+    ast_free(node);
+    return status;
+}
+
+// Function that evaluates a sweep, writes it to a file and frees it
+void write_sweep(symbol_table *st, ast_node *node, char *path){
+    ast_error error;
+    size_t n_points;
+
+    // The previous lines may assign the variables of the sweep
+    run_pending_lines();
+
+    // The sweep is not evaluated if the line already has errors
+    if(!flag_error){
+        FILE *file = fopen(path, "w");
+        if(file == NULL)
+            semantic_error(st, "Could not create the file", path);
+        else{
+            if(ast_sweep_write(node, file, &n_points, &error) == -1){
+                semantic_error(st, error.info, error.symbol);
+                if(error.row != NULL)
+                    discard(error.row);
+            }
+            else
+                output_message(OUTPUT_BLUE, "** %zu points written to %s **", n_points, path);
+            fclose(file);
+        }
+    }
+
+    ast_free(node);
+}
+
+// Function that stores a value in a variable
+void assign_value(info_row *row, ast_value *value){
+    vec_free(row->vec);
+    row->vec = value->vec;
+    row->value.var = value->num;
+    row->init = 1;
+}
+
+// Function that prints the value of an expression
+void print_value(double num, vector *vec){
+    if(vec != NULL)
+        vec_print(vec);
+    else{
+        char text[FORMAT_SIZE];
+        putchar('\t');
+        fwrite(text, 1, format_number(num, text), stdout);
+        putchar('\n');
+    }
+}
+
+// Function that assigns the value of an expression to a variable
+info_row* assign_expression(symbol_table *st, info_row *row, ast_node *node){
+    ast_value value;
+
+    // The variable is assigned when the line runs
+    if(defer_line(node, row) == 0)
+        return row;
+
+    if(evaluate(st, node, &value) == 0){
+        assign_value(row, &value);
+        return row;
+    }
+    discard(row);
+    return NULL;
+}
+
+// Function that assigns the value of another assigned variable
+info_row* assign_chain(info_row *row, info_row *value){
+    // The value of the other variable is needed now
+    run_pending_lines();
+    if(!flag_error && value != NULL){
+        ast_value copy = { value->value.var, NULL };
+        if(value->vec != NULL)
+            copy.vec = vec_copy(value->vec);
+        assign_value(row, &copy);
+        return row;
+    }
+    discard(row);
+    return NULL;
+}
+
+// Function called when a value is assigned to a constant
+info_row* assign_constant(symbol_table *st, info_row *row, ast_node *node){
+    semantic_error(st, "Trying to assing a value to constant", row->key);
+    ast_free(node);
+    return NULL;
+}
+
+// Function that runs a command with a number as parameter
+void run_command_number(symbol_table *st, info_row *row, ast_node *node){
+    ast_value value;
+
+    run_pending_lines();
+
+    if(evaluate(st, node, &value) == 0){
+        if(value.vec == NULL)
+            (*(row->value.command))(&value.num);
+        else
+            semantic_error(st, "Expected a number as parameter of", row->key);
+        vec_free(value.vec);
+    }
+}
+
+// Function that evaluates an expression and prints its value
+void print_expression(symbol_table *st, ast_node *node){
+    ast_value value;
+
+    if(defer_line(node, NULL) == 0)
+        return;
+
+    if(evaluate(st, node, &value) == 0){
+        print_value(value.num, value.vec);
+        vec_free(value.vec);
+    }
+}
+
+// Function that prints the value of an assigned variable, if enabled
+void echo_assignment(info_row *row){
+    // The value of a line that waits to run is printed when it runs
+    schedule_line *last = schedule_last();
+    if(last != NULL && last->number == lines_analyzed && last->row == row){
+        last->echo = (echo == ECHO_ON);
+        return;
+    }
+    if(echo == ECHO_ON && !flag_error && row != NULL)
+        print_value(row->value.var, row->vec);
+}
+
+/* Stack of the values of the compiled lines, like the one of yyparse */
+static YYSTYPE *compiled_stack = NULL;
+static size_t compiled_size = 0;
+
+// Function that runs the actions of a compiled line, in the order in which
+// yyparse ran them (see script.h). The line was checked when its compiled
+// file was opened, so the stack always has the values that each one uses
+void run_compiled(symbol_table *st, const script_run *run){
+    const script *code = run->code;
+    const script_action *action = &code->actions[run->line->first_action];
+    const script_action *end = action + run->line->n_actions;
+    info_row *row, *index;
+    size_t top = 0;
+    char *text;
+
+    // The stack is never deeper than the number of actions
+    if(run->line->n_actions > compiled_size){
+        compiled_stack = realloc(compiled_stack, run->line->n_actions * sizeof(YYSTYPE));
+        compiled_size = run->line->n_actions;
+    }
+    YYSTYPE *stack = compiled_stack;
+
+    for(; action < end; action++){
+        // The identifiers were found by the lexical analyzer
+        row = (action->symbol != SCRIPT_NO_SYMBOL) ? run->rows[action->symbol] : NULL;
+
+        switch(action->op){
+            case SCRIPT_NUM:
+                stack[top++].node = ast_num(code->numbers[action->value]);
+                break;
+            case SCRIPT_VAR:
+                stack[top++].node = ast_var(row);
+                break;
+            case SCRIPT_CALL:
+                stack[top - 1].node = ast_call(row, stack[top - 1].node);
+                break;
+            case SCRIPT_REDUCE:
+                stack[top - 1].node = ast_reduce(row, stack[top - 1].node);
+                break;
+            case SCRIPT_SERIES:
+                index = run->rows[action->value];
+                top -= 2;
+                stack[top - 1].node = ast_series(row, index, stack[top - 1].node, stack[top].node, stack[top + 1].node);
+                discard(index);
+                break;
+            case SCRIPT_EVAL_SWEEP:
+            case SCRIPT_VECTOR:
+                break;  // The value doesn't change
+            case SCRIPT_OP:
+                if(action->type == AST_NEG)
+                    stack[top - 1].node = ast_op(AST_NEG, stack[top - 1].node, NULL);
+                else{
+                    top--;
+                    stack[top - 1].node = ast_op((ast_type)action->type, stack[top - 1].node, stack[top].node);
+                }
+                break;
+            case SCRIPT_LIST:
+                stack[top++].node = ast_list();
+                break;
+            case SCRIPT_ITEMS:
+                stack[top - 1].node = ast_list_append(ast_list(), stack[top - 1].node);
+                break;
+            case SCRIPT_APPEND:
+                top--;
+                stack[top - 1].node = ast_list_append(stack[top - 1].node, stack[top].node);
+                break;
+            case SCRIPT_SWEEP:
+                top -= 3;
+                stack[top - 1].node = ast_sweep(stack[top - 1].node, row, stack[top].node, stack[top + 1].node, stack[top + 2].node);
+                discard(row);
+                break;
+            case SCRIPT_SWEEP_APPEND:
+                top -= 3;
+                stack[top - 1].node = ast_sweep_append(stack[top - 1].node, row, stack[top].node, stack[top + 1].node, stack[top + 2].node);
+                discard(row);
+                break;
+            case SCRIPT_ASSIGN:
+                stack[top - 1].id = assign_expression(st, row, stack[top - 1].node);
+                break;
+            case SCRIPT_ASSIGN_CHAIN:
+                stack[top - 1].id = assign_chain(row, stack[top - 1].id);
+                break;
+            case SCRIPT_CONST_ASSIGN:
+                stack[top - 1].id = assign_constant(st, row, stack[top - 1].node);
+                break;
+            case SCRIPT_CONST_ASSIGN_CHAIN:
+                stack[top - 1].id = assign_constant(st, row, NULL);
+                break;
+            case SCRIPT_COMMAND:
+                finish_pending_lines(st);
+                (*(row->value.command))(st);
+                break;
+            case SCRIPT_COMMAND_P:
+                // The commands receive their own copy, like from the analyzer
+                text = strdup(script_text(code, action->value));
+                finish_pending_lines(st);
+                (*(row->value.command))(text);
+                free(text);
+                break;
+            case SCRIPT_COMMAND_2P:
+                text = strdup(script_text(code, action->value));
+                finish_pending_lines(st);
+                (*(row->value.command))(text, st);
+                free(text);
+                break;
+            case SCRIPT_COMMAND_N:
+                run_command_number(st, row, stack[--top].node);
+                break;
+            case SCRIPT_SWEEP_WRITE:
+                text = strdup(script_text(code, action->value));
+                write_sweep(st, stack[--top].node, text);
+                free(text);
+                break;
+            case SCRIPT_ECHO:
+                echo_assignment(stack[--top].id);
+                break;
+            case SCRIPT_PRINT:
+                print_expression(st, stack[--top].node);
+                break;
+        }
+    }
+}
+
+// Function that leaves the expression of a line of a loaded file to run in
+// parallel with the next lines, if it's enabled (see schedule.h). It
+// returns 0 if the line waits, or -1 if it must run now
+int defer_line(ast_node *node, info_row *row){
+    unsigned long line;
+    const char *file;
+
+    if(flag_error || !input_file || !schedule_get_enabled() || pool_get_threads() == 1)
+        return -1;
+    if((file = input_location(&line)) == NULL)
+        return -1;
+
+    if(schedule_pending() == SCHEDULE_MAX_LINES)
+        run_pending_lines();
+    if(schedule_add(node, row, file, line, lines_analyzed) == -1){
+        run_pending_lines();
+        return -1;
+    }
+    return 0;
+}
+
+// Function that runs the lines that wait to run, before anything that may
+// depend on them (commands, errors, the end of their file...)
+void run_pending_lines(){
+    schedule_run(assign_value, finish_line);
+}
+
+// Function that runs the lines that wait to run before a command, that may
+// show the variables. The command is the whole line, so the variables that
+// could not be initialized are only used by the lines that have run
+void finish_pending_lines(symbol_table *st){
+    run_pending_lines();
+    delete_discarded(st);
+}
+
+// Function that shows the value or the error of a line that has run in
+// parallel, in the order of the lines
+void finish_line(const schedule_line *line){
+    if(line->status == 0){
+        if(line->row == NULL || line->echo)
+            print_value(line->value.num, line->value.vec);
+        return;
+    }
+
+    output_message(OUTPUT_RED, "%s:%lu: SEMANTIC ERROR: %s %s", line->file, line->line, line->error, line->symbol);
+    if(line->error_row != NULL)
+        discard_after(line->error_row, line->number);
+    if(line->row != NULL)
+        discard_after(line->row, line->number);
+
+    // The line being analyzed counts its errors when it ends
+    if(line->number == lines_analyzed)
+        flag_error = 1;
+    else
+        error_lines++;
+}
+
+// Function that runs the lines of a loaded file that wait to run, when its
+// end is reached
+void end_file_lines(symbol_table *st, int line_ended){
+    // Without a line being analyzed, nothing uses the discarded variables
+    if(line_ended)
+        finish_pending_lines(st);
+    else
+        run_pending_lines();
+}
+
+// Function that deletes the variables that could not be initialized on the
+// last lines
+void delete_discarded(symbol_table *st){
+    size_t i;
+    for(i = 0; i < n_discarded; i++){
+        if(!discarded[i]->init && discarded[i]->used <= discarded_lines[i])
+            st_delete(st, discarded[i]->key);
+    }
+    n_discarded = 0;
+}
+
+// Function that marks a variable to be deleted if it remains
+// uninitialized at the end of the line
+void discard(info_row *row){
+    discard_after(row, lines_analyzed);
+}
+
+// Function that marks a variable to be deleted if it remains uninitialized
+// and no line uses it after a given one
+void discard_after(info_row *row, unsigned long line){
+    size_t i;
+    for(i = 0; i < n_discarded; i++){
+        if(discarded[i] == row){
+            if(discarded_lines[i] < line)
+                discarded_lines[i] = line;
+            return;
+        }
+    }
+
+    discarded = realloc(discarded, (n_discarded + 1) * sizeof(info_row *));
+    discarded_lines = realloc(discarded_lines, (n_discarded + 1) * sizeof(unsigned long));
+    discarded[n_discarded] = row;
+    discarded_lines[n_discarded++] = line;
+}
+
 // Function called by yyparse to manage errors
 void yyerror(symbol_table *st, char *s){
+    unsigned long line;
+
     if(strcmp(s, "syntax error") == 0){
+        script_line_fail(); // Its tokens are analyzed again on each run
         return;
     }
-    printf(ANSI_COLOR_RED "%s" ANSI_COLOR_RESET "\n", s);
+    // The errors of the previous lines are shown before
+    run_pending_lines();
+    // The errors of the files show where they are
+    const char *file = input_location(&line);
+    if(file != NULL)
+        output_message(OUTPUT_RED, "%s:%lu: %s", file, line, s);
+    else
+        output_message(OUTPUT_RED, "%s", s);
     flag_error = 1;
 }
 
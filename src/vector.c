@@ -0,0 +1,77 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Source: vector.c
+ * Implementation of the vector functions
+ * defined on the header file vector.h
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#include "vector.h"
+#include "format.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/** PUBLIC FUNCTIONS: Defined on vector.h **/
+
+vector* vec_new(size_t size){
+    // The size in bytes, rounded to the alignment, must not overflow
+    if(size > (SIZE_MAX - VEC_ALIGNMENT) / sizeof(double))
+        return NULL;
+
+    vector *vec = malloc(sizeof(vector));
+    if(vec == NULL)
+        return NULL;
+
+    // Reserves at least one element so that 'data' is never NULL
+    size_t bytes = (size > 0 ? size : 1) * sizeof(double);
+    vec->data = aligned_alloc(VEC_ALIGNMENT, (bytes + VEC_ALIGNMENT - 1) / VEC_ALIGNMENT * VEC_ALIGNMENT);
+    if(vec->data == NULL){
+        free(vec);
+        return NULL;
+    }
+    vec->size = size;
+
+    return vec;
+}
+
+vector* vec_copy(const vector *vec){
+    vector *copy = vec_new(vec->size);
+    if(copy == NULL)
+        return NULL;
+
+    memcpy(copy->data, vec->data, vec->size * sizeof(double));
+    return copy;
+}
+
+void vec_print(const vector *vec){
+    size_t i;
+
+    char text[FORMAT_SIZE];
+
+    fputs("\t[", stdout);
+    for(i = 0; i < vec->size; i++){
+        if(i > 0)
+            fputs(", ", stdout);
+        fwrite(text, 1, format_number(vec->data[i], text), stdout);
+    }
+    fputs("]\n", stdout);
+}
+
+void vec_free(vector *vec){
+    if(vec != NULL){
+        free(vec->data);
+        free(vec);
+    }
+}
\ No newline at end of file
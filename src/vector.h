@@ -0,0 +1,65 @@
+/********************************************/
+/*************** FreeNoteMath ***************/
+/*
+ * Header: vector.h
+ * Definitions of the vector datatype used to
+ * store arrays of numbers in the workspace
+ *
+ * Copyright (C) 2020 Pedro Gamallo Fernández
+ *
+ * This program is free software; you can
+ * redistribute it and/or modify it under the
+ * terms of the GNU General Public License as
+ * published by the Free Software Foundation
+ */
+/********************************************/
+
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <stddef.h>
+
+/* Alignment of the elements of the vectors and of the blocks of the
+ * evaluator. The loops of the array forms of the libraries handle the
+ * unaligned elements apart, so the results of a function only depend on
+ * the position of each element and not on where it was allocated (by
+ * which thread, or after which other vectors) */
+#define VEC_ALIGNMENT 64
+
+/** Contiguous array of doubles **/
+typedef struct {
+    double *data;   // The elements of the vector
+    size_t size;    // Number of elements
+} vector;
+
+/**
+ * Reserves space for a new vector. The elements are not initialized
+ *
+ * @param size: Number of elements of the vector
+ * @return The pointer to the new vector or NULL if there was an error
+ */
+vector* vec_new(size_t size);
+
+/**
+ * Creates a new vector with the same elements as the one passed
+ *
+ * @param vec: Vector to be copied
+ * @return The pointer to the new vector or NULL if there was an error
+ */
+vector* vec_copy(const vector *vec);
+
+/**
+ * Prints the elements of a vector between brackets
+ *
+ * @param vec: Vector to be printed
+ */
+void vec_print(const vector *vec);
+
+/**
+ * Frees the memory associated to a vector
+ *
+ * @param vec: Vector to be freed (NULL is allowed)
+ */
+void vec_free(vector *vec);
+
+#endif /* VECTOR_H */
\ No newline at end of file
@@ -0,0 +1,57 @@
+# Functions shared by the tests. Each test runs the program in batch mode
+# with the expressions given as arguments (see the option -e)
+
+FNM=${FNM:-../src/FreeNoteMath}
+failures=0
+
+# Folder for the files of the test, also used as cache of the compiled files
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+export XDG_CACHE_HOME="$WORK"
+
+# Reports a failed check
+# $1: Name of the check; $2: Description of the failure
+fail(){
+    echo "  FAIL $1: $2"
+    failures=$((failures + 1))
+}
+
+# Checks the output of the program
+# $1: Name of the check; $2: Expected output; the rest: Its arguments
+check_output(){
+    name=$1; expected=$2; shift 2
+    output=$("$FNM" "$@" 2>&1)
+    [ "$output" = "$expected" ] || fail "$name" "expected '$expected', got '$output'"
+}
+
+# Checks the last line of the output of the program, that must end without
+# errors
+# $1: Name of the check; $2: Expected line; the rest: Its arguments
+check_last(){
+    name=$1; expected=$2; shift 2
+    output=$("$FNM" "$@" 2>&1)
+    status=$?
+    last=$(printf '%s\n' "$output" | tail -n 1)
+    if [ $status -ne 0 ]; then
+        fail "$name" "status $status: $(printf '%s\n' "$output" | grep ERROR | head -n 1)"
+    elif [ "$last" != "$expected" ]; then
+        fail "$name" "expected '$expected', got '$last'"
+    fi
+}
+
+# Checks that the program shows an error and ends with status 1
+# $1: Name of the check; $2: Expected message; the rest: Its arguments
+check_error(){
+    name=$1; message=$2; shift 2
+    output=$("$FNM" "$@" 2>&1)
+    status=$?
+    case "$output" in
+        *"$message"*) [ $status -eq 1 ] || fail "$name" "status $status" ;;
+        *) fail "$name" "expected '$message', got '$output' (status $status)" ;;
+    esac
+}
+
+# Ends the test with the number of failed checks
+finish(){
+    exit $failures
+}
@@ -0,0 +1,15 @@
+#!/bin/sh
+# Runs all the tests of this folder with the executable of the variable FNM
+# (../src/FreeNoteMath by default). It ends with status 1 if any test fails
+
+cd "$(dirname "$0")"
+failed=0
+for test in test_*.sh; do
+    if sh "$test"; then
+        echo "PASS ${test%.sh}"
+    else
+        echo "FAIL ${test%.sh}"
+        failed=1
+    fi
+done
+exit $failed
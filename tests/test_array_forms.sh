@@ -0,0 +1,35 @@
+# The array forms of the built-in libraries give the same results as the
+# scalar calls, whatever the position of the value on the vector
+. ./common.sh
+
+# Compares the function applied to vectors of 8 copies of 199 points with
+# the function applied to each point
+# $1: Function; $2: Expression of each point from k (1 to 199)
+check_array_form(){
+    fnct=$1; point=$2
+    awk -v f="$fnct" 'BEGIN {
+        print "include(\"builtin:trig\")"
+        print "include(\"builtin:exp\")"
+        print "include(\"builtin:round\")"
+        print "d = 0"
+        for(k = 1; k <= 199; k++){
+            x = sprintf("%.17g", '"$point"')
+            printf "d = d + sum(abs(%s(%s + 0*(1:8)) - %s(%s)))\n", f, x, f, x
+        }
+        print "d"
+    }' > "$WORK/$fnct.fnm"
+    check_last "$fnct" "$(printf '\t0')" "$WORK/$fnct.fnm"
+}
+
+for fnct in sin cos tan sinh cosh tanh atan asinh exp exp2 cbrt floor round; do
+    check_array_form $fnct "(k - 100) * 0.3719"
+done
+for fnct in log log2 log10 sqrt; do
+    check_array_form $fnct "k * k * 0.0573"
+done
+for fnct in acos asin atanh; do
+    check_array_form $fnct "(k - 100) / 101"
+done
+check_array_form acosh "1 + k * 0.731"
+
+finish
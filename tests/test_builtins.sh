@@ -0,0 +1,37 @@
+# Names of the built-in libraries, and their .so files included after or
+# before them
+. ./common.sh
+
+included="** Library included succesfully! **"
+already="** Library already included **"
+
+for name in trigonometric trig exponential exp round; do
+    check_last "builtin:$name" "$included" -e "include(\"builtin:$name\")"
+done
+check_error "unknown built-in" "Unknown built-in library" -e 'include("builtin:rounds")'
+check_last "short and full name" "$already" -e 'include("builtin:trig")' -e 'include("builtin:trigonometric")'
+
+${CC:-gcc} -O2 -shared -fPIC -o "$WORK/round.so" ../lib/round.c -lm || { fail "build" "round.so"; finish; }
+check_last "file after built-in" "$already" -e 'include("builtin:round")' -e "include(\"$WORK/round.so\")"
+check_last "built-in after file" "$already" -e "include(\"$WORK/round.so\")" -e 'include("builtin:round")'
+
+# A library with the name of a built-in one but other functions is not it
+mkdir "$WORK/other"
+cat > "$WORK/other/round.c" <<'EOF'
+#include "fnm_plugin.h"
+static double twice(double x){ return 2 * x; }
+static const fnm_function functions[] = {
+    {"twice", 1, FNM_SIGNATURE_NATIVE, twice, 0, FNM_PURE, FNM_COST_CHEAP},
+    {0}
+};
+const fnm_plugin fnm_plugin_info = FNM_PLUGIN(functions, 0);
+EOF
+${CC:-gcc} -O2 -shared -fPIC -I../lib -o "$WORK/other/round.so" "$WORK/other/round.c" || { fail "build" "other round.so"; finish; }
+check_last "other file after built-in" "$(printf '\t6')" -e 'include("builtin:round")' -e "include(\"$WORK/other/round.so\")" -e 'twice(3)'
+check_last "built-in after other file" "$(printf '\t3')" -e "include(\"$WORK/other/round.so\")" -e 'include("builtin:round")' -e 'round(2.6)'
+
+# The functions are listed once, when the first one is included
+count=$("$FNM" -e 'include("builtin:round")' -e "include(\"$WORK/round.so\")" 2>&1 | grep -c "$(printf '^\t')")
+[ "$count" -eq 5 ] || fail "functions included once" "$count functions listed"
+
+finish
@@ -0,0 +1,37 @@
+# The large loaded files give the same results when their tokens are
+# scanned by the pipeline (pipeline.c) as by the lexical analyzer
+. ./common.sh
+
+# Random lines with all the kinds of tokens, valid or not, until the file
+# is larger than PIPELINE_MIN_SIZE (64 KiB)
+awk 'BEGIN {
+    srand(49)
+    n = split("x|y1|_t|abc|z_2|1|0|42|3.25|1e3|2.5E-3|1e+2|0x1F|0XaB|0b101|0B1|" \
+              "0x|0b2|1.|1e|012|.5|1.5.2|00|\"str\"|\"a\\\"b\"|\"open|@|$|#|" \
+              "+|-|*|/|%|^|=|:|,|[|]|(|)|  |\t", token, "|")
+    size = 0
+    while(size < 80000){
+        line = ""
+        len = 1 + int(rand() * 12)
+        for(i = 0; i < len; i++)
+            line = line token[1 + int(rand() * n)] ((rand() < 0.5) ? " " : "")
+        print line
+        size += length(line) + 1
+    }
+}' > "$WORK/tokens.fnm"
+
+# The pipeline only runs with several threads, and the files must not run
+# from their compiled form
+run(){
+    XDG_CACHE_HOME="$WORK/$1" FNM_THREADS=4 "$FNM" -e "pipeline(\"$1\")" -e "load(\"$WORK/tokens.fnm\")" \
+        > "$WORK/$1.txt" 2>&1
+    echo "status $?" >> "$WORK/$1.txt"
+}
+run on
+run off
+tail -n +2 "$WORK/on.txt" > "$WORK/on_lines.txt"
+tail -n +2 "$WORK/off.txt" > "$WORK/off_lines.txt"
+cmp -s "$WORK/on_lines.txt" "$WORK/off_lines.txt" || fail "tokens" "$(diff "$WORK/on_lines.txt" "$WORK/off_lines.txt" | head -n 4)"
+[ $(wc -l < "$WORK/off_lines.txt") -gt 1000 ] || fail "tokens" "too short output"
+
+finish
@@ -0,0 +1,12 @@
+# Ranges and vectors whose size doesn't fit on memory
+. ./common.sh
+
+check_output "range" "$(printf '\t[1, 2, 3]')" -e '1:3'
+check_output "empty range" "$(printf '\t[]')" -e '1:0'
+check_error "huge range" "Too many elements on the range" -e '1:1e20'
+check_error "assigned huge range" "Too many elements on the range" -e 'v = 1:2^61+2'
+check_error "range too large for memory" "Not enough memory" -e 'v = 1:2^61-1e4'
+check_error "concatenation too large for memory" "Not enough memory" \
+    -e 'v = [1:2^60, 1:2^60, 1:2^60, 1:2^60, 1:2^60, 1:2^60, 1:2^60, 1:2^60]'
+
+finish
@@ -0,0 +1,9 @@
+# Series whose number of terms doesn't fit on memory
+. ./common.sh
+
+check_output "series" "$(printf '\t55')" -e 'sum(k, 1, 10, k)'
+check_output "empty series" "$(printf '\t0')" -e 'sum(k, 1, 0, k)'
+check_error "huge series" "Too many terms on the series of k" -e 'sum(k, 1, 1e20, 1)'
+check_error "huge series of the index" "Too many terms on the series of k" -e 'prod(k, 1, 2^61+2, k)'
+
+finish
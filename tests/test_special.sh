@@ -0,0 +1,39 @@
+# The functions of lib/special.c with vector kernels give the same value
+# for an element of a vector whatever its neighbours (on the other regions
+# of the approximations), and the values of the libm
+. ./common.sh
+
+${CC:-gcc} -O3 -shared -fPIC -o "$WORK/special.so" ../lib/special.c -lm || { fail "build" "special.so"; finish; }
+
+# Each vector mixes the regions of erf and erfc (below 0.84375, up to 1.25,
+# up to 1/0.35 and beyond) and of norminv (central and tails), and each
+# element is compared with the scalar call
+check_mixed(){
+    name=$1
+    args=""
+    for f in erf erfc normcdf; do
+        v="0.3,-2.1,1.1,5.5,-0.9,27.5,-1e-300,3.2"
+        args="$args -e d=d+sum(abs($f([$v])-[$(echo "$v" | sed "s/\([^,]*\)/$f(\1)/g")]))"
+    done
+    v="0.5,1e-300,0.99,0.01,0.3,0.999999,0.97,0.2"
+    args="$args -e d=d+sum(abs(norminv([$v])-[$(echo "$v" | sed "s/\([^,]*\)/norminv(\1)/g")]))"
+    check_last "$name" "$(printf '\t0')" -e 'include("builtin:round")' -e "include(\"$WORK/special.so\")" \
+        -e 'd = 0' $args -e 'd'
+}
+
+# Values of the libm (rounded to 12 digits), on each region: the sum of the
+# relative errors is below 1e-9
+check_values(){
+    name=$1
+    check_last "$name" "$(printf '\t0')" -e 'include("builtin:round")' -e "include(\"$WORK/special.so\")" \
+        -e 'v = [erf(0.5), erf(1), erf(-2), erfc(0.3), erfc(1.1), erfc(3), erfc(-5), normcdf(-1.5), norminv(0.025), norminv(0.7)]' \
+        -e 'r = [0.520499877813, 0.842700792950, -0.995322265019, 0.671373240541, 0.119794930426, 2.20904969986e-5, 1.99999999999846, 0.0668072012689, -1.95996398454, 0.524400512708]' \
+        -e 'round(sum(abs(v - r) / abs(r)) * 1e9)'
+}
+
+check_mixed "mixed arguments"
+check_values "values"
+FNM_VECMATH_ISA=sse2 check_mixed "mixed arguments with SSE2"
+FNM_VECMATH_ISA=sse2 check_values "values with SSE2"
+
+finish
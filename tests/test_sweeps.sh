@@ -0,0 +1,21 @@
+# The points of a sweep are the same on every version of the loops of the
+# evaluator (FNM_TARGET_CLONES), computed from their nearest limit
+. ./common.sh
+
+check_output "sweep" "$(printf '\t[0, 0.25, 0.5, 0.75, 1]')" -e 'sweep(x, x, 0, 1, 5)'
+
+# Each sweep of 8 points from a to b is compared with its points computed
+# one by one (a + s*k on the first half and b - s*(7 - k) on the second)
+awk 'BEGIN {
+    print "include(\"builtin:round\")"
+    print "d = 0"
+    for(i = 1; i <= 200; i++){
+        a = sprintf("%.17g", i * 0.0731); b = sprintf("%.17g", a + 0.6 + i * 0.0173)
+        printf "s = (%s - %s) / 7\n", b, a
+        printf "d = d + sum(abs(sweep(x, x, %s, %s, 8) - [%s + s*0, %s + s*1, %s + s*2, %s + s*3, %s - s*3, %s - s*2, %s - s*1, %s - s*0]))\n", a, b, a, a, a, a, b, b, b, b
+    }
+    print "d"
+}' > "$WORK/points.fnm"
+check_last "points" "$(printf '\t0')" "$WORK/points.fnm"
+
+finish
@@ -0,0 +1,44 @@
+# The pipelines and the compressed files take their threads from the pool
+# (pool_spawn()), so they give the same results with any number of
+# threads, also when there is no worker left for them
+. ./common.sh
+
+# Random lines with valid and invalid tokens, larger than PIPELINE_MIN_SIZE
+# (64 KiB), run as they are and compressed with gzip
+awk 'BEGIN {
+    srand(29)
+    n = split("x|y1|abc|1|42|3.25|1e3|0x1F|0b101|1.5.2|\"str\"|@|" \
+              "+|-|*|/|^|=|,|[|]|(|)", token, "|")
+    size = 0
+    while(size < 80000){
+        line = ""
+        len = 1 + int(rand() * 10)
+        for(i = 0; i < len; i++)
+            line = line token[1 + int(rand() * n)] " "
+        print line
+        size += length(line) + 1
+    }
+}' > "$WORK/lines.fnm"
+gzip -c "$WORK/lines.fnm" > "$WORK/lines.fnm.gz"
+
+# The files must not run from their compiled form
+run(){
+    XDG_CACHE_HOME="$WORK/$1_$2" FNM_THREADS=$2 "$FNM" -e "load(\"$WORK/$1\")" \
+        > "$WORK/$1_$2.txt" 2>&1
+    echo "status $?" >> "$WORK/$1_$2.txt"
+}
+run lines.fnm 1
+[ $(wc -l < "$WORK/lines.fnm_1.txt") -gt 1000 ] || fail "lines" "too short output"
+for threads in 2 3 4 8; do
+    run lines.fnm $threads
+    cmp -s "$WORK/lines.fnm_1.txt" "$WORK/lines.fnm_$threads.txt" \
+        || fail "lines.fnm, $threads threads" "$(diff "$WORK/lines.fnm_1.txt" "$WORK/lines.fnm_$threads.txt" | head -n 4)"
+done
+for threads in 1 2 3 4 8; do
+    run lines.fnm.gz $threads
+    sed "s|lines.fnm.gz|lines.fnm|" "$WORK/lines.fnm.gz_$threads.txt" > "$WORK/gz.txt"
+    cmp -s "$WORK/lines.fnm_1.txt" "$WORK/gz.txt" \
+        || fail "lines.fnm.gz, $threads threads" "$(diff "$WORK/lines.fnm_1.txt" "$WORK/gz.txt" | head -n 4)"
+done
+
+finish
@@ -0,0 +1,25 @@
+# The functions of lib/vecmath.c give the same value for an element of a
+# vector whatever its neighbours, even if they are out of the range of the
+# reduction of the trigonometric functions
+. ./common.sh
+
+${CC:-gcc} -O2 -shared -fPIC -o "$WORK/vecmath.so" ../lib/vecmath.c -lm || { fail "build" "vecmath.so"; finish; }
+
+# Each vector mixes small and big arguments, and each element is compared
+# with the scalar call
+check_mixed(){
+    name=$1
+    shift
+    check_last "$name" "$(printf '\t0')" -e 'include("builtin:round")' -e "include(\"$WORK/vecmath.so\")" \
+        -e 'd = 0' \
+        -e 'd = d + sum(abs(sin([1, 2e5, -745.2, 3, -1, 1e300, 0.5, 7]) - [sin(1), sin(2e5), sin(-745.2), sin(3), sin(-1), sin(1e300), sin(0.5), sin(7)]))' \
+        -e 'd = d + sum(abs(cos([1, 2e5, -745.2, 3, -1, 1e300, 0.5, 7]) - [cos(1), cos(2e5), cos(-745.2), cos(3), cos(-1), cos(1e300), cos(0.5), cos(7)]))' \
+        -e 'd = d + sum(abs(tan([1, 2e5, -745.2, 3, -1, 1e300, 0.5, 7]) - [tan(1), tan(2e5), tan(-745.2), tan(3), tan(-1), tan(1e300), tan(0.5), tan(7)]))' \
+        -e 'd = d + sum(abs(tan([2e5, 1, 1e300, -1, -745.2, 2e5, 3, 1e300]) - [tan(2e5), tan(1), tan(1e300), tan(-1), tan(-745.2), tan(2e5), tan(3), tan(1e300)]))' \
+        -e 'd'
+}
+
+check_mixed "mixed arguments"
+FNM_VECMATH_ISA=sse2 check_mixed "mixed arguments with SSE2"
+
+finish